@@ -6,8 +6,20 @@
 #include <string.h>
 
 typedef int32_t ValeInt;
-typedef struct { ValeInt length; char chars[0]; } ValeStr;
-ValeStr* ValeStrNew(ValeInt length);
+// Array and string lengths. valec defines VALE_WIDE_LENGTHS when it passes --wide-lengths to midas.
+#ifdef VALE_WIDE_LENGTHS
+typedef int64_t ValeLength;
+#else
+typedef int32_t ValeLength;
+#endif
+typedef struct { ValeLength length; char chars[0]; } ValeStr;
+ValeStr* ValeStrNew(ValeLength length);
 ValeStr* ValeStrFrom(char* source);
+// See snapshot.c. Only one snapshot of each type can be mapped at a time. Each type gets one of 64
+// address slots from its hash; Midas refuses to compile a program whose snapshot types collide.
+void* __vale_snapshotMap(const char* path, uint64_t typeHash);
+void* __vale_snapshotRoot(void* snapshot);
+int64_t __vale_snapshotRootType(void* snapshot);
+void __vale_snapshotUnmap(void* snapshot);
 
 #endif
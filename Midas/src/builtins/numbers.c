@@ -0,0 +1,456 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <math.h>
+#include "ValeBuiltins.h"
+
+// Number to string conversions write their digits straight into a ValeStr of exactly the right
+// size, and the parsers read straight out of the Vale string's chars.
+
+static const char DIGIT_PAIRS[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static int countDigitsU64(uint64_t n) {
+  int digits = 1;
+  while (n >= 10000) {
+    n /= 10000;
+    digits += 4;
+  }
+  while (n >= 10) {
+    n /= 10;
+    digits++;
+  }
+  return digits;
+}
+
+// Writes n's digits so the last one lands just before end.
+static void writeDigitsU64(char* end, uint64_t n) {
+  while (n >= 100) {
+    int pairIndex = (int)(n % 100) * 2;
+    n /= 100;
+    end -= 2;
+    end[0] = DIGIT_PAIRS[pairIndex];
+    end[1] = DIGIT_PAIRS[pairIndex + 1];
+  }
+  if (n >= 10) {
+    end -= 2;
+    end[0] = DIGIT_PAIRS[n * 2];
+    end[1] = DIGIT_PAIRS[n * 2 + 1];
+  } else {
+    end[-1] = (char)('0' + n);
+  }
+}
+
+extern ValeStr* __vale_castI64Str(int64_t n) {
+  uint64_t magnitude = n < 0 ? 0 - (uint64_t)n : (uint64_t)n;
+  int negative = n < 0;
+  ValeInt length = negative + countDigitsU64(magnitude);
+  ValeStr* result = ValeStrNew(length);
+  if (negative) {
+    result->chars[0] = '-';
+  }
+  writeDigitsU64(result->chars + length, magnitude);
+  return result;
+}
+
+// Writes n into dest, which needs room for 20 chars, and returns how many it wrote.
+int __vale_formatI64(char* dest, int64_t n) {
+  uint64_t magnitude = n < 0 ? 0 - (uint64_t)n : (uint64_t)n;
+  int negative = n < 0;
+  int length = negative + countDigitsU64(magnitude);
+  if (negative) {
+    dest[0] = '-';
+  }
+  writeDigitsU64(dest + length, magnitude);
+  return length;
+}
+
+extern ValeStr* __vale_castI32Str(int32_t n) {
+  return __vale_castI64Str((int64_t)n);
+}
+
+// Shortest digits for a double, using Grisu2 (Loitsch, "Printing Floating-Point Numbers Quickly
+// and Accurately with Integers"). The digits always read back as the same double, and are the
+// shortest such digits for nearly all of them.
+
+typedef struct {
+  uint64_t f;
+  int e;
+} DiyFp;
+
+#define DIYFP_SIGNIFICAND_SIZE 52
+#define DIYFP_HIDDEN_BIT (((uint64_t)1) << DIYFP_SIGNIFICAND_SIZE)
+
+// 10^k as a normalized DiyFp, for k = -348, -340, ..., 340.
+static const uint64_t CACHED_POWERS_F[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+    0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+    0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+    0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+    0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+    0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+    0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+    0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+    0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+    0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+    0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+    0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+    0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+    0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+    0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+    0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+    0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+    0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+    0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+    0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+    0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+    0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+};
+static const int16_t CACHED_POWERS_E[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066
+};
+
+static const uint64_t POWERS_OF_10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+static DiyFp diyFpFromDouble(double d) {
+  uint64_t bits = 0;
+  memcpy(&bits, &d, sizeof(d));
+  int biasedExponent = (int)((bits >> DIYFP_SIGNIFICAND_SIZE) & 0x7FF);
+  uint64_t significand = bits & (DIYFP_HIDDEN_BIT - 1);
+  DiyFp result;
+  if (biasedExponent != 0) {
+    result.f = significand + DIYFP_HIDDEN_BIT;
+    result.e = biasedExponent - 1075;
+  } else {
+    result.f = significand;
+    result.e = -1074;
+  }
+  return result;
+}
+
+// The high 64 bits of the 128-bit product, rounded.
+static DiyFp diyFpMultiply(DiyFp x, DiyFp y) {
+  const uint64_t M32 = 0xFFFFFFFFULL;
+  uint64_t a = x.f >> 32;
+  uint64_t b = x.f & M32;
+  uint64_t c = y.f >> 32;
+  uint64_t d = y.f & M32;
+  uint64_t ac = a * c;
+  uint64_t bc = b * c;
+  uint64_t ad = a * d;
+  uint64_t bd = b * d;
+  uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+  tmp += 1ULL << 31;
+  DiyFp result;
+  result.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+  result.e = x.e + y.e + 64;
+  return result;
+}
+
+static DiyFp diyFpNormalize(DiyFp x) {
+  while (!(x.f & (1ULL << 63))) {
+    x.f <<= 1;
+    x.e--;
+  }
+  return x;
+}
+
+// The bounds of the interval that rounds to this double, normalized to the same exponent.
+static void diyFpNormalizedBoundaries(DiyFp v, DiyFp* minus, DiyFp* plus) {
+  DiyFp upper;
+  upper.f = (v.f << 1) + 1;
+  upper.e = v.e - 1;
+  while (!(upper.f & (DIYFP_HIDDEN_BIT << 1))) {
+    upper.f <<= 1;
+    upper.e--;
+  }
+  upper.f <<= 64 - DIYFP_SIGNIFICAND_SIZE - 2;
+  upper.e -= 64 - DIYFP_SIGNIFICAND_SIZE - 2;
+
+  DiyFp lower;
+  if (v.f == DIYFP_HIDDEN_BIT) {
+    lower.f = (v.f << 2) - 1;
+    lower.e = v.e - 2;
+  } else {
+    lower.f = (v.f << 1) - 1;
+    lower.e = v.e - 1;
+  }
+  lower.f <<= lower.e - upper.e;
+  lower.e = upper.e;
+
+  *minus = lower;
+  *plus = upper;
+}
+
+// A cached power of ten that brings a number with binary exponent e into range, and sets
+// decimalExponent to the negation of its exponent.
+static DiyFp getCachedPower(int e, int* decimalExponent) {
+  double dk = (-61 - e) * 0.30102999566398114 + 347;
+  int k = (int)dk;
+  if (dk - k > 0.0) {
+    k++;
+  }
+  unsigned index = (unsigned)((k >> 3) + 1);
+  *decimalExponent = -(-348 + (int)(index << 3));
+  DiyFp result;
+  result.f = CACHED_POWERS_F[index];
+  result.e = CACHED_POWERS_E[index];
+  return result;
+}
+
+static void grisuRound(char* buffer, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t wpw) {
+  while (rest < wpw && delta - rest >= tenKappa &&
+      (rest + tenKappa < wpw || wpw - rest > rest + tenKappa - wpw)) {
+    buffer[length - 1]--;
+    rest += tenKappa;
+  }
+}
+
+static void digitGen(DiyFp w, DiyFp mp, uint64_t delta, char* buffer, int* length, int* decimalExponent) {
+  DiyFp one;
+  one.f = 1ULL << -mp.e;
+  one.e = mp.e;
+  uint64_t wpw = mp.f - w.f;
+  uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+  uint64_t p2 = mp.f & (one.f - 1);
+  int kappa = countDigitsU64(p1);
+  *length = 0;
+
+  while (kappa > 0) {
+    uint32_t digit = p1 / (uint32_t)POWERS_OF_10[kappa - 1];
+    p1 %= (uint32_t)POWERS_OF_10[kappa - 1];
+    if (digit || *length) {
+      buffer[(*length)++] = (char)('0' + digit);
+    }
+    kappa--;
+    uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+    if (rest <= delta) {
+      *decimalExponent += kappa;
+      grisuRound(buffer, *length, delta, rest, POWERS_OF_10[kappa] << -one.e, wpw);
+      return;
+    }
+  }
+
+  for (;;) {
+    p2 *= 10;
+    delta *= 10;
+    char digit = (char)(p2 >> -one.e);
+    if (digit || *length) {
+      buffer[(*length)++] = (char)('0' + digit);
+    }
+    p2 &= one.f - 1;
+    kappa--;
+    if (p2 < delta) {
+      *decimalExponent += kappa;
+      grisuRound(buffer, *length, delta, p2, one.f, wpw * POWERS_OF_10[-kappa]);
+      return;
+    }
+  }
+}
+
+// Fills buffer with up to 17 digits such that d = digits * 10^decimalExponent. d must be
+// positive and finite.
+static void grisu2(double d, char* buffer, int* length, int* decimalExponent) {
+  DiyFp v = diyFpFromDouble(d);
+  DiyFp minus;
+  DiyFp plus;
+  diyFpNormalizedBoundaries(v, &minus, &plus);
+
+  DiyFp cachedPower = getCachedPower(plus.e, decimalExponent);
+  DiyFp w = diyFpMultiply(diyFpNormalize(v), cachedPower);
+  DiyFp wPlus = diyFpMultiply(plus, cachedPower);
+  DiyFp wMinus = diyFpMultiply(minus, cachedPower);
+  wMinus.f++;
+  wPlus.f--;
+  digitGen(w, wPlus, wPlus.f - wMinus.f, buffer, length, decimalExponent);
+}
+
+static ValeStr* valeStrFromCString(const char* source) {
+  ValeInt length = (ValeInt)strlen(source);
+  ValeStr* result = ValeStrNew(length);
+  memcpy(result->chars, source, length);
+  return result;
+}
+
+// Formats like the JVM's Double.toString, so we print the same thing the interpreter does:
+// plain decimals with at least one digit after the point between 10^-3 and 10^7, and
+// scientific notation like 1.5E10 outside that.
+extern ValeStr* __vale_castFloatStr(double f) {
+  if (isnan(f)) {
+    return valeStrFromCString("NaN");
+  }
+  if (isinf(f)) {
+    return valeStrFromCString(f < 0 ? "-Infinity" : "Infinity");
+  }
+  if (f == 0) {
+    return valeStrFromCString(signbit(f) ? "-0.0" : "0.0");
+  }
+
+  int negative = f < 0;
+  char digits[20];
+  int numDigits = 0;
+  int decimalExponent = 0;
+  grisu2(negative ? -f : f, digits, &numDigits, &decimalExponent);
+  // Where the decimal point goes, counting from the start of the digits.
+  int pointPos = numDigits + decimalExponent;
+  int scientificExponent = pointPos - 1;
+
+  if (scientificExponent >= -3 && scientificExponent < 7) {
+    ValeInt length;
+    if (pointPos <= 0) {
+      length = negative + 2 + -pointPos + numDigits;
+    } else if (pointPos >= numDigits) {
+      length = negative + pointPos + 2;
+    } else {
+      length = negative + numDigits + 1;
+    }
+    ValeStr* result = ValeStrNew(length);
+    char* dest = result->chars;
+    if (negative) {
+      *dest++ = '-';
+    }
+    if (pointPos <= 0) {
+      *dest++ = '0';
+      *dest++ = '.';
+      memset(dest, '0', -pointPos);
+      dest += -pointPos;
+      memcpy(dest, digits, numDigits);
+    } else if (pointPos >= numDigits) {
+      memcpy(dest, digits, numDigits);
+      dest += numDigits;
+      memset(dest, '0', pointPos - numDigits);
+      dest += pointPos - numDigits;
+      *dest++ = '.';
+      *dest++ = '0';
+    } else {
+      memcpy(dest, digits, pointPos);
+      dest += pointPos;
+      *dest++ = '.';
+      memcpy(dest, digits + pointPos, numDigits - pointPos);
+    }
+    return result;
+  } else {
+    int exponentNegative = scientificExponent < 0;
+    uint64_t exponentMagnitude = exponentNegative ? -scientificExponent : scientificExponent;
+    int exponentDigits = countDigitsU64(exponentMagnitude);
+    int fractionDigits = numDigits > 1 ? numDigits - 1 : 1;
+    ValeInt length = negative + 1 + 1 + fractionDigits + 1 + exponentNegative + exponentDigits;
+    ValeStr* result = ValeStrNew(length);
+    char* dest = result->chars;
+    if (negative) {
+      *dest++ = '-';
+    }
+    *dest++ = digits[0];
+    *dest++ = '.';
+    if (numDigits > 1) {
+      memcpy(dest, digits + 1, numDigits - 1);
+    } else {
+      *dest = '0';
+    }
+    dest += fractionDigits;
+    *dest++ = 'E';
+    if (exponentNegative) {
+      *dest++ = '-';
+    }
+    writeDigitsU64(dest + exponentDigits, exponentMagnitude);
+    return result;
+  }
+}
+
+static void panicParse(const char* message) {
+  printf("%s Exiting!\n", message);
+  exit(1);
+}
+
+// Reads an optional sign and then digits, stopping at the first thing that isn't a digit. Panics
+// if there are no digits, or if they don't fit in an i64.
+int64_t __vale_strtoi64_borrowed(char* chars, ValeInt begin, ValeInt end) {
+  char* c = chars + begin;
+  char* stop = chars + end;
+  int negative = 0;
+  if (c < stop && (*c == '-' || *c == '+')) {
+    negative = *c == '-';
+    c++;
+  }
+  // The most negative i64 has one more than the most positive.
+  uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+  char* digitsBegin = c;
+  uint64_t magnitude = 0;
+  while (c < stop && *c >= '0' && *c <= '9') {
+    uint64_t digit = (uint64_t)(*c - '0');
+    if (magnitude > (limit - digit) / 10) {
+      panicParse("Number too big for an i64!");
+    }
+    magnitude = magnitude * 10 + digit;
+    c++;
+  }
+  if (c == digitsBegin) {
+    panicParse("Couldn't parse an i64, there were no digits!");
+  }
+  return negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+}
+
+int64_t __vale_strtoi64(ValeStr* s, ValeInt begin, ValeInt end) {
+  int64_t result = __vale_strtoi64_borrowed(s->chars, begin, end);
+  free(s);
+  return result;
+}
+
+// strtod needs a terminated string, so this copies the range out unless it's short enough for
+// the stack. Panics if there's no number there, or if it's too big for a float.
+double __vale_strtofloat_borrowed(char* chars, ValeInt begin, ValeInt end) {
+  ValeInt length = end - begin;
+  assert(length >= 0);
+  char stackBuffer[64];
+  char* buffer = length < (ValeInt)sizeof(stackBuffer) ? stackBuffer : (char*)malloc(length + 1);
+  memcpy(buffer, chars + begin, length);
+  buffer[length] = 0;
+  char* parseEnd = buffer;
+  errno = 0;
+  double result = strtod(buffer, &parseEnd);
+  int parsedNothing = parseEnd == buffer;
+  int overflowed = errno == ERANGE && isinf(result);
+  if (buffer != stackBuffer) {
+    free(buffer);
+  }
+  if (parsedNothing) {
+    panicParse("Couldn't parse a float, there was no number!");
+  }
+  if (overflowed) {
+    panicParse("Number too big for a float!");
+  }
+  return result;
+}
+
+double __vale_strtofloat(ValeStr* s, ValeInt begin, ValeInt end) {
+  double result = __vale_strtofloat_borrowed(s->chars, begin, end);
+  free(s);
+  return result;
+}
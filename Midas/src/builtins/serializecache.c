@@ -0,0 +1,160 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+// With --memoize-extern-serialize, we keep the linear copy of an immutable we've sent to an
+// extern, keyed by the address of the object it came from, and lend that same copy to any
+// extern we later send the object to. Immutables never change, so the copy is good until the
+// object is freed, which forgets it.
+//
+// The cached copies take up to VALE_SERIALIZE_CACHE_BUDGET bytes, 16MB by default. When a new
+// one doesn't fit, we free ones that aren't lent out right now until it does. If it still
+// doesn't fit, the extern gets it anyway and we free it when the extern returns.
+
+#define DEFAULT_SERIALIZE_CACHE_BUDGET (16 * 1024 * 1024)
+
+typedef struct SerializeCacheEntry {
+  void* source; // NULL if this slot is empty
+  void* image;
+  int64_t size;
+  int64_t numLent;
+} SerializeCacheEntry;
+
+static SerializeCacheEntry* entries = NULL;
+// Always a power of two, and at least twice the number of entries.
+static int64_t capacity = 0;
+static int64_t numEntries = 0;
+static int64_t budget = -1;
+static int64_t bytesUsed = 0;
+
+// C code can declare these as extern to see how well the cache is doing.
+int64_t __vale_serializeCacheHits = 0;
+int64_t __vale_serializeCacheMisses = 0;
+
+static int64_t homeIndex(void* source) {
+  uint64_t hash = (uint64_t)(uintptr_t)source * 0x9E3779B97F4A7C15ULL;
+  return (int64_t)(hash >> 32) & (capacity - 1);
+}
+
+static SerializeCacheEntry* findEntry(void* source) {
+  if (numEntries == 0) {
+    return NULL;
+  }
+  for (int64_t i = homeIndex(source); entries[i].source; i = (i + 1) & (capacity - 1)) {
+    if (entries[i].source == source) {
+      return &entries[i];
+    }
+  }
+  return NULL;
+}
+
+static void insertEntry(SerializeCacheEntry entry) {
+  int64_t i = homeIndex(entry.source);
+  while (entries[i].source) {
+    i = (i + 1) & (capacity - 1);
+  }
+  entries[i] = entry;
+  numEntries++;
+}
+
+// Linear probing without tombstones: after emptying a slot, move back any later entry in the
+// same run that would otherwise no longer be found.
+static void removeEntry(SerializeCacheEntry* entry) {
+  int64_t hole = entry - entries;
+  bytesUsed -= entry->size;
+  free(entry->image);
+  entries[hole].source = NULL;
+  numEntries--;
+  for (int64_t i = (hole + 1) & (capacity - 1); entries[i].source; i = (i + 1) & (capacity - 1)) {
+    int64_t home = homeIndex(entries[i].source);
+    // Whether home is cyclically outside (hole, i], meaning the entry has to stay reachable
+    // from its home through the hole.
+    int moveBack = hole <= i ? (home <= hole || home > i) : (home <= hole && home > i);
+    if (moveBack) {
+      entries[hole] = entries[i];
+      entries[i].source = NULL;
+      hole = i;
+    }
+  }
+}
+
+static void grow() {
+  SerializeCacheEntry* oldEntries = entries;
+  int64_t oldCapacity = capacity;
+  capacity = capacity ? capacity * 2 : 64;
+  entries = (SerializeCacheEntry*)calloc(capacity, sizeof(SerializeCacheEntry));
+  numEntries = 0;
+  for (int64_t i = 0; i < oldCapacity; i++) {
+    if (oldEntries[i].source) {
+      insertEntry(oldEntries[i]);
+    }
+  }
+  free(oldEntries);
+}
+
+// Frees copies that aren't lent out until needed more bytes fit in the budget, or there's
+// nothing left to free.
+static void makeRoom(int64_t needed) {
+  for (int64_t i = 0; i < capacity && bytesUsed + needed > budget; ) {
+    if (entries[i].source && entries[i].numLent == 0) {
+      // This can move a later entry into slot i, so look at it again.
+      removeEntry(&entries[i]);
+    } else {
+      i++;
+    }
+  }
+}
+
+// Returns the cached copy of this object, or NULL if we don't have one. Either way, the caller
+// has to call __vale_serializeCacheReturn once the extern returns.
+void* __vale_serializeCacheLend(void* source) {
+  SerializeCacheEntry* entry = findEntry(source);
+  if (entry) {
+    __vale_serializeCacheHits++;
+    entry->numLent++;
+    return entry->image;
+  }
+  __vale_serializeCacheMisses++;
+  return NULL;
+}
+
+// Remembers a fresh copy of this object, if it fits in the budget.
+void __vale_serializeCacheAdd(void* source, void* image, int64_t size) {
+  if (budget < 0) {
+    budget = DEFAULT_SERIALIZE_CACHE_BUDGET;
+    const char* budgetStr = getenv("VALE_SERIALIZE_CACHE_BUDGET");
+    if (budgetStr) {
+      budget = (int64_t)strtoll(budgetStr, NULL, 10);
+    }
+  }
+  if (bytesUsed + size > budget) {
+    makeRoom(size);
+    if (bytesUsed + size > budget) {
+      return;
+    }
+  }
+  if ((numEntries + 1) * 2 > capacity) {
+    grow();
+  }
+  SerializeCacheEntry entry = { source, image, size, 1 };
+  insertEntry(entry);
+  bytesUsed += size;
+}
+
+// The extern is done with this copy. If the cache didn't keep it, nobody else will free it.
+void __vale_serializeCacheReturn(void* source, void* image) {
+  SerializeCacheEntry* entry = findEntry(source);
+  if (entry && entry->image == image) {
+    entry->numLent--;
+  } else {
+    free(image);
+  }
+}
+
+// Called when an object we might have a copy of is freed, since another object could later
+// show up at the same address.
+void __vale_serializeCacheForget(void* source) {
+  SerializeCacheEntry* entry = findEntry(source);
+  if (entry) {
+    removeEntry(entry);
+  }
+}
@@ -0,0 +1,89 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+// With --preserve-sharing, while we serialize an immutable for C or unserialize one from C, this
+// remembers which copy we made of each object that might be reachable more than once, so the next
+// reference to it can point at that copy instead of making another.
+//
+// Every serialize or unserialize starts a new generation, and entries from older generations count
+// as empty, so starting one doesn't have to clear the table.
+
+// A table bigger than this is freed at the end instead of kept for next time.
+#define MAX_KEPT_SHARING_CAPACITY (64 * 1024)
+
+typedef struct SharingEntry {
+  void* original;
+  void* copy;
+  uint64_t generation;
+} SharingEntry;
+
+static SharingEntry* entries = NULL;
+// Always a power of two, and at least twice the number of entries.
+static int64_t capacity = 0;
+static int64_t numEntries = 0;
+static uint64_t currentGeneration = 0;
+
+static int64_t homeIndex(void* original) {
+  uint64_t hash = (uint64_t)(uintptr_t)original * 0x9E3779B97F4A7C15ULL;
+  return (int64_t)(hash >> 32) & (capacity - 1);
+}
+
+static void insertEntry(void* original, void* copy) {
+  int64_t i = homeIndex(original);
+  while (entries[i].generation == currentGeneration) {
+    i = (i + 1) & (capacity - 1);
+  }
+  entries[i].original = original;
+  entries[i].copy = copy;
+  entries[i].generation = currentGeneration;
+  numEntries++;
+}
+
+static void grow() {
+  SharingEntry* oldEntries = entries;
+  int64_t oldCapacity = capacity;
+  capacity = capacity ? capacity * 2 : 64;
+  // Zeroed generations are all older than the current one, which starts at 1.
+  entries = (SharingEntry*)calloc(capacity, sizeof(SharingEntry));
+  numEntries = 0;
+  for (int64_t i = 0; i < oldCapacity; i++) {
+    if (oldEntries[i].generation == currentGeneration) {
+      insertEntry(oldEntries[i].original, oldEntries[i].copy);
+    }
+  }
+  free(oldEntries);
+}
+
+void __vale_sharingBegin() {
+  currentGeneration++;
+  numEntries = 0;
+}
+
+// Returns the copy we already made of this object, or NULL if we haven't made one yet.
+void* __vale_sharingFind(void* original) {
+  if (numEntries == 0) {
+    return NULL;
+  }
+  for (int64_t i = homeIndex(original); entries[i].generation == currentGeneration; i = (i + 1) & (capacity - 1)) {
+    if (entries[i].original == original) {
+      return entries[i].copy;
+    }
+  }
+  return NULL;
+}
+
+void __vale_sharingAdd(void* original, void* copy) {
+  if ((numEntries + 1) * 2 > capacity) {
+    grow();
+  }
+  insertEntry(original, copy);
+}
+
+void __vale_sharingEnd() {
+  if (capacity > MAX_KEPT_SHARING_CAPACITY) {
+    free(entries);
+    entries = NULL;
+    capacity = 0;
+  }
+  numEntries = 0;
+}
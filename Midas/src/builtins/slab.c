@@ -0,0 +1,87 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+// With --slab-unserialize, everything we make while receiving one immutable from C comes out of
+// one slab, instead of one malloc per object. Each object's control block has its offset from the
+// start of its slab, and the slab counts how many of its objects are still alive, so freeing the
+// last one frees the whole slab.
+//
+// The compiler remembers how many bytes the last receive of each type took, and hands that to the
+// next one as a size hint. If a receive outgrows its slab, the rest goes in another one twice as
+// big, so a wrong hint costs one more malloc, not one per object.
+
+// For the first receive of each type, before we have a hint.
+#define MIN_SLAB_SIZE 256
+// Offsets have to fit in the control block's 32 bits. Anything bigger just gets malloc'd.
+#define MAX_SLAB_SIZE ((int64_t)1 << 30)
+
+typedef struct ValeSlab {
+  int64_t numLive;
+  int64_t capacity;
+  int64_t used;
+  // Keeps the objects after this 16-byte aligned, like malloc's.
+  int64_t padding;
+} ValeSlab;
+
+// The slab we're receiving into. It's not freed while it's current, even if it has no objects.
+static ValeSlab* currentSlab = NULL;
+static int receiving = 0;
+static int64_t bytesReceived = 0;
+static int64_t nextSlabSize = 0;
+
+// Called before unserializing an immutable from C.
+void __vale_slabBegin(int64_t sizeHint) {
+  receiving = 1;
+  bytesReceived = 0;
+  nextSlabSize =
+      sizeHint < MIN_SLAB_SIZE ? MIN_SLAB_SIZE :
+      sizeHint > MAX_SLAB_SIZE ? MAX_SLAB_SIZE :
+      sizeHint;
+}
+
+static void closeCurrentSlab() {
+  if (currentSlab && currentSlab->numLive == 0) {
+    free(currentSlab);
+  }
+  currentSlab = NULL;
+}
+
+// Puts the new object's offset from its slab in offsetOut, or 0 if it didn't come from one.
+void* __vale_slabMalloc(int64_t size, int32_t* offsetOut) {
+  size = (size + 15) & ~(int64_t)15;
+  if (!receiving || size > MAX_SLAB_SIZE) {
+    *offsetOut = 0;
+    return malloc(size);
+  }
+  if (!currentSlab || currentSlab->used + size > currentSlab->capacity) {
+    closeCurrentSlab();
+    int64_t capacity = nextSlabSize < size ? size : nextSlabSize;
+    currentSlab = (ValeSlab*)malloc(sizeof(ValeSlab) + capacity);
+    currentSlab->numLive = 0;
+    currentSlab->capacity = capacity;
+    currentSlab->used = 0;
+    nextSlabSize = capacity * 2 > MAX_SLAB_SIZE ? MAX_SLAB_SIZE : capacity * 2;
+  }
+  char* result = (char*)(currentSlab + 1) + currentSlab->used;
+  currentSlab->used += size;
+  currentSlab->numLive++;
+  bytesReceived += size;
+  *offsetOut = (int32_t)(result - (char*)currentSlab);
+  return result;
+}
+
+// Called once we've unserialized the whole thing. Returns how many bytes it took, for the hint.
+int64_t __vale_slabEnd() {
+  receiving = 0;
+  closeCurrentSlab();
+  return bytesReceived;
+}
+
+// Called when an object from this slab is freed.
+void __vale_slabFree(void* slabPtr) {
+  ValeSlab* slab = (ValeSlab*)slabPtr;
+  slab->numLive--;
+  if (slab->numLive == 0 && slab != currentSlab) {
+    free(slab);
+  }
+}
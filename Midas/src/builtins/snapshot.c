@@ -0,0 +1,204 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Snapshots are immutable object graphs saved to a file in their linear layout, so a program can
+// get them back with one mmap instead of parsing them.
+//
+// Linear data points at itself with absolute pointers, so rather than fix them all up on load, we
+// serialize into a buffer at the address the snapshot will always be mapped at. That address comes
+// from the snapshot's type hash, so snapshots of different types can be mapped at the same time,
+// but only one snapshot of each type can be. Two types whose hashes land in the same slot couldn't
+// both be mapped, so Midas checks that a program's snapshot types don't (see checkSnapshotSlots).
+//
+// The file is a header, padded to SNAPSHOT_HEADER_SIZE, then the linear data. We map the whole
+// file read-only, so the header ends up right before the data.
+
+#define SNAPSHOT_MAGIC "VALESNAP"
+#define SNAPSHOT_VERSION 1
+// Bigger than any page size we'll see, so the data after it stays page-aligned.
+#define SNAPSHOT_HEADER_SIZE ((int64_t)64 * 1024)
+// Far above the heap and below the stacks and libraries, and out of the way of ASan's shadow.
+#define SNAPSHOT_BASE_ADDRESS ((uint64_t)0x200000000000ULL)
+#define SNAPSHOT_SLOT_SIZE ((uint64_t)1 << 36)
+// Midas has this too, to check for collisions.
+#define SNAPSHOT_NUM_SLOTS 64
+
+typedef struct ValeSnapshotHeader {
+  char magic[8];
+  uint64_t version;
+  uint64_t typeHash;
+  // Where the data was when we serialized it, and so where it has to be mapped.
+  uint64_t base;
+  uint64_t size;
+  uint64_t rootOffset;
+  // For interface roots, which substruct the root is.
+  uint64_t rootType;
+} ValeSnapshotHeader;
+
+static uint64_t snapshotBase(uint64_t typeHash) {
+  return SNAPSHOT_BASE_ADDRESS + (typeHash % SNAPSHOT_NUM_SLOTS) * SNAPSHOT_SLOT_SIZE;
+}
+
+#ifndef _WIN32
+
+static int64_t roundUpToPage(int64_t size) {
+  int64_t pageSize = sysconf(_SC_PAGESIZE);
+  return size == 0 ? pageSize : (size + pageSize - 1) / pageSize * pageSize;
+}
+
+// Maps at exactly this address or not at all. Without MAP_FIXED_NOREPLACE the address is only a
+// hint, so we check where it went.
+static void* mapAt(uint64_t address, int64_t size, int prot, int flags, int fd) {
+#ifdef MAP_FIXED_NOREPLACE
+  flags |= MAP_FIXED_NOREPLACE;
+#endif
+  void* result = mmap((void*)(uintptr_t)address, size, prot, flags, fd, 0);
+  if (result == MAP_FAILED) {
+    return NULL;
+  }
+  if ((uint64_t)(uintptr_t)result != address) {
+    munmap(result, size);
+    return NULL;
+  }
+  return result;
+}
+
+static int writeAll(int fd, const void* data, int64_t size, int64_t offset) {
+  const char* bytes = (const char*)data;
+  while (size > 0) {
+    ssize_t written = pwrite(fd, bytes, size, offset);
+    if (written <= 0) {
+      return 0;
+    }
+    bytes += written;
+    offset += written;
+    size -= written;
+  }
+  return 1;
+}
+
+// Returns a buffer at this type's snapshot address to serialize into, or NULL if something (like
+// another snapshot of the same type) is already there.
+void* __vale_snapshotAllocate(int64_t size, uint64_t typeHash) {
+  if (size > (int64_t)SNAPSHOT_SLOT_SIZE - SNAPSHOT_HEADER_SIZE) {
+    return NULL;
+  }
+  return mapAt(
+      snapshotBase(typeHash), roundUpToPage(size),
+      PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1);
+}
+
+void __vale_snapshotFree(void* buffer, int64_t size) {
+  munmap(buffer, roundUpToPage(size));
+}
+
+// Writes the serialized buffer to the file, returning whether it worked. Writes to a temporary
+// file first, so anyone mapping the old one never sees half of the new one.
+int8_t __vale_snapshotWrite(
+    const char* path, void* buffer, int64_t size, void* root, int64_t rootType, uint64_t typeHash) {
+  ValeSnapshotHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.typeHash = typeHash;
+  header.base = (uint64_t)(uintptr_t)buffer;
+  header.size = size;
+  header.rootOffset = (uint64_t)((char*)root - (char*)buffer);
+  header.rootType = rootType;
+
+  size_t tempPathLen = strlen(path) + 32;
+  char* tempPath = (char*)malloc(tempPathLen);
+  snprintf(tempPath, tempPathLen, "%s.%d.tmp", path, (int)getpid());
+  int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  int ok = fd >= 0;
+  // The padding after the header is left as a hole.
+  ok = ok && writeAll(fd, &header, sizeof(header), 0);
+  ok = ok && writeAll(fd, buffer, size, SNAPSHOT_HEADER_SIZE);
+  ok = ok && ftruncate(fd, SNAPSHOT_HEADER_SIZE + size) == 0;
+  if (fd >= 0) {
+    ok = close(fd) == 0 && ok;
+  }
+  ok = ok && rename(tempPath, path) == 0;
+  if (!ok) {
+    unlink(tempPath);
+  }
+  free(tempPath);
+  return ok;
+}
+
+// Maps a snapshot read-only, returning NULL if it can't: if the file isn't there, if it was saved
+// by a program with a different layout for this type, or if its address is taken.
+// The result is the snapshot itself, see __vale_snapshotRoot for the object in it.
+void* __vale_snapshotMap(const char* path, uint64_t typeHash) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  ValeSnapshotHeader header;
+  struct stat fileStat;
+  void* result = NULL;
+  if (pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+      memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) == 0 &&
+      header.version == SNAPSHOT_VERSION &&
+      header.typeHash == typeHash &&
+      header.base == snapshotBase(typeHash) &&
+      header.rootOffset < header.size &&
+      fstat(fd, &fileStat) == 0 &&
+      (uint64_t)fileStat.st_size == SNAPSHOT_HEADER_SIZE + header.size) {
+    result =
+        mapAt(
+            header.base - SNAPSHOT_HEADER_SIZE, SNAPSHOT_HEADER_SIZE + header.size,
+            PROT_READ, MAP_PRIVATE, fd);
+  }
+  close(fd);
+  return result;
+}
+
+void __vale_snapshotUnmap(void* snapshot) {
+  ValeSnapshotHeader* header = (ValeSnapshotHeader*)snapshot;
+  munmap(snapshot, SNAPSHOT_HEADER_SIZE + header->size);
+}
+
+#else
+
+// We don't map snapshots on windows yet, so saving and loading them always fails.
+
+void* __vale_snapshotAllocate(int64_t size, uint64_t typeHash) {
+  return NULL;
+}
+
+void __vale_snapshotFree(void* buffer, int64_t size) {
+}
+
+int8_t __vale_snapshotWrite(
+    const char* path, void* buffer, int64_t size, void* root, int64_t rootType, uint64_t typeHash) {
+  return 0;
+}
+
+void* __vale_snapshotMap(const char* path, uint64_t typeHash) {
+  return NULL;
+}
+
+void __vale_snapshotUnmap(void* snapshot) {
+}
+
+#endif
+
+// The root object of a mapped snapshot. C can cast this to the root's type and read it in place.
+void* __vale_snapshotRoot(void* snapshot) {
+  ValeSnapshotHeader* header = (ValeSnapshotHeader*)snapshot;
+  return (char*)(uintptr_t)header->base + header->rootOffset;
+}
+
+int64_t __vale_snapshotRootType(void* snapshot) {
+  return ((ValeSnapshotHeader*)snapshot)->rootType;
+}
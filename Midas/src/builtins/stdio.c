@@ -1,21 +1,130 @@
 #include <stdint.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#define isatty _isatty
+#define write _write
+#else
+#include <unistd.h>
+#endif
 
+#include "ValeBuiltins.h"
+
+// Everything Vale prints goes into this buffer, and reaches stdout in big write()s. We flush it
+// when it fills up, on __vale_flush, when main returns, before exiting, and before calling into
+// any extern that isn't a builtin, in case it prints too. If stdout is a terminal, we also
+// flush at every newline so the user sees whole lines as they're printed.
+//
+// Its size comes from the VALE_OUTPUT_BUFFER_SIZE environment variable, 0 meaning unbuffered.
+
+#define DEFAULT_OUTPUT_BUFFER_SIZE 65536
+
+static char* outputBuffer = NULL;
+static size_t outputBufferSize = 0;
+static size_t outputBufferUsed = 0;
+static int outputIsTerminal = 0;
+static int outputInitialized = 0;
+
+int __vale_formatI64(char* dest, int64_t n);
+
+void __vale_flush() {
+  // This is called before every extern, so don't pay for the stdio lock when there's nothing to do.
+  if (outputBufferUsed == 0) {
+    return;
+  }
+  // Anything printed through stdio before us should come out before us.
+  fflush(stdout);
+  size_t written = 0;
+  while (written < outputBufferUsed) {
+    int result = write(1, outputBuffer + written, (unsigned int)(outputBufferUsed - written));
+    if (result <= 0) {
+      break;
+    }
+    written += result;
+  }
+  outputBufferUsed = 0;
+}
+
+static void initOutputBuffer() {
+  outputInitialized = 1;
+  outputBufferSize = DEFAULT_OUTPUT_BUFFER_SIZE;
+  const char* sizeStr = getenv("VALE_OUTPUT_BUFFER_SIZE");
+  if (sizeStr) {
+    outputBufferSize = (size_t)strtoull(sizeStr, NULL, 10);
+  }
+  // Room for one number even when unbuffered, so those can still be formatted in place.
+  outputBuffer = (char*)malloc(outputBufferSize < 32 ? 32 : outputBufferSize);
+  outputIsTerminal = isatty(1);
+  // Covers every other way out, like a failed check calling exit().
+  atexit(__vale_flush);
+}
+
+static void flushIfNeeded(const char* justWritten, size_t length) {
+  if (outputBufferUsed >= outputBufferSize ||
+      (outputIsTerminal && memchr(justWritten, '\n', length) != NULL)) {
+    __vale_flush();
+  }
+}
+
+static void printChars(const char* chars, size_t length) {
+  if (!outputInitialized) {
+    initOutputBuffer();
+  }
+  if (outputBufferUsed + length > outputBufferSize) {
+    __vale_flush();
+    if (length > outputBufferSize) {
+      // Wouldn't fit even in an empty buffer, so write it directly.
+      outputBufferUsed = 0;
+      size_t written = 0;
+      while (written < length) {
+        int result = write(1, chars + written, (unsigned int)(length - written));
+        if (result <= 0) {
+          break;
+        }
+        written += result;
+      }
+      return;
+    }
+  }
+  memcpy(outputBuffer + outputBufferUsed, chars, length);
+  outputBufferUsed += length;
+  flushIfNeeded(chars, length);
+}
 
 void __vprintCStr(const char* str) {
-  printf("%s", str);
+  printChars(str, strlen(str));
 }
 
 void __vprintI64(int64_t x) {
-  printf("%lld", x);
+  if (!outputInitialized) {
+    initOutputBuffer();
+  }
+  if (outputBufferUsed + 20 > outputBufferSize && outputBufferUsed > 0) {
+    __vale_flush();
+  }
+  // Format straight into the buffer.
+  outputBufferUsed += __vale_formatI64(outputBuffer + outputBufferUsed, x);
+  if (outputBufferUsed >= outputBufferSize) {
+    __vale_flush();
+  }
 }
 
 void __vprintBool(int8_t x) {
   if (x) {
-    printf("true");
+    printChars("true", 4);
   } else {
-    printf("false");
+    printChars("false", 5);
   }
 }
+
+void __vale_printstr_borrowed(char* chars, ValeInt start, ValeInt length) {
+  printChars(chars + start, length);
+}
+
+void __vale_printstr(ValeStr* s, ValeInt start, ValeInt length) {
+  __vale_printstr_borrowed(s->chars, start, length);
+  free(s);
+}
@@ -8,7 +8,7 @@
 #define TRUE 1
 #define FALSE 0
 
-ValeStr* ValeStrNew(ValeInt length) {
+ValeStr* ValeStrNew(ValeLength length) {
   ValeStr* result = (ValeStr*)malloc(sizeof(ValeStr) + length + 1);
   result->length = length;
   result->chars[0] = 0;
@@ -24,183 +24,238 @@ ValeStr* ValeStrFrom(char* source) {
   return result;
 }
 
-ValeInt __vale_strindexof(
-    ValeStr* haystackContainerStr, ValeInt haystackBegin, ValeInt haystackEnd,
-    ValeStr* needleContainerStr, ValeInt needleBegin, ValeInt needleEnd) {
-  char* haystackContainerChars = haystackContainerStr->chars;
+// The _borrowed variants read the chars in place and don't free anything. Midas calls them
+// directly with a pointer into the live Vale string, instead of sending a copy.
+//
+// The scanning is left to memchr and memcmp, which the C runtime already vectorizes and picks
+// the widest instructions for at runtime.
+
+ValeInt __vale_strindexof_borrowed(
+    char* haystackContainerChars, ValeInt haystackBegin, ValeInt haystackEnd,
+    char* needleContainerChars, ValeInt needleBegin, ValeInt needleEnd) {
   char* haystack = haystackContainerChars + haystackBegin;
   ValeInt haystackLen = haystackEnd - haystackBegin;
 
-  char* needleContainerChars = needleContainerStr->chars;
   char* needle = needleContainerChars + needleBegin;
   ValeInt needleLen = needleEnd - needleBegin;
 
-  for (ValeInt i = 0; i <= haystackLen - needleLen; i++) {
-    if (strncmp(needle, haystack + i, needleLen) == 0) {
-      free(haystackContainerStr);
-      free(needleContainerStr);
-      return i;
+  if (needleLen == 0) {
+    return 0;
+  }
+  // Only look for the whole needle where its first byte is.
+  char* searchBegin = haystack;
+  char* searchEnd = haystack + haystackLen - needleLen + 1;
+  while (searchBegin < searchEnd) {
+    char* candidate = memchr(searchBegin, needle[0], searchEnd - searchBegin);
+    if (candidate == NULL) {
+      return -1;
     }
+    if (memcmp(candidate + 1, needle + 1, needleLen - 1) == 0) {
+      return candidate - haystack;
+    }
+    searchBegin = candidate + 1;
   }
+  return -1;
+}
+
+ValeInt __vale_strindexof(
+    ValeStr* haystackContainerStr, ValeInt haystackBegin, ValeInt haystackEnd,
+    ValeStr* needleContainerStr, ValeInt needleBegin, ValeInt needleEnd) {
+  ValeInt result =
+      __vale_strindexof_borrowed(
+          haystackContainerStr->chars, haystackBegin, haystackEnd,
+          needleContainerStr->chars, needleBegin, needleEnd);
   free(haystackContainerStr);
   free(needleContainerStr);
-  return -1;
+  return result;
 }
 
 
-ValeStr* __vale_substring(
-    ValeStr* sourceStr,
+ValeStr* __vale_substring_borrowed(
+    char* sourceChars,
     ValeInt begin,
     ValeInt length) {
-  char* sourceChars = sourceStr->chars;
-
   assert(begin >= 0);
   assert(length >= 0);
 
   ValeStr* result = ValeStrNew(length);
   char* resultChars = result->chars;
   strncpy(resultChars, sourceChars + begin, length);
+  return result;
+}
+
+ValeStr* __vale_substring(
+    ValeStr* sourceStr,
+    ValeInt begin,
+    ValeInt length) {
+  ValeStr* result = __vale_substring_borrowed(sourceStr->chars, begin, length);
   free(sourceStr);
   return result;
 }
 
-char __vale_streq(
-    ValeStr* aStr,
+char __vale_streq_borrowed(
+    char* aContainerChars,
     ValeInt aBegin,
     ValeInt aEnd,
-    ValeStr* bStr,
+    char* bContainerChars,
     ValeInt bBegin,
     ValeInt bEnd) {
-  char* aContainerChars = aStr->chars;
   char* a = aContainerChars + aBegin;
   ValeInt aLen = aEnd - aBegin;
 
-  char* bContainerChars = bStr->chars;
   char* b = bContainerChars + bBegin;
   ValeInt bLen = bEnd - bBegin;
 
   if (aLen != bLen) {
-    free(aStr);
-    free(bStr);
     return FALSE;
   }
-  ValeInt len = aLen;
-
-  for (int i = 0; i < len; i++) {
-    if (a[i] != b[i]) {
-      free(aStr);
-      free(bStr);
-      return FALSE;
-    }
-  }
+  return memcmp(a, b, aLen) == 0 ? TRUE : FALSE;
+}
 
+char __vale_streq(
+    ValeStr* aStr,
+    ValeInt aBegin,
+    ValeInt aEnd,
+    ValeStr* bStr,
+    ValeInt bBegin,
+    ValeInt bEnd) {
+  char result = __vale_streq_borrowed(aStr->chars, aBegin, aEnd, bStr->chars, bBegin, bEnd);
   free(aStr);
   free(bStr);
-  return TRUE;
+  return result;
 }
 
-ValeInt __vale_strcmp(
-    ValeStr* aStr,
+ValeInt __vale_strcmp_borrowed(
+    char* aContainerChars,
     ValeInt aBegin,
     ValeInt aEnd,
-    ValeStr* bStr,
+    char* bContainerChars,
     ValeInt bBegin,
     ValeInt bEnd) {
-  char* aContainerChars = aStr->chars;
   char* a = aContainerChars + aBegin;
   ValeInt aLen = aEnd - aBegin;
 
-  char* bContainerChars = bStr->chars;
   char* b = bContainerChars + bBegin;
   ValeInt bLen = bEnd - bBegin;
 
-  for (int i = 0; ; i++) {
-    if (i >= aLen && i >= bLen) {
-      break;
-    }
-    if (i >= aLen && i < bLen) {
-      free(aStr);
-      free(bStr);
-      return -1;
-    }
-    if (i < aLen && i >= bLen) {
-      free(aStr);
-      free(bStr);
-      return 1;
-    }
-    if (a[i] < b[i]) {
-      free(aStr);
-      free(bStr);
-      return -1;
-    }
-    if (a[i] > b[i]) {
-      free(aStr);
-      free(bStr);
-      return 1;
+  ValeInt commonLen = aLen < bLen ? aLen : bLen;
+  if (memcmp(a, b, commonLen) != 0) {
+    // memcmp orders bytes as unsigned, but we've always compared them as chars, so find the
+    // first difference ourselves.
+    ValeInt i = 0;
+    while (a[i] == b[i]) {
+      i++;
     }
+    return a[i] < b[i] ? -1 : 1;
+  }
+  if (aLen < bLen) {
+    return -1;
+  }
+  if (aLen > bLen) {
+    return 1;
   }
-  free(aStr);
-  free(bStr);
   return 0;
 }
 
-ValeStr* __vale_addStr(
-    ValeStr* aStr, ValeInt aBegin, ValeInt aLength,
-    ValeStr* bStr, ValeInt bBegin, ValeInt bLength) {
-  char* a = aStr->chars;
-  char* b = bStr->chars;
+ValeInt __vale_strcmp(
+    ValeStr* aStr,
+    ValeInt aBegin,
+    ValeInt aEnd,
+    ValeStr* bStr,
+    ValeInt bBegin,
+    ValeInt bEnd) {
+  ValeInt result = __vale_strcmp_borrowed(aStr->chars, aBegin, aEnd, bStr->chars, bBegin, bEnd);
+  free(aStr);
+  free(bStr);
+  return result;
+}
 
+ValeStr* __vale_addStr_borrowed(
+    char* aChars, ValeInt aBegin, ValeInt aLength,
+    char* bChars, ValeInt bBegin, ValeInt bLength) {
   ValeStr* result = ValeStrNew(aLength + bLength);
   char* dest = result->chars;
 
   for (int i = 0; i < aLength; i++) {
-    dest[i] = a[aBegin + i];
+    dest[i] = aChars[aBegin + i];
   }
   for (int i = 0; i < bLength; i++) {
-    dest[i + aLength] = b[bBegin + i];
+    dest[i + aLength] = bChars[bBegin + i];
   }
   // Add a null terminating char for compatibility with C.
   // Midas should allocate an extra byte to accommodate this.
   // (Midas also adds this in case we didn't do it here)
   dest[aLength + bLength] = 0;
 
+  return result;
+}
+
+ValeStr* __vale_addStr(
+    ValeStr* aStr, ValeInt aBegin, ValeInt aLength,
+    ValeStr* bStr, ValeInt bBegin, ValeInt bLength) {
+  ValeStr* result = __vale_addStr_borrowed(aStr->chars, aBegin, aLength, bStr->chars, bBegin, bLength);
   free(aStr);
   free(bStr);
   return result;
 }
 
-extern ValeStr* __vale_castI64Str(int64_t n) {
-  char tempBuffer[100] = { 0 };
-  int charsWritten = snprintf(tempBuffer, 100, "%lld", n);
-  ValeStr* result = ValeStrNew(charsWritten);
-  char* resultChars = result->chars;
-  strncpy(resultChars, tempBuffer, charsWritten);
-  return result;
+// A growable buffer that Vale code holds by an opaque handle, so building a string out of many
+// pieces copies each byte about twice, instead of once per + it went through.
+typedef struct {
+  char* chars;
+  int64_t length;
+  int64_t capacity;
+} ValeStrBuilder;
+
+int64_t __vale_strbuilderNew() {
+  ValeStrBuilder* builder = (ValeStrBuilder*)malloc(sizeof(ValeStrBuilder));
+  builder->length = 0;
+  builder->capacity = 64;
+  builder->chars = (char*)malloc(builder->capacity);
+  return (int64_t)(intptr_t)builder;
 }
 
-extern ValeStr* __vale_castI32Str(int32_t n) {
-  return __vale_castI64Str((int64_t)n);
+void __vale_strbuilderAppend_borrowed(int64_t builderHandle, char* chars, ValeInt begin, ValeInt end) {
+  ValeStrBuilder* builder = (ValeStrBuilder*)(intptr_t)builderHandle;
+  ValeInt length = end - begin;
+  assert(length >= 0);
+  if (builder->length + length > builder->capacity) {
+    int64_t newCapacity = builder->capacity * 2;
+    while (builder->length + length > newCapacity) {
+      newCapacity *= 2;
+    }
+    builder->chars = (char*)realloc(builder->chars, newCapacity);
+    builder->capacity = newCapacity;
+  }
+  memcpy(builder->chars + builder->length, chars + begin, length);
+  builder->length += length;
 }
 
-extern ValeStr* __vale_castFloatStr(double f) {
-  char tempBuffer[100] = { 0 };
-  int charsWritten = snprintf(tempBuffer, 100, "%lf", f);
-  ValeStr* result = ValeStrNew(charsWritten);
-  char* resultChars = result->chars;
-  strncpy(resultChars, tempBuffer, charsWritten);
+void __vale_strbuilderAppend(int64_t builderHandle, ValeStr* s, ValeInt begin, ValeInt end) {
+  __vale_strbuilderAppend_borrowed(builderHandle, s->chars, begin, end);
+  free(s);
+}
+
+// Makes the final string and frees the builder.
+ValeStr* __vale_strbuilderFinish(int64_t builderHandle) {
+  ValeStrBuilder* builder = (ValeStrBuilder*)(intptr_t)builderHandle;
+#ifndef VALE_WIDE_LENGTHS
+  assert(builder->length <= INT32_MAX);
+#endif
+  ValeStr* result = ValeStrNew((ValeLength)builder->length);
+  memcpy(result->chars, builder->chars, builder->length);
+  free(builder->chars);
+  free(builder);
   return result;
 }
 
-void __vale_printstr(ValeStr* s, ValeInt start, ValeInt length) {
-  char* chars = s->chars;
-  fwrite(chars + start, 1, length, stdout);
-  free(s);
+ValeInt __vale_strtoascii_borrowed(char* chars, ValeInt begin, ValeInt end) {
+  assert(begin + 1 <= end);
+  return (ValeInt)*(chars + begin);
 }
 
 ValeInt __vale_strtoascii(ValeStr* s, ValeInt begin, ValeInt end) {
-  assert(begin + 1 <= end);
-  char* chars = s->chars;
-  ValeInt result = (ValeInt)*(chars + begin);
+  ValeInt result = __vale_strtoascii_borrowed(s->chars, begin, end);
   free(s);
   return result;
 }
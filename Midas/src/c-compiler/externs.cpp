@@ -19,16 +19,48 @@ Externs::Externs(LLVMModuleRef mod, LLVMContextRef context) {
   malloc = addExtern(mod, "malloc", int8PtrLT, {int64LT});
   free = addExtern(mod, "free", voidLT, {int8PtrLT});
   exit = addExtern(mod, "exit", voidLT, {int64LT});
+  // Every call to exit is a failure path (panics, failed checks), so this also tells LLVM that
+  // whatever branch leads to one is unlikely.
+  for (std::string attrName : {"noreturn", "cold", "nounwind"}) {
+    auto attrKind = LLVMGetEnumAttributeKindForName(attrName.c_str(), attrName.size());
+    LLVMAddAttributeAtIndex(exit, LLVMAttributeFunctionIndex, LLVMCreateEnumAttribute(context, attrKind, 0));
+  }
   assert = addExtern(mod, "__vassert", voidLT, {int1LT, int8PtrLT});
   assertI64Eq = addExtern(mod, "__vassertI64Eq", voidLT, {int64LT, int64LT, int8PtrLT});
   printCStr = addExtern(mod, "__vprintCStr", voidLT, {int8PtrLT});
   getch = addExtern(mod, "getchar", int64LT, {});
   printInt = addExtern(mod, "__vprintI64", voidLT, {int64LT});
+  // The print functions above buffer their output, this writes it out.
+  flush = addExtern(mod, "__vale_flush", voidLT, {});
   strlen = addExtern(mod, "strlen", int32LT, {int8PtrLT});
   strncpy = addExtern(mod, "strncpy", voidLT, {int8PtrLT, int8PtrLT, int64LT});
   memcpy = addExtern(mod, "memcpy", int8PtrLT, {int8PtrLT, int8PtrLT, int64LT});
   memset = addExtern(mod, "memset", voidLT, {int8PtrLT, int8LT, int64LT});
 
+  serializeCacheLend = addExtern(mod, "__vale_serializeCacheLend", int8PtrLT, {int8PtrLT});
+  serializeCacheAdd = addExtern(mod, "__vale_serializeCacheAdd", voidLT, {int8PtrLT, int8PtrLT, int64LT});
+  serializeCacheReturn = addExtern(mod, "__vale_serializeCacheReturn", voidLT, {int8PtrLT, int8PtrLT});
+  serializeCacheForget = addExtern(mod, "__vale_serializeCacheForget", voidLT, {int8PtrLT});
+
+  slabBegin = addExtern(mod, "__vale_slabBegin", voidLT, {int64LT});
+  slabMalloc = addExtern(mod, "__vale_slabMalloc", int8PtrLT, {int64LT, LLVMPointerType(int32LT, 0)});
+  slabEnd = addExtern(mod, "__vale_slabEnd", int64LT, {});
+  slabFree = addExtern(mod, "__vale_slabFree", voidLT, {int8PtrLT});
+
+  sharingBegin = addExtern(mod, "__vale_sharingBegin", voidLT, {});
+  sharingFind = addExtern(mod, "__vale_sharingFind", int8PtrLT, {int8PtrLT});
+  sharingAdd = addExtern(mod, "__vale_sharingAdd", voidLT, {int8PtrLT, int8PtrLT});
+  sharingEnd = addExtern(mod, "__vale_sharingEnd", voidLT, {});
+
+  snapshotAllocate = addExtern(mod, "__vale_snapshotAllocate", int8PtrLT, {int64LT, int64LT});
+  snapshotFree = addExtern(mod, "__vale_snapshotFree", voidLT, {int8PtrLT, int64LT});
+  snapshotWrite =
+      addExtern(mod, "__vale_snapshotWrite", int8LT, {int8PtrLT, int8PtrLT, int64LT, int8PtrLT, int64LT, int64LT});
+  snapshotMap = addExtern(mod, "__vale_snapshotMap", int8PtrLT, {int8PtrLT, int64LT});
+  snapshotRoot = addExtern(mod, "__vale_snapshotRoot", int8PtrLT, {int8PtrLT});
+  snapshotRootType = addExtern(mod, "__vale_snapshotRootType", int64LT, {int8PtrLT});
+  snapshotUnmap = addExtern(mod, "__vale_snapshotUnmap", voidLT, {int8PtrLT});
+
   initTwinPages = addExtern(mod, "__vale_initTwinPages", int8PtrLT, {});
 }
 
@@ -53,3 +85,20 @@ bool includeSizeParam(GlobalState* globalState, Prototype* prototype, int paramI
   }
   return false;
 }
+
+bool isSnapshotSaveExtern(Prototype* prototype) {
+  return hasEnding(prototype->name->name, "_vsnapsave");
+}
+
+bool isSnapshotLoadExtern(Prototype* prototype) {
+  return hasEnding(prototype->name->name, "_vsnapload");
+}
+
+bool isSnapshotExistsExtern(Prototype* prototype) {
+  return hasEnding(prototype->name->name, "_vsnapexists");
+}
+
+bool isSnapshotExtern(Prototype* prototype) {
+  return isSnapshotSaveExtern(prototype) || isSnapshotLoadExtern(prototype) ||
+      isSnapshotExistsExtern(prototype);
+}
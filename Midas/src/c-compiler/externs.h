@@ -11,11 +11,35 @@ public:
   LLVMValueRef printCStr = nullptr;
   LLVMValueRef getch = nullptr;
   LLVMValueRef printInt = nullptr;
+  LLVMValueRef flush = nullptr;
   LLVMValueRef strlen = nullptr;
   LLVMValueRef memset = nullptr;
   LLVMValueRef strncpy = nullptr;
   LLVMValueRef memcpy = nullptr;
 
+  LLVMValueRef serializeCacheLend = nullptr;
+  LLVMValueRef serializeCacheAdd = nullptr;
+  LLVMValueRef serializeCacheReturn = nullptr;
+  LLVMValueRef serializeCacheForget = nullptr;
+
+  LLVMValueRef slabBegin = nullptr;
+  LLVMValueRef slabMalloc = nullptr;
+  LLVMValueRef slabEnd = nullptr;
+  LLVMValueRef slabFree = nullptr;
+
+  LLVMValueRef sharingBegin = nullptr;
+  LLVMValueRef sharingFind = nullptr;
+  LLVMValueRef sharingAdd = nullptr;
+  LLVMValueRef sharingEnd = nullptr;
+
+  LLVMValueRef snapshotAllocate = nullptr;
+  LLVMValueRef snapshotFree = nullptr;
+  LLVMValueRef snapshotWrite = nullptr;
+  LLVMValueRef snapshotMap = nullptr;
+  LLVMValueRef snapshotRoot = nullptr;
+  LLVMValueRef snapshotRootType = nullptr;
+  LLVMValueRef snapshotUnmap = nullptr;
+
   LLVMValueRef initTwinPages = nullptr;
   LLVMValueRef censusContains = nullptr;
   LLVMValueRef censusAdd = nullptr;
@@ -26,4 +50,11 @@ public:
 
 bool includeSizeParam(GlobalState* globalState, Prototype* prototype, int paramIndex);
 
+// Externs ending in _vsnapsave, _vsnapload, or _vsnapexists, which Midas implements itself, see
+// snapshot.c.
+bool isSnapshotSaveExtern(Prototype* prototype);
+bool isSnapshotLoadExtern(Prototype* prototype);
+bool isSnapshotExistsExtern(Prototype* prototype);
+bool isSnapshotExtern(Prototype* prototype);
+
 #endif
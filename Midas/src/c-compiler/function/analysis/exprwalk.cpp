@@ -0,0 +1,130 @@
+#include "function/analysis/exprwalk.h"
+
+void forEachChildExpression(
+    Expression* expr,
+    const std::function<void(Expression*)>& visit) {
+  if (auto discardM = dynamic_cast<Discard*>(expr)) {
+    visit(discardM->sourceExpr);
+  } else if (auto ret = dynamic_cast<Return*>(expr)) {
+    visit(ret->sourceExpr);
+  } else if (auto stackify = dynamic_cast<Stackify*>(expr)) {
+    visit(stackify->sourceExpr);
+  } else if (auto localStore = dynamic_cast<LocalStore*>(expr)) {
+    visit(localStore->sourceExpr);
+  } else if (auto weakAlias = dynamic_cast<WeakAlias*>(expr)) {
+    visit(weakAlias->sourceExpr);
+  } else if (auto newStruct = dynamic_cast<NewStruct*>(expr)) {
+    for (auto sourceExpr : newStruct->sourceExprs) {
+      visit(sourceExpr);
+    }
+  } else if (auto consecutor = dynamic_cast<Consecutor*>(expr)) {
+    for (auto innerExpr : consecutor->exprs) {
+      visit(innerExpr);
+    }
+  } else if (auto block = dynamic_cast<Block*>(expr)) {
+    visit(block->inner);
+  } else if (auto iff = dynamic_cast<If*>(expr)) {
+    visit(iff->conditionExpr);
+    visit(iff->thenExpr);
+    visit(iff->elseExpr);
+  } else if (auto whiile = dynamic_cast<While*>(expr)) {
+    visit(whiile->bodyExpr);
+  } else if (auto destructureM = dynamic_cast<Destroy*>(expr)) {
+    visit(destructureM->structExpr);
+  } else if (auto memberLoad = dynamic_cast<MemberLoad*>(expr)) {
+    visit(memberLoad->structExpr);
+  } else if (auto destroySSAIntoFunction = dynamic_cast<DestroyStaticSizedArrayIntoFunction*>(expr)) {
+    visit(destroySSAIntoFunction->arrayExpr);
+    visit(destroySSAIntoFunction->consumerExpr);
+  } else if (auto destroySSAIntoLocals = dynamic_cast<DestroyStaticSizedArrayIntoLocals*>(expr)) {
+    visit(destroySSAIntoLocals->arrayExpr);
+    visit(destroySSAIntoLocals->consumerExpr);
+  } else if (auto destroyRSA = dynamic_cast<DestroyRuntimeSizedArray*>(expr)) {
+    visit(destroyRSA->arrayExpr);
+    visit(destroyRSA->consumerExpr);
+  } else if (auto ssaLoad = dynamic_cast<StaticSizedArrayLoad*>(expr)) {
+    visit(ssaLoad->arrayExpr);
+    visit(ssaLoad->indexExpr);
+  } else if (auto ssaStore = dynamic_cast<StaticSizedArrayStore*>(expr)) {
+    visit(ssaStore->arrayExpr);
+    visit(ssaStore->indexExpr);
+    visit(ssaStore->sourceExpr);
+  } else if (auto rsaLoad = dynamic_cast<RuntimeSizedArrayLoad*>(expr)) {
+    visit(rsaLoad->arrayExpr);
+    visit(rsaLoad->indexExpr);
+  } else if (auto rsaStore = dynamic_cast<RuntimeSizedArrayStore*>(expr)) {
+    visit(rsaStore->arrayExpr);
+    visit(rsaStore->indexExpr);
+    visit(rsaStore->sourceExpr);
+  } else if (auto arrayLength = dynamic_cast<ArrayLength*>(expr)) {
+    visit(arrayLength->sourceExpr);
+  } else if (auto narrowPermission = dynamic_cast<NarrowPermission*>(expr)) {
+    visit(narrowPermission->sourceExpr);
+  } else if (auto newArrayFromValues = dynamic_cast<NewArrayFromValues*>(expr)) {
+    for (auto sourceExpr : newArrayFromValues->sourceExprs) {
+      visit(sourceExpr);
+    }
+  } else if (auto constructRSA = dynamic_cast<ConstructRuntimeSizedArray*>(expr)) {
+    visit(constructRSA->sizeExpr);
+    visit(constructRSA->generatorExpr);
+  } else if (auto staticArrayFromCallable = dynamic_cast<StaticArrayFromCallable*>(expr)) {
+    visit(staticArrayFromCallable->generatorExpr);
+  } else if (auto call = dynamic_cast<Call*>(expr)) {
+    for (auto argExpr : call->argExprs) {
+      visit(argExpr);
+    }
+  } else if (auto externCall = dynamic_cast<ExternCall*>(expr)) {
+    for (auto argExpr : externCall->argExprs) {
+      visit(argExpr);
+    }
+  } else if (auto interfaceCall = dynamic_cast<InterfaceCall*>(expr)) {
+    for (auto argExpr : interfaceCall->argExprs) {
+      visit(argExpr);
+    }
+  } else if (auto memberStore = dynamic_cast<MemberStore*>(expr)) {
+    // MemberStore evaluates its source before its struct, see translateExpressionInner.
+    visit(memberStore->sourceExpr);
+    visit(memberStore->structExpr);
+  } else if (auto structToInterfaceUpcast = dynamic_cast<StructToInterfaceUpcast*>(expr)) {
+    visit(structToInterfaceUpcast->sourceExpr);
+  } else if (auto interfaceToInterfaceUpcast = dynamic_cast<InterfaceToInterfaceUpcast*>(expr)) {
+    visit(interfaceToInterfaceUpcast->sourceExpr);
+  } else if (auto lockWeak = dynamic_cast<LockWeak*>(expr)) {
+    visit(lockWeak->sourceExpr);
+  } else if (auto asSubtype = dynamic_cast<AsSubtype*>(expr)) {
+    visit(asSubtype->sourceExpr);
+  } else if (auto checkRefCount = dynamic_cast<CheckRefCount*>(expr)) {
+    visit(checkRefCount->refExpr);
+    visit(checkRefCount->numExpr);
+  } else {
+    // Leaves: constants, Argument, LocalLoad, Unstackify.
+  }
+}
+
+void forEachExpression(
+    Expression* expr,
+    const std::function<void(Expression*)>& visit) {
+  visit(expr);
+  forEachChildExpression(expr, [&visit](Expression* child) {
+    forEachExpression(child, visit);
+  });
+}
+
+bool disturbsLocal(Expression* expr, VariableId* localId) {
+  bool result = false;
+  forEachExpression(expr, [&result, localId](Expression* inner) {
+    if (auto unstackify = dynamic_cast<Unstackify*>(inner)) {
+      result = result || unstackify->local->id == localId;
+    } else if (auto localStore = dynamic_cast<LocalStore*>(inner)) {
+      result = result || localStore->local->id == localId;
+    }
+  });
+  return result;
+}
+
+Expression* skipPassthroughs(Expression* expr) {
+  while (auto narrowPermission = dynamic_cast<NarrowPermission*>(expr)) {
+    expr = narrowPermission->sourceExpr;
+  }
+  return expr;
+}
@@ -0,0 +1,27 @@
+#ifndef FUNCTION_ANALYSIS_EXPRWALK_H_
+#define FUNCTION_ANALYSIS_EXPRWALK_H_
+
+#include <functional>
+
+#include "metal/ast.h"
+#include "metal/instructions.h"
+
+// Calls visit on each of expr's direct subexpressions, in the order that
+// translateExpression evaluates them.
+void forEachChildExpression(
+    Expression* expr,
+    const std::function<void(Expression*)>& visit);
+
+// Calls visit on expr and every expression beneath it, parents before children.
+void forEachExpression(
+    Expression* expr,
+    const std::function<void(Expression*)>& visit);
+
+// Whether anything in expr could take the value out of the given local,
+// either by unstackifying it or by swapping something else into it.
+bool disturbsLocal(Expression* expr, VariableId* localId);
+
+// Looks through expressions that don't change the value, such as NarrowPermission.
+Expression* skipPassthroughs(Expression* expr);
+
+#endif
@@ -0,0 +1,343 @@
+#include "globalstate.h"
+#include "function/analysis/exprwalk.h"
+#include "function/analysis/primitives.h"
+#include "function/analysis/knownlive.h"
+
+namespace {
+
+// What we know at a given point in the function.
+struct KnownLiveState {
+  // True if control can't reach this point, such as after a Return.
+  bool unreachable = false;
+  // Borrow locals whose object was checked since the last thing that could
+  // have freed it.
+  std::unordered_set<VariableId*> checkedLocalIds;
+};
+
+KnownLiveState mergeStates(const KnownLiveState& a, const KnownLiveState& b) {
+  if (a.unreachable) {
+    return b;
+  } else if (b.unreachable) {
+    return a;
+  }
+  KnownLiveState result;
+  for (auto localId : a.checkedLocalIds) {
+    if (b.checkedLocalIds.count(localId)) {
+      result.checkedLocalIds.insert(localId);
+    }
+  }
+  return result;
+}
+
+// Whether the given expression itself (not counting its children) could free
+// an object some borrow points at.
+bool mightFree(const std::unordered_set<std::string>& nonFreeingFunctionNames, Expression* expr) {
+  if (auto call = dynamic_cast<Call*>(expr)) {
+    return nonFreeingFunctionNames.count(call->function->name->name) == 0;
+  } else if (auto externCall = dynamic_cast<ExternCall*>(expr)) {
+    // Externs can call back into exported Vale functions, but builtins don't.
+    return externCall->function->name->name.rfind("__vbi_", 0) != 0;
+  } else if (dynamic_cast<InterfaceCall*>(expr) ||
+      dynamic_cast<Destroy*>(expr) ||
+      dynamic_cast<DestroyStaticSizedArrayIntoFunction*>(expr) ||
+      dynamic_cast<DestroyStaticSizedArrayIntoLocals*>(expr) ||
+      dynamic_cast<DestroyRuntimeSizedArray*>(expr) ||
+      dynamic_cast<ConstructRuntimeSizedArray*>(expr) ||
+      dynamic_cast<StaticArrayFromCallable*>(expr) ||
+      dynamic_cast<LockWeak*>(expr) ||
+      dynamic_cast<AsSubtype*>(expr)) {
+    return true;
+  } else if (auto discardM = dynamic_cast<Discard*>(expr)) {
+    return discardM->sourceResultType->ownership == Ownership::OWN;
+  }
+  return false;
+}
+
+bool mightFree(GlobalState* globalState, Expression* expr) {
+  return mightFree(globalState->nonFreeingFunctionNames, expr);
+}
+
+bool neverReturns(GlobalState* globalState, Expression* expr) {
+  if (dynamic_cast<Return*>(expr)) {
+    return true;
+  } else if (auto call = dynamic_cast<Call*>(expr)) {
+    return call->function->returnType->kind == globalState->metalCache->never;
+  } else if (auto interfaceCall = dynamic_cast<InterfaceCall*>(expr)) {
+    return interfaceCall->functionType->returnType->kind == globalState->metalCache->never;
+  } else if (auto externCall = dynamic_cast<ExternCall*>(expr)) {
+    return externCall->function->returnType->kind == globalState->metalCache->never;
+  }
+  return false;
+}
+
+class KnownLiveAnalyzer {
+public:
+  KnownLiveAnalyzer(GlobalState* globalState_, InferredKnownLives* result_) :
+      globalState(globalState_),
+      result(result_) {}
+
+  KnownLiveState analyze(Expression* expr, KnownLiveState state) {
+    if (auto iff = dynamic_cast<If*>(expr)) {
+      auto afterCondition = analyze(iff->conditionExpr, state);
+      return mergeStates(
+          analyze(iff->thenExpr, afterCondition),
+          analyze(iff->elseExpr, afterCondition));
+    } else if (auto whiile = dynamic_cast<While*>(expr)) {
+      // The body runs at least once, and we leave the loop right after a
+      // body, so the state after the loop is the state after the body. We
+      // just need a state that holds at the start of every iteration, so
+      // drop anything the body might invalidate.
+      auto bodyExpr = whiile->bodyExpr;
+      bool bodyMightFree = false;
+      forEachExpression(bodyExpr, [this, &bodyMightFree](Expression* inner) {
+        bodyMightFree = bodyMightFree || mightFree(globalState, inner);
+      });
+      if (bodyMightFree) {
+        state.checkedLocalIds.clear();
+      } else {
+        for (auto iter = state.checkedLocalIds.begin(); iter != state.checkedLocalIds.end(); ) {
+          if (disturbsLocal(bodyExpr, *iter)) {
+            iter = state.checkedLocalIds.erase(iter);
+          } else {
+            iter++;
+          }
+        }
+        if (globalState->opt->hoistLoopChecks) {
+          hoistChecks(whiile, &state);
+        }
+      }
+      return analyze(bodyExpr, state);
+    } else if (auto memberLoad = dynamic_cast<MemberLoad*>(expr)) {
+      state = analyze(memberLoad->structExpr, state);
+      visitAccess(memberLoad, memberLoad->structKnownLive, memberLoad->structExpr, &state, {});
+      return state;
+    } else if (auto memberStore = dynamic_cast<MemberStore*>(expr)) {
+      state = analyze(memberStore->sourceExpr, state);
+      state = analyze(memberStore->structExpr, state);
+      visitAccess(memberStore, memberStore->structKnownLive, memberStore->structExpr, &state, {});
+      return state;
+    } else if (auto ssaLoad = dynamic_cast<StaticSizedArrayLoad*>(expr)) {
+      state = analyze(ssaLoad->arrayExpr, state);
+      state = analyze(ssaLoad->indexExpr, state);
+      visitAccess(ssaLoad, ssaLoad->arrayKnownLive, ssaLoad->arrayExpr, &state, {ssaLoad->indexExpr});
+      return state;
+    } else if (auto rsaLoad = dynamic_cast<RuntimeSizedArrayLoad*>(expr)) {
+      state = analyze(rsaLoad->arrayExpr, state);
+      state = analyze(rsaLoad->indexExpr, state);
+      visitAccess(rsaLoad, rsaLoad->arrayKnownLive, rsaLoad->arrayExpr, &state, {rsaLoad->indexExpr});
+      return state;
+    } else if (auto rsaStore = dynamic_cast<RuntimeSizedArrayStore*>(expr)) {
+      // This reads the array's length before evaluating the index and source,
+      // and uses the same knownLive for both, so it must be live at both points.
+      state = analyze(rsaStore->arrayExpr, state);
+      bool liveBeforeIndex = isAccessLive(rsaStore->arrayExpr, state, {});
+      noteChecked(rsaStore->arrayExpr, &state);
+      state = analyze(rsaStore->indexExpr, state);
+      state = analyze(rsaStore->sourceExpr, state);
+      if (liveBeforeIndex) {
+        visitAccess(
+            rsaStore, rsaStore->arrayKnownLive, rsaStore->arrayExpr, &state,
+            {rsaStore->indexExpr, rsaStore->sourceExpr});
+      }
+      return state;
+    } else if (auto arrayLength = dynamic_cast<ArrayLength*>(expr)) {
+      state = analyze(arrayLength->sourceExpr, state);
+      visitAccess(arrayLength, arrayLength->sourceKnownLive, arrayLength->sourceExpr, &state, {});
+      return state;
+    } else {
+      forEachChildExpression(expr, [this, &state](Expression* child) {
+        state = analyze(child, state);
+      });
+      if (auto unstackify = dynamic_cast<Unstackify*>(expr)) {
+        state.checkedLocalIds.erase(unstackify->local->id);
+      } else if (auto localStore = dynamic_cast<LocalStore*>(expr)) {
+        state.checkedLocalIds.erase(localStore->local->id);
+      }
+      if (mightFree(globalState, expr)) {
+        state.checkedLocalIds.clear();
+      }
+      if (neverReturns(globalState, expr)) {
+        state.unreachable = true;
+      }
+      return state;
+    }
+  }
+
+private:
+  GlobalState* globalState;
+  InferredKnownLives* result;
+
+  LocalLoad* getBorrowingLocalLoad(Expression* refExpr) {
+    auto localLoad = dynamic_cast<LocalLoad*>(skipPassthroughs(refExpr));
+    if (localLoad && localLoad->targetOwnership == Ownership::BORROW) {
+      return localLoad;
+    }
+    return nullptr;
+  }
+
+  // Whether the object refExpr loaded is live at this point, where
+  // evaluatedInBetween ran after the load.
+  bool isAccessLive(
+      Expression* refExpr,
+      const KnownLiveState& state,
+      std::initializer_list<Expression*> evaluatedInBetween) {
+    auto localLoad = getBorrowingLocalLoad(refExpr);
+    if (!localLoad || state.unreachable) {
+      return false;
+    }
+    auto local = localLoad->local;
+    if (local->type->ownership == Ownership::OWN) {
+      // Nothing can free the object while its owner is still in our local.
+      for (auto inBetween : evaluatedInBetween) {
+        if (disturbsLocal(inBetween, local->id)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    return state.checkedLocalIds.count(local->id) != 0;
+  }
+
+  // After an access, we know its object is live, either because the check
+  // passed or because it didn't need one.
+  void noteChecked(Expression* refExpr, KnownLiveState* state) {
+    auto localLoad = getBorrowingLocalLoad(refExpr);
+    if (localLoad && !state->unreachable &&
+        localLoad->local->type->ownership == Ownership::BORROW) {
+      state->checkedLocalIds.insert(localLoad->local->id);
+    }
+  }
+
+  // If a loop's first iteration is sure to reach through a borrow local, and
+  // nothing in the loop can free the object or change the local, then one
+  // check before the loop covers the accesses in every iteration.
+  // Only called when the body can't free anything.
+  void hoistChecks(While* whiile, KnownLiveState* state) {
+    if (state->unreachable) {
+      return;
+    }
+    auto bodyExpr = whiile->bodyExpr;
+    std::vector<Local*> accessedLocals;
+    collectFirstIterationAccesses(bodyExpr, &accessedLocals);
+    for (auto local : accessedLocals) {
+      auto region = globalState->getRegion(local->type);
+      // Only these regions check a borrow before using it.
+      if (local->type->ownership != Ownership::BORROW ||
+          (region != globalState->resilientV3Region && region != globalState->resilientV4Region) ||
+          state->checkedLocalIds.count(local->id) ||
+          disturbsLocal(bodyExpr, local->id) ||
+          declaresLocal(bodyExpr, local->id)) {
+        continue;
+      }
+      state->checkedLocalIds.insert(local->id);
+      result->hoistedChecksByWhile[whiile].push_back(local);
+    }
+  }
+
+  // Collects the borrow locals that expr reaches through no matter what,
+  // before it could branch away. Returns whether control can continue past
+  // expr without having branched.
+  bool collectFirstIterationAccesses(Expression* expr, std::vector<Local*>* accessedLocals) {
+    if (auto iff = dynamic_cast<If*>(expr)) {
+      // Only one of the branches will run, so stop looking after the condition.
+      collectFirstIterationAccesses(iff->conditionExpr, accessedLocals);
+      return false;
+    }
+    bool continues = true;
+    forEachChildExpression(expr, [this, &continues, accessedLocals](Expression* child) {
+      continues = continues && collectFirstIterationAccesses(child, accessedLocals);
+    });
+    if (!continues) {
+      return false;
+    }
+    Expression* refExpr = nullptr;
+    if (auto memberLoad = dynamic_cast<MemberLoad*>(expr)) {
+      refExpr = memberLoad->structExpr;
+    } else if (auto memberStore = dynamic_cast<MemberStore*>(expr)) {
+      refExpr = memberStore->structExpr;
+    } else if (auto ssaLoad = dynamic_cast<StaticSizedArrayLoad*>(expr)) {
+      refExpr = ssaLoad->arrayExpr;
+    } else if (auto rsaLoad = dynamic_cast<RuntimeSizedArrayLoad*>(expr)) {
+      refExpr = rsaLoad->arrayExpr;
+    } else if (auto rsaStore = dynamic_cast<RuntimeSizedArrayStore*>(expr)) {
+      refExpr = rsaStore->arrayExpr;
+    } else if (auto arrayLength = dynamic_cast<ArrayLength*>(expr)) {
+      refExpr = arrayLength->sourceExpr;
+    } else if (dynamic_cast<Call*>(expr)) {
+      // Such as len(&arr), which checks arr inside the callee.
+      auto maybePrimitiveCall = matchPrimitiveCall(globalState, expr);
+      if (maybePrimitiveCall.has_value() &&
+          dynamic_cast<ArrayLength*>(maybePrimitiveCall->primitive)) {
+        refExpr = maybePrimitiveCall->operands[0];
+      }
+    }
+    if (refExpr) {
+      if (auto localLoad = getBorrowingLocalLoad(refExpr)) {
+        accessedLocals->push_back(localLoad->local);
+      }
+    }
+    return !neverReturns(globalState, expr);
+  }
+
+  bool declaresLocal(Expression* expr, VariableId* localId) {
+    bool result = false;
+    forEachExpression(expr, [&result, localId](Expression* inner) {
+      if (auto stackify = dynamic_cast<Stackify*>(inner)) {
+        result = result || stackify->local->id == localId;
+      }
+    });
+    return result;
+  }
+
+  void visitAccess(
+      Expression* access,
+      bool frontEndKnownLive,
+      Expression* refExpr,
+      KnownLiveState* state,
+      std::initializer_list<Expression*> evaluatedInBetween) {
+    if (!frontEndKnownLive && isAccessLive(refExpr, *state, evaluatedInBetween)) {
+      result->accesses.insert(access);
+    }
+    noteChecked(refExpr, state);
+  }
+};
+
+}
+
+InferredKnownLives inferKnownLives(GlobalState* globalState, Function* functionM) {
+  InferredKnownLives result;
+  KnownLiveAnalyzer(globalState, &result).analyze(functionM->block, KnownLiveState());
+  return result;
+}
+
+std::unordered_set<std::string> findNonFreeingFunctions(GlobalState* globalState, Program* program) {
+  // Start by assuming nothing frees, then rule out functions until nothing
+  // changes. This way, recursive functions that don't otherwise free stay in.
+  std::unordered_set<std::string> result;
+  std::vector<Function*> functions;
+  for (auto [packageCoord, package] : program->packages) {
+    for (auto [name, function] : package->functions) {
+      result.insert(function->prototype->name->name);
+      functions.push_back(function);
+    }
+  }
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto function : functions) {
+      auto name = function->prototype->name->name;
+      if (result.count(name) == 0) {
+        continue;
+      }
+      bool frees = false;
+      forEachExpression(function->block, [&result, &frees](Expression* expr) {
+        frees = frees || mightFree(result, expr);
+      });
+      if (frees) {
+        result.erase(name);
+        changed = true;
+      }
+    }
+  }
+  return result;
+}
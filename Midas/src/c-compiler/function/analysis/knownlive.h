@@ -0,0 +1,51 @@
+#ifndef FUNCTION_ANALYSIS_KNOWNLIVE_H_
+#define FUNCTION_ANALYSIS_KNOWNLIVE_H_
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "metal/ast.h"
+#include "metal/instructions.h"
+
+class GlobalState;
+
+// The struct and array accesses that we can prove are to a live object, even
+// though the front end didn't mark them knownLive.
+//
+// An access is known live if it goes through a local that owns the object,
+// or through a borrow local that an earlier access already checked, with no
+// call or destroy in between that could have freed the object.
+class InferredKnownLives {
+public:
+  std::unordered_set<Expression*> accesses;
+  // Borrow locals to check once before each While, instead of on every
+  // iteration. See --hoist-loop-checks.
+  std::unordered_map<While*, std::vector<Local*>> hoistedChecksByWhile;
+
+  bool contains(Expression* access) const {
+    return accesses.count(access) != 0;
+  }
+  int size() const {
+    return accesses.size();
+  }
+  int numHoistedChecks() const {
+    int result = 0;
+    for (auto& whileAndLocals : hoistedChecksByWhile) {
+      result += whileAndLocals.second.size();
+    }
+    return result;
+  }
+};
+
+// Looks through the function's blocks, Ifs and Whiles for accesses whose
+// liveness check is redundant.
+InferredKnownLives inferKnownLives(GlobalState* globalState, Function* functionM);
+
+// Names of the functions that can't free a mutable object, neither directly
+// nor through anything they call, so calling them doesn't invalidate what we
+// know. Builtin externs (the __vbi_ ones) are assumed not to free.
+std::unordered_set<std::string> findNonFreeingFunctions(GlobalState* globalState, Program* program);
+
+#endif
@@ -0,0 +1,190 @@
+#include <unordered_map>
+
+#include "globalstate.h"
+#include "function/analysis/exprwalk.h"
+#include "function/analysis/primitives.h"
+#include "function/analysis/loopbounds.h"
+
+namespace {
+
+LocalLoad* getLocalLoad(Expression* expr) {
+  return dynamic_cast<LocalLoad*>(skipPassthroughs(expr));
+}
+
+Expression* skipBlocks(Expression* expr) {
+  expr = skipPassthroughs(expr);
+  while (auto block = dynamic_cast<Block*>(expr)) {
+    expr = skipPassthroughs(block->inner);
+  }
+  return expr;
+}
+
+// Whether expr contains target, and it isn't inside a While in expr.
+bool containsOutsideOfWhiles(Expression* expr, Expression* target) {
+  if (expr == target) {
+    return true;
+  } else if (dynamic_cast<While*>(expr)) {
+    return false;
+  }
+  bool result = false;
+  forEachChildExpression(expr, [&result, target](Expression* child) {
+    result = result || containsOutsideOfWhiles(child, target);
+  });
+  return result;
+}
+
+class LoopBoundsAnalyzer {
+public:
+  LoopBoundsAnalyzer(GlobalState* globalState_, InBoundsAccesses* result_) :
+      globalState(globalState_),
+      result(result_) {}
+
+  void analyze(Function* functionM) {
+    forEachExpression(functionM->block, [this](Expression* expr) {
+      if (auto stackify = dynamic_cast<Stackify*>(expr)) {
+        stackifiesByLocalId[stackify->local->id].push_back(stackify);
+      } else if (auto localStore = dynamic_cast<LocalStore*>(expr)) {
+        storesByLocalId[localStore->local->id].push_back(localStore);
+      }
+    });
+    forEachExpression(functionM->block, [this](Expression* expr) {
+      if (auto whiile = dynamic_cast<While*>(expr)) {
+        visitWhile(whiile);
+      }
+    });
+  }
+
+private:
+  GlobalState* globalState;
+  InBoundsAccesses* result;
+  std::unordered_map<VariableId*, std::vector<Stackify*>> stackifiesByLocalId;
+  std::unordered_map<VariableId*, std::vector<LocalStore*>> storesByLocalId;
+
+  void visitWhile(While* whiile) {
+    // Valestrom turns while (cond) { body } into:
+    //   While(Block(If(cond, Block(Consecutor([body, true])), Block(false))))
+    auto iff = dynamic_cast<If*>(skipBlocks(whiile->bodyExpr));
+    if (!iff) {
+      return;
+    }
+    auto maybeCondition = matchPrimitiveCall(globalState, iff->conditionExpr);
+    if (!maybeCondition.has_value()) {
+      return;
+    }
+    // The loop can count with an int or an i64, as long as the increment uses the same one.
+    std::string intSuffix;
+    if (maybeCondition->externName() == "__vbi_lessThanI32") {
+      intSuffix = "I32";
+    } else if (maybeCondition->externName() == "__vbi_lessThanI64") {
+      intSuffix = "I64";
+    } else {
+      return;
+    }
+    auto indexLoad = getLocalLoad(maybeCondition->operands[0]);
+    auto maybeLength = matchPrimitiveCall(globalState, maybeCondition->operands[1]);
+    if (!indexLoad || !maybeLength.has_value() ||
+        !dynamic_cast<ArrayLength*>(maybeLength->primitive)) {
+      return;
+    }
+    auto arrayLoad = getLocalLoad(maybeLength->operands[0]);
+    if (!arrayLoad || disturbsLocal(whiile->bodyExpr, arrayLoad->local->id)) {
+      return;
+    }
+    auto indexLocalId = indexLoad->local->id;
+    auto increment = getOnlyIncrement(indexLocalId, "__vbi_add" + intSuffix);
+    if (!increment ||
+        !startsNonNegative(whiile, indexLocalId) ||
+        !containsOutsideOfWhiles(iff->thenExpr, increment)) {
+      return;
+    }
+
+    // Every access that reads i before the increment sees a value that
+    // passed the condition.
+    bool incremented = false;
+    std::unordered_set<Expression*> indexLoadsBeforeIncrement;
+    forEachExpressionPostOrder(iff->thenExpr, [&](Expression* expr) {
+      if (expr == increment) {
+        incremented = true;
+      } else if (auto localLoad = dynamic_cast<LocalLoad*>(expr)) {
+        if (!incremented && localLoad->local->id == indexLocalId) {
+          indexLoadsBeforeIncrement.insert(localLoad);
+        }
+      } else if (auto rsaLoad = dynamic_cast<RuntimeSizedArrayLoad*>(expr)) {
+        visitAccess(rsaLoad, rsaLoad->arrayExpr, rsaLoad->indexExpr, arrayLoad, indexLoadsBeforeIncrement);
+      } else if (auto rsaStore = dynamic_cast<RuntimeSizedArrayStore*>(expr)) {
+        visitAccess(rsaStore, rsaStore->arrayExpr, rsaStore->indexExpr, arrayLoad, indexLoadsBeforeIncrement);
+      }
+    });
+  }
+
+  void visitAccess(
+      Expression* access,
+      Expression* arrayExpr,
+      Expression* indexExpr,
+      LocalLoad* loopArrayLoad,
+      const std::unordered_set<Expression*>& indexLoadsBeforeIncrement) {
+    auto arrayLoad = getLocalLoad(arrayExpr);
+    auto indexLoad = getLocalLoad(indexExpr);
+    if (arrayLoad && indexLoad &&
+        arrayLoad->local->id == loopArrayLoad->local->id &&
+        indexLoadsBeforeIncrement.count(indexLoad)) {
+      result->accesses.insert(access);
+    }
+  }
+
+  // If the only thing that ever changes the local is a single
+  //   set i = i + 1;
+  // returns that LocalStore.
+  LocalStore* getOnlyIncrement(VariableId* localId, const std::string& addExternName) {
+    auto& stores = storesByLocalId[localId];
+    if (stores.size() != 1) {
+      return nullptr;
+    }
+    auto store = stores[0];
+    auto maybeAdd = matchPrimitiveCall(globalState, store->sourceExpr);
+    if (!maybeAdd.has_value() || maybeAdd->externName() != addExternName) {
+      return nullptr;
+    }
+    auto addendLoad = getLocalLoad(maybeAdd->operands[0]);
+    auto addend = dynamic_cast<ConstantInt*>(skipPassthroughs(maybeAdd->operands[1]));
+    if (!addendLoad || addendLoad->local->id != localId || !addend || addend->value != 1) {
+      return nullptr;
+    }
+    return store;
+  }
+
+  // Whether the local is made once, outside the loop, from a non-negative
+  // constant. With the increment as the only store, it can't go negative, and
+  // it can't overflow because it's only incremented when below a length.
+  bool startsNonNegative(While* whiile, VariableId* localId) {
+    auto& stackifies = stackifiesByLocalId[localId];
+    if (stackifies.size() != 1) {
+      return false;
+    }
+    auto stackify = stackifies[0];
+    bool insideLoop = false;
+    forEachExpression(whiile->bodyExpr, [&insideLoop, stackify](Expression* expr) {
+      insideLoop = insideLoop || expr == stackify;
+    });
+    auto initial = dynamic_cast<ConstantInt*>(skipPassthroughs(stackify->sourceExpr));
+    return !insideLoop && initial && initial->value >= 0;
+  }
+
+  // Children before parents, in the order translateExpression evaluates them.
+  void forEachExpressionPostOrder(
+      Expression* expr,
+      const std::function<void(Expression*)>& visit) {
+    forEachChildExpression(expr, [this, &visit](Expression* child) {
+      forEachExpressionPostOrder(child, visit);
+    });
+    visit(expr);
+  }
+};
+
+}
+
+InBoundsAccesses findInBoundsAccesses(GlobalState* globalState, Function* functionM) {
+  InBoundsAccesses result;
+  LoopBoundsAnalyzer(globalState, &result).analyze(functionM);
+  return result;
+}
@@ -0,0 +1,34 @@
+#ifndef FUNCTION_ANALYSIS_LOOPBOUNDS_H_
+#define FUNCTION_ANALYSIS_LOOPBOUNDS_H_
+
+#include <unordered_set>
+
+#include "metal/ast.h"
+#include "metal/instructions.h"
+
+class GlobalState;
+
+// The runtime-sized array accesses whose index we can prove is in bounds,
+// because they're in a loop like:
+//   i = 0;
+//   while (i < len(&arr)) {
+//     ... arr[i] ...
+//     set i = i + 1;
+//   }
+// where i starts non-negative, only ever goes up by one, and is checked
+// against the same array's length at the top of each iteration.
+class InBoundsAccesses {
+public:
+  std::unordered_set<Expression*> accesses;
+
+  bool contains(Expression* access) const {
+    return accesses.count(access) != 0;
+  }
+  int size() const {
+    return accesses.size();
+  }
+};
+
+InBoundsAccesses findInBoundsAccesses(GlobalState* globalState, Function* functionM);
+
+#endif
@@ -0,0 +1,141 @@
+#include <unordered_map>
+
+#include "globalstate.h"
+#include "function/analysis/exprwalk.h"
+#include "function/analysis/primitives.h"
+
+namespace {
+
+bool isBuiltinExternCall(Expression* expr) {
+  auto externCall = dynamic_cast<ExternCall*>(expr);
+  return externCall && externCall->function->name->name.rfind("__vbi_", 0) == 0;
+}
+
+// What a forwarding function does: its result is primitive, applied to the
+// parameters at operandParamIndices.
+struct ForwardingBody {
+  Expression* primitive;
+  std::vector<int> operandParamIndices;
+};
+
+// Whether expr is something a forwarding function can contain besides its
+// primitive: moving the parameters in and out of locals, and returning.
+bool isForwardingGlue(Expression* expr) {
+  if (auto discardM = dynamic_cast<Discard*>(expr)) {
+    return discardM->sourceResultType->ownership != Ownership::OWN;
+  }
+  return dynamic_cast<Block*>(expr) ||
+      dynamic_cast<Consecutor*>(expr) ||
+      dynamic_cast<Stackify*>(expr) ||
+      dynamic_cast<Unstackify*>(expr) ||
+      dynamic_cast<LocalLoad*>(expr) ||
+      dynamic_cast<Argument*>(expr) ||
+      dynamic_cast<Return*>(expr) ||
+      dynamic_cast<NarrowPermission*>(expr);
+}
+
+std::optional<ForwardingBody> analyzeForwardingFunction(Function* functionM) {
+  Expression* primitive = nullptr;
+  Return* ret = nullptr;
+  std::unordered_map<VariableId*, Stackify*> stackifyByLocalId;
+  bool isForwarding = true;
+  forEachExpression(functionM->block, [&](Expression* expr) {
+    if (isBuiltinExternCall(expr) || dynamic_cast<ArrayLength*>(expr)) {
+      isForwarding = isForwarding && primitive == nullptr;
+      primitive = expr;
+    } else if (!isForwardingGlue(expr)) {
+      isForwarding = false;
+    } else if (auto stackify = dynamic_cast<Stackify*>(expr)) {
+      isForwarding = isForwarding && stackifyByLocalId.count(stackify->local->id) == 0;
+      stackifyByLocalId[stackify->local->id] = stackify;
+    } else if (auto retM = dynamic_cast<Return*>(expr)) {
+      isForwarding = isForwarding && ret == nullptr;
+      ret = retM;
+    }
+  });
+  if (!isForwarding || !primitive || !ret) {
+    return std::nullopt;
+  }
+
+  // Follow the returned value back to the primitive, through any temporaries.
+  auto resultExpr = ret->sourceExpr;
+  while (resultExpr != primitive) {
+    resultExpr = skipPassthroughs(resultExpr);
+    if (auto block = dynamic_cast<Block*>(resultExpr)) {
+      resultExpr = block->inner;
+    } else if (auto consecutor = dynamic_cast<Consecutor*>(resultExpr)) {
+      resultExpr = consecutor->exprs.back();
+    } else if (auto unstackify = dynamic_cast<Unstackify*>(resultExpr)) {
+      auto stackifyIter = stackifyByLocalId.find(unstackify->local->id);
+      if (stackifyIter == stackifyByLocalId.end()) {
+        return std::nullopt;
+      }
+      resultExpr = stackifyIter->second->sourceExpr;
+    } else if (resultExpr != primitive) {
+      return std::nullopt;
+    }
+  }
+
+  std::vector<Expression*> primitiveOperands;
+  if (auto externCall = dynamic_cast<ExternCall*>(primitive)) {
+    primitiveOperands = externCall->argExprs;
+  } else if (auto arrayLength = dynamic_cast<ArrayLength*>(primitive)) {
+    primitiveOperands = {arrayLength->sourceExpr};
+  }
+  ForwardingBody body{primitive, {}};
+  for (auto operand : primitiveOperands) {
+    operand = skipPassthroughs(operand);
+    Local* local = nullptr;
+    if (auto localLoad = dynamic_cast<LocalLoad*>(operand)) {
+      local = localLoad->local;
+    } else if (auto unstackify = dynamic_cast<Unstackify*>(operand)) {
+      local = unstackify->local;
+    }
+    if (local) {
+      auto stackifyIter = stackifyByLocalId.find(local->id);
+      if (stackifyIter == stackifyByLocalId.end()) {
+        return std::nullopt;
+      }
+      operand = skipPassthroughs(stackifyIter->second->sourceExpr);
+    }
+    if (auto argument = dynamic_cast<Argument*>(operand)) {
+      body.operandParamIndices.push_back(argument->argumentIndex);
+    } else {
+      return std::nullopt;
+    }
+  }
+  return body;
+}
+
+}
+
+std::string PrimitiveCall::externName() const {
+  if (auto externCall = dynamic_cast<ExternCall*>(primitive)) {
+    return externCall->function->name->name;
+  }
+  return "";
+}
+
+std::optional<PrimitiveCall> matchPrimitiveCall(GlobalState* globalState, Expression* expr) {
+  expr = skipPassthroughs(expr);
+  if (isBuiltinExternCall(expr)) {
+    return PrimitiveCall{expr, dynamic_cast<ExternCall*>(expr)->argExprs};
+  } else if (auto arrayLength = dynamic_cast<ArrayLength*>(expr)) {
+    return PrimitiveCall{expr, {arrayLength->sourceExpr}};
+  } else if (auto call = dynamic_cast<Call*>(expr)) {
+    auto maybeCallee = globalState->program->getMaybeFunction(call->function->name);
+    if (!maybeCallee.has_value()) {
+      return std::nullopt;
+    }
+    auto maybeBody = analyzeForwardingFunction(*maybeCallee);
+    if (!maybeBody.has_value()) {
+      return std::nullopt;
+    }
+    PrimitiveCall result{maybeBody->primitive, {}};
+    for (auto paramIndex : maybeBody->operandParamIndices) {
+      result.operands.push_back(call->argExprs[paramIndex]);
+    }
+    return result;
+  }
+  return std::nullopt;
+}
@@ -0,0 +1,30 @@
+#ifndef FUNCTION_ANALYSIS_PRIMITIVES_H_
+#define FUNCTION_ANALYSIS_PRIMITIVES_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "metal/ast.h"
+#include "metal/instructions.h"
+
+class GlobalState;
+
+// A builtin operation, either written directly or through a Vale function that
+// just forwards its parameters to it, like arith.vale's
+//   fn <(left int, right int) bool { __vbi_lessThanI32(left, right) }
+// or the builtin len() that wraps an ArrayLength.
+struct PrimitiveCall {
+  // The __vbi_ ExternCall or ArrayLength that does the work. If we looked
+  // through a wrapper, this is in the wrapper's body.
+  Expression* primitive;
+  // The caller's expressions that become the primitive's operands, in order.
+  std::vector<Expression*> operands;
+
+  // The __vbi_ extern's name, or empty if this is an ArrayLength.
+  std::string externName() const;
+};
+
+std::optional<PrimitiveCall> matchPrimitiveCall(GlobalState* globalState, Expression* expr);
+
+#endif
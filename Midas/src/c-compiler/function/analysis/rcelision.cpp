@@ -0,0 +1,175 @@
+#include <unordered_map>
+
+#include "globalstate.h"
+#include "region/rcimm/rcimm.h"
+#include "function/analysis/exprwalk.h"
+#include "function/analysis/rcelision.h"
+
+namespace {
+
+bool isElidableType(GlobalState* globalState, Reference* refMT) {
+  if (refMT == globalState->metalCache->emptyTupleStructRef) {
+    return false;
+  }
+  auto kind = refMT->kind;
+  if (dynamic_cast<Int*>(kind) || dynamic_cast<Bool*>(kind) ||
+      dynamic_cast<Float*>(kind) || dynamic_cast<Never*>(kind)) {
+    return false;
+  }
+  if (refMT->location != Location::YONDER) {
+    return false;
+  }
+  auto region = globalState->getRegion(refMT);
+  if (refMT->ownership == Ownership::BORROW) {
+    return region == globalState->naiveRcRegion;
+  } else if (refMT->ownership == Ownership::SHARE) {
+    return region == globalState->rcImm;
+  } else {
+    return false;
+  }
+}
+
+// Same as the result type calculated in translateLocalLoad.
+Reference* getLocalLoadResultType(GlobalState* globalState, LocalLoad* localLoad) {
+  auto localType = localLoad->local->type;
+  auto targetOwnership = localLoad->targetOwnership;
+  auto targetLocation =
+      targetOwnership == Ownership::SHARE ? localType->location : Location::YONDER;
+  return globalState->metalCache->getReference(targetOwnership, targetLocation, localType->kind);
+}
+
+class RcElisionAnalyzer {
+public:
+  RcElisionAnalyzer(GlobalState* globalState_, RcElisions* result_) :
+      globalState(globalState_),
+      result(result_) {}
+
+  void analyze(Function* functionM) {
+    forEachExpression(functionM->block, [this](Expression* expr) {
+      if (auto unstackify = dynamic_cast<Unstackify*>(expr)) {
+        numUnstackifies[unstackify->local->id]++;
+      } else if (auto localStore = dynamic_cast<LocalStore*>(expr)) {
+        storedLocalIds.insert(localStore->local->id);
+      }
+    });
+    forEachExpression(functionM->block, [this](Expression* expr) {
+      visit(expr);
+    });
+  }
+
+private:
+  GlobalState* globalState;
+  RcElisions* result;
+  std::unordered_map<VariableId*, int> numUnstackifies;
+  std::unordered_set<VariableId*> storedLocalIds;
+
+  // If sourceExpr is a load of a local that stays put until consumerType is
+  // dealiased, returns that load.
+  LocalLoad* getElidableLoad(
+      Expression* sourceExpr,
+      Reference* consumerType,
+      std::initializer_list<Expression*> evaluatedInBetween) {
+    auto localLoad = dynamic_cast<LocalLoad*>(skipPassthroughs(sourceExpr));
+    if (!localLoad || result->aliasElided(localLoad)) {
+      return nullptr;
+    }
+    auto loadType = getLocalLoadResultType(globalState, localLoad);
+    if (!isElidableType(globalState, loadType) ||
+        !isElidableType(globalState, consumerType) ||
+        loadType->ownership != consumerType->ownership) {
+      return nullptr;
+    }
+    for (auto inBetween : evaluatedInBetween) {
+      if (disturbsLocal(inBetween, localLoad->local->id)) {
+        return nullptr;
+      }
+    }
+    return localLoad;
+  }
+
+  void elideConsumer(
+      Expression* consumer,
+      Expression* sourceExpr,
+      Reference* consumerType,
+      std::initializer_list<Expression*> evaluatedInBetween) {
+    if (auto localLoad = getElidableLoad(sourceExpr, consumerType, evaluatedInBetween)) {
+      result->elidedAliases.insert(localLoad);
+      result->elidedDealiases.insert(consumer);
+    }
+  }
+
+  void visit(Expression* expr) {
+    if (auto memberLoad = dynamic_cast<MemberLoad*>(expr)) {
+      elideConsumer(memberLoad, memberLoad->structExpr, memberLoad->structType, {});
+    } else if (auto memberStore = dynamic_cast<MemberStore*>(expr)) {
+      // The struct is evaluated after the source, so nothing runs in between.
+      elideConsumer(memberStore, memberStore->structExpr, memberStore->structType, {});
+    } else if (auto arrayLength = dynamic_cast<ArrayLength*>(expr)) {
+      elideConsumer(arrayLength, arrayLength->sourceExpr, arrayLength->sourceType, {});
+    } else if (auto weakAlias = dynamic_cast<WeakAlias*>(expr)) {
+      elideConsumer(weakAlias, weakAlias->sourceExpr, weakAlias->sourceType, {});
+    } else if (auto discardM = dynamic_cast<Discard*>(expr)) {
+      elideConsumer(discardM, discardM->sourceExpr, discardM->sourceResultType, {});
+    } else if (auto ssaLoad = dynamic_cast<StaticSizedArrayLoad*>(expr)) {
+      elideConsumer(ssaLoad, ssaLoad->arrayExpr, ssaLoad->arrayType, {ssaLoad->indexExpr});
+    } else if (auto rsaLoad = dynamic_cast<RuntimeSizedArrayLoad*>(expr)) {
+      elideConsumer(rsaLoad, rsaLoad->arrayExpr, rsaLoad->arrayType, {rsaLoad->indexExpr});
+    } else if (auto rsaStore = dynamic_cast<RuntimeSizedArrayStore*>(expr)) {
+      elideConsumer(
+          rsaStore, rsaStore->arrayExpr, rsaStore->arrayType,
+          {rsaStore->indexExpr, rsaStore->sourceExpr});
+    } else if (auto consecutor = dynamic_cast<Consecutor*>(expr)) {
+      visitConsecutor(consecutor);
+    }
+  }
+
+  // Looks for a local that's just a copy of another local:
+  //   Stackify(LocalLoad(a), b) ... Discard(Unstackify(b))
+  // If a stays put the whole time, b doesn't need its own count.
+  void visitConsecutor(Consecutor* consecutor) {
+    auto& exprs = consecutor->exprs;
+    for (int i = 0; i < exprs.size(); i++) {
+      auto stackify = dynamic_cast<Stackify*>(exprs[i]);
+      if (!stackify) {
+        continue;
+      }
+      auto copyLocalId = stackify->local->id;
+      if (numUnstackifies[copyLocalId] != 1 || storedLocalIds.count(copyLocalId)) {
+        continue;
+      }
+      auto localLoad = dynamic_cast<LocalLoad*>(skipPassthroughs(stackify->sourceExpr));
+      if (!localLoad || result->aliasElided(localLoad)) {
+        continue;
+      }
+      auto originalLocalId = localLoad->local->id;
+      auto loadType = getLocalLoadResultType(globalState, localLoad);
+      if (!isElidableType(globalState, loadType) ||
+          !isElidableType(globalState, stackify->local->type) ||
+          loadType->ownership != stackify->local->type->ownership) {
+        continue;
+      }
+      for (int j = i + 1; j < exprs.size(); j++) {
+        auto discardM = dynamic_cast<Discard*>(exprs[j]);
+        auto unstackify = discardM ? dynamic_cast<Unstackify*>(discardM->sourceExpr) : nullptr;
+        if (unstackify && unstackify->local->id == copyLocalId) {
+          if (isElidableType(globalState, discardM->sourceResultType)) {
+            result->elidedAliases.insert(localLoad);
+            result->elidedDealiases.insert(discardM);
+          }
+          break;
+        }
+        if (disturbsLocal(exprs[j], originalLocalId) || disturbsLocal(exprs[j], copyLocalId)) {
+          break;
+        }
+      }
+    }
+  }
+};
+
+}
+
+RcElisions analyzeRcElisions(GlobalState* globalState, Function* functionM) {
+  RcElisions result;
+  RcElisionAnalyzer(globalState, &result).analyze(functionM);
+  return result;
+}
@@ -0,0 +1,36 @@
+#ifndef FUNCTION_ANALYSIS_RCELISION_H_
+#define FUNCTION_ANALYSIS_RCELISION_H_
+
+#include <unordered_set>
+
+#include "metal/ast.h"
+#include "metal/instructions.h"
+
+class GlobalState;
+
+// The reference count adjustments we can statically prove unnecessary in a
+// function. A borrow (or share) loaded from a local doesn't need its own +1 if
+// the local keeps the object alive until the matching -1, so we skip both.
+// Only NaiveRC borrows and RCImm shares are considered.
+class RcElisions {
+public:
+  // LocalLoads that shouldn't alias their result.
+  std::unordered_set<Expression*> elidedAliases;
+  // Expressions that shouldn't dealias the reference they consume. For most
+  // it's their struct or array; for a Discard it's its source.
+  std::unordered_set<Expression*> elidedDealiases;
+
+  bool aliasElided(Expression* expr) const {
+    return elidedAliases.count(expr) != 0;
+  }
+  bool dealiasElided(Expression* expr) const {
+    return elidedDealiases.count(expr) != 0;
+  }
+  int numElided() const {
+    return elidedAliases.size() + elidedDealiases.size();
+  }
+};
+
+RcElisions analyzeRcElisions(GlobalState* globalState, Function* functionM);
+
+#endif
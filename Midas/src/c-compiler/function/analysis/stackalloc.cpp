@@ -0,0 +1,182 @@
+#include "globalstate.h"
+#include "function/analysis/exprwalk.h"
+#include "function/analysis/stackalloc.h"
+
+namespace {
+
+// If the function does nothing but destroy its only parameter and discard
+// the resulting shared members, returns that Destroy. Valestrom generates
+// these for structs that don't have their own destructor.
+Destroy* getTrivialDestructorDestroy(Function* functionM) {
+  if (functionM->prototype->params.size() != 1) {
+    return nullptr;
+  }
+  Destroy* destroy = nullptr;
+  std::unordered_set<VariableId*> discardedLocalIds;
+  int numArguments = 0;
+  bool trivial = true;
+  forEachExpression(functionM->block, [&](Expression* expr) {
+    if (auto destroyM = dynamic_cast<Destroy*>(expr)) {
+      trivial = trivial && destroy == nullptr &&
+          dynamic_cast<Argument*>(skipPassthroughs(destroyM->structExpr));
+      destroy = destroyM;
+    } else if (auto discardM = dynamic_cast<Discard*>(expr)) {
+      auto unstackify = dynamic_cast<Unstackify*>(discardM->sourceExpr);
+      trivial = trivial && unstackify && discardM->sourceResultType->ownership == Ownership::SHARE;
+      if (unstackify) {
+        discardedLocalIds.insert(unstackify->local->id);
+      }
+    } else if (auto newStruct = dynamic_cast<NewStruct*>(expr)) {
+      // The void we return.
+      trivial = trivial && newStruct->sourceExprs.empty();
+    } else if (dynamic_cast<Argument*>(expr)) {
+      numArguments++;
+    } else if (!dynamic_cast<Block*>(expr) &&
+        !dynamic_cast<Consecutor*>(expr) &&
+        !dynamic_cast<Return*>(expr) &&
+        !dynamic_cast<Unstackify*>(expr) &&
+        !dynamic_cast<NarrowPermission*>(expr)) {
+      trivial = false;
+    }
+  });
+  if (!trivial || !destroy || numArguments != 1 ||
+      destroy->structType->ownership != Ownership::OWN ||
+      discardedLocalIds.size() != destroy->localIndices.size()) {
+    return nullptr;
+  }
+  for (auto local : destroy->localIndices) {
+    if (discardedLocalIds.count(local->id) == 0) {
+      return nullptr;
+    }
+  }
+  return destroy;
+}
+
+class StackAllocAnalyzer {
+public:
+  StackAllocAnalyzer(GlobalState* globalState_, StackAllocations* result_) :
+      globalState(globalState_),
+      result(result_) {}
+
+  void analyze(Function* functionM) {
+    forEachExpression(functionM->block, [this](Expression* expr) {
+      forEachChildExpression(expr, [this, expr](Expression* child) {
+        parentByExpr[child] = expr;
+      });
+      if (auto stackify = dynamic_cast<Stackify*>(expr)) {
+        numStackifiesByLocalId[stackify->local->id]++;
+      } else if (auto localLoad = dynamic_cast<LocalLoad*>(expr)) {
+        loadsByLocalId[localLoad->local->id].push_back(localLoad);
+      } else if (auto unstackify = dynamic_cast<Unstackify*>(expr)) {
+        unstackifiesByLocalId[unstackify->local->id].push_back(unstackify);
+      } else if (auto localStore = dynamic_cast<LocalStore*>(expr)) {
+        storedLocalIds.insert(localStore->local->id);
+      }
+    });
+    forEachExpression(functionM->block, [this](Expression* expr) {
+      if (auto newStruct = dynamic_cast<NewStruct*>(expr)) {
+        visitNewStruct(newStruct);
+      }
+    });
+  }
+
+private:
+  GlobalState* globalState;
+  StackAllocations* result;
+  std::unordered_map<Expression*, Expression*> parentByExpr;
+  std::unordered_map<VariableId*, int> numStackifiesByLocalId;
+  std::unordered_map<VariableId*, std::vector<LocalLoad*>> loadsByLocalId;
+  std::unordered_map<VariableId*, std::vector<Unstackify*>> unstackifiesByLocalId;
+  std::unordered_set<VariableId*> storedLocalIds;
+
+  // The expression that consumes expr's result, looking through passthroughs.
+  Expression* getConsumer(Expression* expr) {
+    auto iter = parentByExpr.find(expr);
+    while (iter != parentByExpr.end() && dynamic_cast<NarrowPermission*>(iter->second)) {
+      iter = parentByExpr.find(iter->second);
+    }
+    return iter == parentByExpr.end() ? nullptr : iter->second;
+  }
+
+  bool isStackableType(Reference* refMT) {
+    if (refMT->ownership != Ownership::OWN ||
+        refMT->location != Location::YONDER ||
+        !dynamic_cast<StructKind*>(refMT->kind)) {
+      return false;
+    }
+    // ResilientV4 can keep a tethered object around after it's destroyed, so
+    // it has to stay on the heap.
+    auto region = globalState->getRegion(refMT);
+    return region == globalState->unsafeRegion ||
+        region == globalState->assistRegion ||
+        region == globalState->naiveRcRegion ||
+        region == globalState->resilientV3Region;
+  }
+
+  // Whether this borrow is only used to get at one of the struct's members,
+  // so it can't outlive the struct.
+  bool isMemberAccessBorrow(LocalLoad* localLoad) {
+    if (localLoad->targetOwnership != Ownership::BORROW) {
+      return false;
+    }
+    auto consumer = getConsumer(localLoad);
+    if (auto memberLoad = dynamic_cast<MemberLoad*>(consumer)) {
+      return skipPassthroughs(memberLoad->structExpr) == localLoad;
+    } else if (auto memberStore = dynamic_cast<MemberStore*>(consumer)) {
+      return skipPassthroughs(memberStore->structExpr) == localLoad;
+    }
+    return false;
+  }
+
+  void visitNewStruct(NewStruct* newStruct) {
+    if (!isStackableType(newStruct->resultType)) {
+      return;
+    }
+    auto consumer = getConsumer(newStruct);
+    if (auto destroy = dynamic_cast<Destroy*>(consumer)) {
+      result->newStructs.insert(newStruct);
+      result->destroys.insert(destroy);
+      return;
+    }
+    auto stackify = dynamic_cast<Stackify*>(consumer);
+    if (!stackify) {
+      return;
+    }
+    auto localId = stackify->local->id;
+    if (numStackifiesByLocalId[localId] != 1 || storedLocalIds.count(localId)) {
+      return;
+    }
+    for (auto localLoad : loadsByLocalId[localId]) {
+      if (!isMemberAccessBorrow(localLoad)) {
+        return;
+      }
+    }
+    auto& unstackifies = unstackifiesByLocalId[localId];
+    if (unstackifies.size() != 1) {
+      return;
+    }
+    auto finalConsumer = getConsumer(unstackifies[0]);
+    if (auto destroy = dynamic_cast<Destroy*>(finalConsumer)) {
+      result->newStructs.insert(newStruct);
+      result->destroys.insert(destroy);
+    } else if (auto call = dynamic_cast<Call*>(finalConsumer)) {
+      auto maybeCallee = globalState->program->getMaybeFunction(call->function->name);
+      if (!maybeCallee.has_value()) {
+        return;
+      }
+      auto calleeDestroy = getTrivialDestructorDestroy(*maybeCallee);
+      if (calleeDestroy && calleeDestroy->structType == newStruct->resultType) {
+        result->newStructs.insert(newStruct);
+        result->inlinedDestructorCalls[call] = calleeDestroy;
+      }
+    }
+  }
+};
+
+}
+
+StackAllocations findStackAllocations(GlobalState* globalState, Function* functionM) {
+  StackAllocations result;
+  StackAllocAnalyzer(globalState, &result).analyze(functionM);
+  return result;
+}
@@ -0,0 +1,42 @@
+#ifndef FUNCTION_ANALYSIS_STACKALLOC_H_
+#define FUNCTION_ANALYSIS_STACKALLOC_H_
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "metal/ast.h"
+#include "metal/instructions.h"
+
+class GlobalState;
+
+// The mutable structs we can put on the stack instead of the heap, because
+// they never leave the function that makes them.
+//
+// A struct qualifies if it goes straight into a local, the only borrows of
+// that local are for reading and writing its members, and the local is
+// eventually destroyed right here, either by a Destroy or by a call to a
+// destructor that does nothing but destroy it and discard shared members.
+class StackAllocations {
+public:
+  // NewStructs that should allocate on the stack.
+  std::unordered_set<Expression*> newStructs;
+  // Destroys of those structs, which shouldn't free them.
+  std::unordered_set<Expression*> destroys;
+  // Calls to trivial destructors of those structs, which we do inline
+  // instead, mapped to the Destroy in the destructor's body.
+  std::unordered_map<Expression*, Destroy*> inlinedDestructorCalls;
+
+  bool allocatesOnStack(Expression* newStruct) const {
+    return newStructs.count(newStruct) != 0;
+  }
+  bool destroysStackObject(Expression* destroy) const {
+    return destroys.count(destroy) != 0;
+  }
+  int size() const {
+    return newStructs.size();
+  }
+};
+
+StackAllocations findStackAllocations(GlobalState* globalState, Function* functionM);
+
+#endif
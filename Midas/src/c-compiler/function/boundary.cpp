@@ -84,7 +84,7 @@ std::pair<LLVMValueRef, LLVMValueRef> sendValeObjectIntoHost(
             ->checkValidReference(FL(), functionState, builder, hostRefMT, hostArgRef);
     auto sizeLE =
         globalState->getRegion(hostRefMT)
-            ->checkValidReference(FL(), functionState, builder, globalState->metalCache->i32Ref, sizeRef);
+            ->checkValidReference(FL(), functionState, builder, globalState->getLengthRefMT(), sizeRef);
     return std::make_pair(hostArgLE, sizeLE);
   } else {
     auto encryptedValeRefLE =
@@ -104,7 +104,7 @@ std::pair<LLVMValueRef, LLVMValueRef> sendValeObjectIntoHost(
       expectedSizeLE = 24;
     }
     assert(LLVMABISizeOfType(globalState->dataLayout, LLVMTypeOf(encryptedValeRefLE)) == expectedSizeLE);
-    auto sizeLE = constI32LE(globalState, expectedSizeLE);
+    auto sizeLE = LLVMConstInt(globalState->getLengthLT(), expectedSizeLE, false);
 
     return std::make_pair(encryptedValeRefLE, sizeLE);
   }
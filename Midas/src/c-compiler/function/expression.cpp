@@ -137,9 +137,11 @@ Ref translateExpressionInner(
 
     auto resultRef = globalState->getRegion(weakAlias->sourceType)->weakAlias(functionState, builder, weakAlias->sourceType, weakAlias->resultType, sourceRef);
     globalState->getRegion(weakAlias->resultType)->aliasWeakRef(FL(), functionState, builder, weakAlias->resultType, resultRef);
-    globalState->getRegion(weakAlias->sourceType)->dealias(
-        AFL("WeakAlias drop constraintref"),
-        functionState, builder, weakAlias->sourceType, sourceRef);
+    if (!functionState->rcElisions.dealiasElided(weakAlias)) {
+      globalState->getRegion(weakAlias->sourceType)->dealias(
+          AFL("WeakAlias drop constraintref"),
+          functionState, builder, weakAlias->sourceType, sourceRef);
+    }
     return resultRef;
   } else if (auto localLoad = dynamic_cast<LocalLoad*>(expr)) {
     buildFlare(FL(), globalState, functionState, builder, typeid(*expr).name(), " ", localLoad->localName);
@@ -169,9 +171,12 @@ Ref translateExpressionInner(
     auto memberExprs =
         translateExpressions(
             globalState, functionState, blockState, builder, newStruct->sourceExprs);
+    // The analysis proved this never leaves the function, see findStackAllocations.
+    functionState->allocatingOnStack = functionState->stackAllocations.allocatesOnStack(newStruct);
     auto resultLE =
         translateConstruct(
             AFL("NewStruct"), globalState, functionState, builder, newStruct->resultType, memberExprs);
+    functionState->allocatingOnStack = false;
     return resultLE;
   } else if (auto consecutor = dynamic_cast<Consecutor*>(expr)) {
     buildFlare(FL(), globalState, functionState, builder, typeid(*expr).name());
@@ -201,7 +206,9 @@ Ref translateExpressionInner(
     auto mutability = ownershipToMutability(memberLoad->structType->ownership);
     auto memberIndex = memberLoad->memberIndex;
     auto memberName = memberLoad->memberName;
-    bool structKnownLive = memberLoad->structKnownLive || globalState->opt->overrideKnownLiveTrue;
+    bool structKnownLive =
+        memberLoad->structKnownLive || globalState->opt->overrideKnownLiveTrue ||
+        functionState->inferredKnownLives.contains(memberLoad);
     auto resultRef =
         loadMember(
             AFL("MemberLoad"),
@@ -218,9 +225,11 @@ Ref translateExpressionInner(
             memberName);
     globalState->getRegion(memberLoad->expectedResultType)
         ->checkValidReference(FL(), functionState, builder, memberLoad->expectedResultType, resultRef);
-    globalState->getRegion(memberLoad->structType)->dealias(
-        AFL("MemberLoad drop struct"),
-        functionState, builder, memberLoad->structType, structRef);
+    if (!functionState->rcElisions.dealiasElided(memberLoad)) {
+      globalState->getRegion(memberLoad->structType)->dealias(
+          AFL("MemberLoad drop struct"),
+          functionState, builder, memberLoad->structType, structRef);
+    }
     return resultRef;
   } else if (auto destroyStaticSizedArrayIntoFunction = dynamic_cast<DestroyStaticSizedArrayIntoFunction*>(expr)) {
     buildFlare(FL(), globalState, functionState, builder, typeid(*expr).name());
@@ -313,16 +322,16 @@ Ref translateExpressionInner(
             ->getRuntimeSizedArrayLength(
                 functionState, builder, arrayType, arrayRef, arrayKnownLive);
     auto arrayLenLE =
-        globalState->getRegion(globalState->metalCache->i32Ref)
+        globalState->getRegion(globalState->getLengthRefMT())
             ->checkValidReference(FL(),
-                functionState, builder, globalState->metalCache->i32Ref, arrayLenRef);
+                functionState, builder, globalState->getLengthRefMT(), arrayLenRef);
 
     auto consumerRef = translateExpression(globalState, functionState, blockState, builder, consumerExpr);
     globalState->getRegion(consumerType)
         ->checkValidReference(FL(), functionState, builder, consumerType, consumerRef);
 
     intRangeLoopReverse(
-        globalState, functionState, builder, globalState->metalCache->i32, arrayLenRef,
+        globalState, functionState, builder, globalState->getLengthMT(), arrayLenRef,
         [globalState, functionState, consumerType, consumerMethod, arrayKind, arrayType, arrayRef, arrayKnownLive, consumerRef](Ref indexRef, LLVMBuilderRef bodyBuilder) {
           globalState->getRegion(consumerType)
               ->alias(
@@ -377,7 +386,9 @@ Ref translateExpressionInner(
     auto resultType =
         globalState->metalCache->getReference(
             targetOwnership, targetLocation, elementType->kind);
-    bool arrayKnownLive = staticSizedArrayLoad->arrayKnownLive || globalState->opt->overrideKnownLiveTrue;
+    bool arrayKnownLive =
+        staticSizedArrayLoad->arrayKnownLive || globalState->opt->overrideKnownLiveTrue ||
+        functionState->inferredKnownLives.contains(staticSizedArrayLoad);
     int arraySize = staticSizedArrayLoad->arraySize;
 
     auto arrayRef = translateExpression(globalState, functionState, blockState, builder, arrayExpr);
@@ -393,8 +404,10 @@ Ref translateExpressionInner(
             constI32LE(globalState, arraySize));
     auto indexLE = translateExpression(globalState, functionState, blockState, builder, indexExpr);
     auto mutability = ownershipToMutability(arrayType->ownership);
-    globalState->getRegion(arrayType)
-        ->dealias(AFL("SSALoad"), functionState, builder, arrayType, arrayRef);
+    if (!functionState->rcElisions.dealiasElided(staticSizedArrayLoad)) {
+      globalState->getRegion(arrayType)
+          ->dealias(AFL("SSALoad"), functionState, builder, arrayType, arrayRef);
+    }
 
     auto loadResult =
         globalState->getRegion(arrayType)
@@ -420,7 +433,9 @@ Ref translateExpressionInner(
     auto targetOwnership = runtimeSizedArrayLoad->targetOwnership;
     auto targetLocation = targetOwnership == Ownership::SHARE ? elementType->location : Location::YONDER;
     auto resultType = globalState->metalCache->getReference(targetOwnership, targetLocation, elementType->kind);
-    bool arrayKnownLive = runtimeSizedArrayLoad->arrayKnownLive || globalState->opt->overrideKnownLiveTrue;
+    bool arrayKnownLive =
+        runtimeSizedArrayLoad->arrayKnownLive || globalState->opt->overrideKnownLiveTrue ||
+        functionState->inferredKnownLives.contains(runtimeSizedArrayLoad);
 
     auto arrayRef = translateExpression(globalState, functionState, blockState, builder, arrayExpr);
 
@@ -428,7 +443,14 @@ Ref translateExpressionInner(
         ->checkValidReference(FL(), functionState, builder, arrayType, arrayRef);
 
 //    auto sizeLE = getRuntimeSizedArrayLength(globalState, functionState, builder, arrayType, arrayRef);
-    auto indexLE = translateExpression(globalState, functionState, blockState, builder, indexExpr);
+    auto intIndexRef = translateExpression(globalState, functionState, blockState, builder, indexExpr);
+    auto indexLE =
+        globalState->intToLength(functionState, builder, runtimeSizedArrayLoad->indexType, intIndexRef);
+    if (functionState->inBoundsAccesses.contains(runtimeSizedArrayLoad)) {
+      functionState->indicesKnownInBounds.insert(
+          globalState->getRegion(globalState->getLengthRefMT())
+              ->checkValidReference(FL(), functionState, builder, globalState->getLengthRefMT(), indexLE));
+    }
     auto mutability = ownershipToMutability(arrayType->ownership);
 
     auto loadResult =
@@ -445,8 +467,10 @@ Ref translateExpressionInner(
     globalState->getRegion(resultType)
         ->checkValidReference(FL(), functionState, builder, resultType, resultRef);
 
-    globalState->getRegion(arrayType)
-        ->dealias(AFL("RSALoad"), functionState, builder, arrayType, arrayRef);
+    if (!functionState->rcElisions.dealiasElided(runtimeSizedArrayLoad)) {
+      globalState->getRegion(arrayType)
+          ->dealias(AFL("RSALoad"), functionState, builder, arrayType, arrayRef);
+    }
 
     return resultRef;
   } else if (auto runtimeSizedArrayStore = dynamic_cast<RuntimeSizedArrayStore*>(expr)) {
@@ -455,7 +479,9 @@ Ref translateExpressionInner(
     auto arrayExpr = runtimeSizedArrayStore->arrayExpr;
     auto indexExpr = runtimeSizedArrayStore->indexExpr;
     auto arrayKind = runtimeSizedArrayStore->arrayKind;
-    bool arrayKnownLive = runtimeSizedArrayStore->arrayKnownLive || globalState->opt->overrideKnownLiveTrue;
+    bool arrayKnownLive =
+        runtimeSizedArrayStore->arrayKnownLive || globalState->opt->overrideKnownLiveTrue ||
+        functionState->inferredKnownLives.contains(runtimeSizedArrayStore);
 
     auto elementType = globalState->program->getRuntimeSizedArray(arrayKind)->rawArray->elementType;
 
@@ -467,12 +493,19 @@ Ref translateExpressionInner(
     auto sizeRef =
         globalState->getRegion(arrayType)
             ->getRuntimeSizedArrayLength(functionState, builder, arrayType, arrayRefLE, arrayKnownLive);
-    globalState->getRegion(globalState->metalCache->i32Ref)
-        ->checkValidReference(FL(), functionState, builder, globalState->metalCache->i32Ref, sizeRef);
+    globalState->getRegion(globalState->getLengthRefMT())
+        ->checkValidReference(FL(), functionState, builder, globalState->getLengthRefMT(), sizeRef);
 
 
-    auto indexRef =
+    auto intIndexRef =
         translateExpression(globalState, functionState, blockState, builder, indexExpr);
+    auto indexRef =
+        globalState->intToLength(functionState, builder, runtimeSizedArrayStore->indexType, intIndexRef);
+    if (functionState->inBoundsAccesses.contains(runtimeSizedArrayStore)) {
+      functionState->indicesKnownInBounds.insert(
+          globalState->getRegion(globalState->getLengthRefMT())
+              ->checkValidReference(FL(), functionState, builder, globalState->getLengthRefMT(), indexRef));
+    }
     auto mutability = ownershipToMutability(arrayType->ownership);
 
 
@@ -503,29 +536,35 @@ Ref translateExpressionInner(
             functionState, builder,
             arrayType, arrayKind, arrayRefLE, arrayKnownLive, indexRef, valueToStoreLE);
 
-    globalState->getRegion(arrayType)
-        ->dealias(AFL("RSAStore"), functionState, builder, arrayType, arrayRefLE);
+    if (!functionState->rcElisions.dealiasElided(runtimeSizedArrayStore)) {
+      globalState->getRegion(arrayType)
+          ->dealias(AFL("RSAStore"), functionState, builder, arrayType, arrayRefLE);
+    }
 
     return oldValueLE;
   } else if (auto arrayLength = dynamic_cast<ArrayLength*>(expr)) {
     buildFlare(FL(), globalState, functionState, builder, typeid(*expr).name());
     auto arrayType = arrayLength->sourceType;
     auto arrayExpr = arrayLength->sourceExpr;
-    bool arrayKnownLive = arrayLength->sourceKnownLive || globalState->opt->overrideKnownLiveTrue;
+    bool arrayKnownLive =
+        arrayLength->sourceKnownLive || globalState->opt->overrideKnownLiveTrue ||
+        functionState->inferredKnownLives.contains(arrayLength);
 //    auto indexExpr = arrayLength->indexExpr;
 
     auto arrayRefLE = translateExpression(globalState, functionState, blockState, builder, arrayExpr);
     globalState->getRegion(arrayType)
         ->checkValidReference(FL(), functionState, builder, arrayType, arrayRefLE);
 
-    auto sizeLE =
+    auto lengthRef =
         globalState->getRegion(arrayType)
             ->getRuntimeSizedArrayLength(
                 functionState, builder, arrayType, arrayRefLE, arrayKnownLive);
-    globalState->getRegion(arrayType)
-        ->dealias(AFL("RSALen"), functionState, builder, arrayType, arrayRefLE);
+    if (!functionState->rcElisions.dealiasElided(arrayLength)) {
+      globalState->getRegion(arrayType)
+          ->dealias(AFL("RSALen"), functionState, builder, arrayType, arrayRefLE);
+    }
 
-    return sizeLE;
+    return globalState->lengthToInt(functionState, builder, arrayLength->resultType, lengthRef);
   } else if (auto narrowPermission = dynamic_cast<NarrowPermission*>(expr)) {
     buildFlare(FL(), globalState, functionState, builder, typeid(*expr).name());
     auto sourceExpr = narrowPermission->sourceExpr;
@@ -564,7 +603,9 @@ Ref translateExpressionInner(
     auto memberName = memberStore->memberName;
     auto structType = memberStore->structType;
     auto memberType = structDefM->members[memberIndex]->type;
-    bool structKnownLive = memberStore->structKnownLive || globalState->opt->overrideKnownLiveTrue;
+    bool structKnownLive =
+        memberStore->structKnownLive || globalState->opt->overrideKnownLiveTrue ||
+        functionState->inferredKnownLives.contains(memberStore);
 
     auto sourceExpr =
         translateExpression(
@@ -583,10 +624,12 @@ Ref translateExpressionInner(
             globalState, functionState, builder, structDefM, structType, structExpr, structKnownLive, memberIndex, memberName, sourceExpr);
     globalState->getRegion(memberType)
         ->checkValidReference(FL(), functionState, builder, memberType, oldMemberLE);
-    globalState->getRegion(structType)
-        ->dealias(
-            AFL("MemberStore discard struct"),
-            functionState, builder, structType, structExpr);
+    if (!functionState->rcElisions.dealiasElided(memberStore)) {
+      globalState->getRegion(structType)
+          ->dealias(
+              AFL("MemberStore discard struct"),
+              functionState, builder, structType, structExpr);
+    }
     return oldMemberLE;
   } else if (auto structToInterfaceUpcast = dynamic_cast<StructToInterfaceUpcast*>(expr)) {
     buildFlare(FL(), globalState, functionState, builder, typeid(*expr).name());
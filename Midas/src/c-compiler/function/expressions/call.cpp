@@ -1,5 +1,6 @@
 #include <iostream>
 #include <function/expressions/shared/shared.h>
+#include <function/expressions/expressions.h>
 
 #include "translatetype.h"
 
@@ -12,6 +13,12 @@ Ref translateCall(
     BlockState* blockState,
     LLVMBuilderRef builder,
     Call* call) {
+  auto inlinedDestructorIter = functionState->stackAllocations.inlinedDestructorCalls.find(call);
+  if (inlinedDestructorIter != functionState->stackAllocations.inlinedDestructorCalls.end()) {
+    return translateStackDestructorCall(
+        globalState, functionState, blockState, builder, call, inlinedDestructorIter->second);
+  }
+
   auto argsLE = std::vector<Ref>{};
   argsLE.reserve(call->argExprs.size());
   for (int i = 0; i < call->argExprs.size(); i++) {
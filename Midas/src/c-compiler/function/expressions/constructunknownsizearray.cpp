@@ -28,6 +28,7 @@ Ref translateConstructRuntimeSizedArray(
   auto runtimeSizedArrayMT = dynamic_cast<RuntimeSizedArrayT*>(constructRuntimeSizedArray->arrayRefType->kind);
 
   auto sizeRef = translateExpression(globalState, functionState, blockState, builder, sizeExpr);
+  auto lengthRef = globalState->intToLength(functionState, builder, sizeType, sizeRef);
 
   auto generatorRef = translateExpression(globalState, functionState, blockState, builder, generatorExpr);
   globalState->getRegion(generatorType)->checkValidReference(FL(), functionState, builder,
@@ -41,7 +42,7 @@ Ref translateConstructRuntimeSizedArray(
           builder,
           arrayRefType,
           runtimeSizedArrayMT,
-          sizeRef,
+          lengthRef,
           runtimeSizedArrayMT->name->name);
   buildFlare(FL(), globalState, functionState, builder);
   globalState->getRegion(arrayRefType)->checkValidReference(FL(), functionState, builder,
@@ -58,7 +59,7 @@ Ref translateConstructRuntimeSizedArray(
       generatorType,
       constructRuntimeSizedArray->generatorMethod,
       generatorRef,
-      sizeRef,
+      lengthRef,
       rsaRef);//getRuntimeSizedArrayContentsPtr(builder, rsaWrapperPtrLE));
   buildFlare(FL(), globalState, functionState, builder);
 
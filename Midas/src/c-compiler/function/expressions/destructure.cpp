@@ -46,7 +46,10 @@ Ref translateDestructure(
 
   if (destructureM->structType->ownership == Ownership::OWN) {
     buildFlare(FL(), globalState, functionState, builder);
+    // If it came from our stack, see findStackAllocations, there's nothing to free.
+    functionState->deallocatingFromStack = functionState->stackAllocations.destroysStackObject(destructureM);
     globalState->getRegion(destructureM->structType)->discardOwningRef(FL(), functionState, blockState, builder, destructureM->structType, structRef);
+    functionState->deallocatingFromStack = false;
   } else if (destructureM->structType->ownership == Ownership::SHARE) {
     buildFlare(FL(), globalState, functionState, builder);
     // We dont decrement anything here, we're only here because we already hit zero.
@@ -62,3 +65,51 @@ Ref translateDestructure(
 
   return makeEmptyTupleRef(globalState);
 }
+
+Ref translateStackDestructorCall(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    BlockState* blockState,
+    LLVMBuilderRef builder,
+    Call* call,
+    Destroy* destructorDestroyM) {
+  buildFlare(FL(), globalState, functionState, builder);
+  auto structType = destructorDestroyM->structType;
+  assert(call->argExprs.size() == 1);
+  auto structRef =
+      translateExpression(
+          globalState, functionState, blockState, builder, call->argExprs[0]);
+  globalState->getRegion(structType)->checkValidReference(FL(),
+      functionState, builder, structType, structRef);
+
+  auto structKind = dynamic_cast<StructKind *>(structType->kind);
+  assert(structKind);
+  auto structM = globalState->program->getStruct(structKind);
+
+  // Same as the destructor: take the members out, destroy the struct, then
+  // discard the members, which are all shared.
+  std::vector<Ref> memberRefs;
+  for (int i = 0; i < structM->members.size(); i++) {
+    auto memberName = structM->members[i]->name;
+    auto memberType = structM->members[i]->type;
+    memberRefs.push_back(
+        globalState->getRegion(structType)->loadMember(
+            functionState, builder, structType, structRef, true, i, memberType, memberType, memberName));
+  }
+
+  functionState->deallocatingFromStack = true;
+  globalState->getRegion(structType)->discardOwningRef(FL(), functionState, blockState, builder, structType, structRef);
+  functionState->deallocatingFromStack = false;
+
+  for (int i = 0; i < structM->members.size(); i++) {
+    auto memberType = structM->members[i]->type;
+    if (memberType != globalState->metalCache->emptyTupleStructRef) {
+      globalState->getRegion(memberType)->dealias(
+          AFL("Stack destructor"), functionState, builder, memberType, memberRefs[i]);
+    }
+  }
+
+  buildFlare(FL(), globalState, functionState, builder);
+
+  return makeEmptyTupleRef(globalState);
+}
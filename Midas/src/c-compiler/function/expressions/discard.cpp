@@ -25,6 +25,10 @@ Ref translateDiscard(
 
   globalState->getRegion(sourceResultType)
       ->checkValidReference(FL(), functionState, builder, sourceResultType, sourceRef);
+  if (functionState->rcElisions.dealiasElided(discardM)) {
+    // The local we loaded this from still holds its own count, see analyzeRcElisions.
+    return makeEmptyTupleRef(globalState);
+  }
   buildFlare(FL(), globalState, functionState, builder, "discarding!");
   globalState->getRegion(sourceResultType)
       ->dealias(
@@ -27,6 +27,16 @@ Ref translateDestructure(
     LLVMBuilderRef builder,
     Destroy* destructureM);
 
+// Does inline what a call to a trivial destructor would, for a struct that's
+// on our stack. See StackAllocations::inlinedDestructorCalls.
+Ref translateStackDestructorCall(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    BlockState* blockState,
+    LLVMBuilderRef builder,
+    Call* call,
+    Destroy* destructorDestroyM);
+
 Ref translateConstruct(
     AreaAndFileAndLine from,
     GlobalState* globalState,
@@ -63,6 +73,10 @@ Ref buildExternCall(
     Prototype* prototype,
     const std::vector<Ref>& args);
 
+// Returns how to lower this extern if it's one of the builtins we turn into instructions, or
+// null if it's a real function.
+const IntrinsicLowering* findIntrinsic(GlobalState* globalState, Prototype* prototype);
+
 Ref translateIf(
     GlobalState* globalState,
     FunctionState* functionState,
@@ -1,14 +1,227 @@
 #include <iostream>
+#include <unordered_set>
 #include <function/boundary.h>
 #include "function/expressions/shared/shared.h"
 #include "function/expressions/shared/string.h"
 #include "region/common/controlblock.h"
 #include "region/common/heap.h"
 #include "region/linear/linear.h"
+#include "region/rcimm/rcimm.h"
+#include "utils/branch.h"
 
 #include "translatetype.h"
+#include "externs.h"
 
 #include "function/expression.h"
+#include "function/expressions/expressions.h"
+
+// Builtins from builtins/strings.c that have a _borrowed variant, which takes each string as a
+// pointer to its chars and doesn't free it.
+static const std::unordered_set<std::string> BORROWING_STRING_BUILTINS = {
+    "__vale_strindexof",
+    "__vale_substring",
+    "__vale_streq",
+    "__vale_strcmp",
+    "__vale_addStr",
+    "__vale_printstr",
+    "__vale_strtoascii",
+    "__vale_strbuilderAppend",
+    "__vale_strtoi64",
+    "__vale_strtofloat",
+};
+
+// If this extern has a _borrowed variant we can hand our strings to in place, returns it,
+// declaring it the first time.
+static LLVMValueRef getBorrowingStringBuiltin(GlobalState* globalState, Prototype* prototype) {
+  if (!globalState->opt->borrowStringBuiltins ||
+      globalState->getRegion(globalState->metalCache->strRef) != globalState->rcImm ||
+      typeNeedsPointerParameter(globalState, prototype->returnType)) {
+    return nullptr;
+  }
+  auto externFuncIter = globalState->externFunctions.find(prototype->name->name);
+  if (externFuncIter == globalState->externFunctions.end()) {
+    return nullptr;
+  }
+  auto externFuncL = externFuncIter->second;
+  std::string abiPrefix = "vale_abi_";
+  std::string abiFuncName = LLVMGetValueName(externFuncL);
+  if (abiFuncName.rfind(abiPrefix, 0) != 0) {
+    return nullptr;
+  }
+  auto userFuncName = abiFuncName.substr(abiPrefix.size());
+  if (BORROWING_STRING_BUILTINS.count(userFuncName) == 0) {
+    return nullptr;
+  }
+
+  auto borrowingFuncName = userFuncName + "_borrowed";
+  if (auto existingFuncL = LLVMGetNamedFunction(globalState->mod, borrowingFuncName.c_str())) {
+    return existingFuncL;
+  }
+  auto externFuncLT = LLVMGlobalGetValueType(externFuncL);
+  std::vector<LLVMTypeRef> paramsLT(LLVMCountParamTypes(externFuncLT));
+  LLVMGetParamTypes(externFuncLT, paramsLT.data());
+  assert(paramsLT.size() == prototype->params.size());
+  for (int i = 0; i < prototype->params.size(); i++) {
+    if (dynamic_cast<Str*>(prototype->params[i]->kind)) {
+      paramsLT[i] = LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0);
+    }
+  }
+  auto borrowingFuncLT =
+      LLVMFunctionType(LLVMGetReturnType(externFuncLT), paramsLT.data(), paramsLT.size(), 0);
+  return LLVMAddFunction(globalState->mod, borrowingFuncName.c_str(), borrowingFuncLT);
+}
+
+// Calls a _borrowed string builtin with pointers into our strings, rather than sending it copies.
+// The call consumes its arguments like any extern would, so we let go of the strings afterward.
+static Ref buildBorrowingStringBuiltinCall(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Prototype* prototype,
+    LLVMValueRef borrowingFuncL,
+    const std::vector<Ref>& args) {
+  std::vector<LLVMValueRef> argsLE;
+  for (int i = 0; i < args.size(); i++) {
+    auto paramMT = prototype->params[i];
+    if (dynamic_cast<Str*>(paramMT->kind)) {
+      argsLE.push_back(
+          globalState->getRegion(paramMT)->getStringBytesPtr(functionState, builder, args[i]));
+    } else {
+      argsLE.push_back(
+          checkValidInternalReference(FL(), globalState, functionState, builder, paramMT, args[i]));
+    }
+  }
+  auto hostReturnLE = LLVMBuildCall(builder, borrowingFuncL, argsLE.data(), argsLE.size(), "");
+  for (int i = 0; i < args.size(); i++) {
+    auto paramMT = prototype->params[i];
+    if (dynamic_cast<Str*>(paramMT->kind)) {
+      globalState->getRegion(paramMT)->dealias(FL(), functionState, builder, paramMT, args[i]);
+    }
+  }
+
+  auto valeReturnRefMT = prototype->returnType;
+  if (valeReturnRefMT == globalState->metalCache->emptyTupleStructRef) {
+    return makeEmptyTupleRef(globalState);
+  }
+  auto hostReturnMT = globalState->linearRegion->linearizeReference(valeReturnRefMT);
+  return receiveHostObjectIntoVale(
+      globalState, functionState, builder, hostReturnMT, valeReturnRefMT, hostReturnLE);
+}
+
+// The _vsnapload extern that a _vsnapexists extern goes with, which has the same name before the
+// suffix. That's where we get the snapshot's type from.
+static Prototype* findSnapshotLoadExtern(GlobalState* globalState, Prototype* existsPrototype) {
+  auto existsName = existsPrototype->name->name;
+  auto loadName = existsName.substr(0, existsName.size() - std::string("_vsnapexists").size()) + "_vsnapload";
+  for (auto[packageCoord, package] : globalState->program->packages) {
+    for (auto[externName, prototype] : package->externNameToFunction) {
+      if (prototype->name->name == loadName) {
+        return prototype;
+      }
+    }
+  }
+  return nullptr;
+}
+
+// Maps the snapshot at this path, or gives null if it can't, see __vale_snapshotMap.
+static LLVMValueRef buildSnapshotMap(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    LLVMValueRef pathCharsPtrLE,
+    Kind* valeRootKind) {
+  std::vector<LLVMValueRef> mapArgsLE = {
+      pathCharsPtrLE, constI64LE(globalState, globalState->linearRegion->getSnapshotTypeHash(valeRootKind))
+  };
+  return LLVMBuildCall(builder, globalState->externs->snapshotMap, mapArgsLE.data(), mapArgsLE.size(), "snapshot");
+}
+
+// Saves or loads a snapshot for a _vsnapsave or _vsnapload extern, or checks whether one can be
+// loaded for a _vsnapexists extern, see snapshot.c. There's no C function behind these, we do it
+// all here.
+static Ref buildSnapshotExternCall(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Prototype* prototype,
+    const std::vector<Ref>& args) {
+  auto isRootKind = [](Reference* refMT) {
+    return refMT->ownership == Ownership::SHARE &&
+        (dynamic_cast<StructKind*>(refMT->kind) ||
+            dynamic_cast<InterfaceKind*>(refMT->kind) ||
+            dynamic_cast<StaticSizedArrayT*>(refMT->kind) ||
+            dynamic_cast<RuntimeSizedArrayT*>(refMT->kind));
+  };
+  bool isSave = isSnapshotSaveExtern(prototype);
+  bool isLoad = isSnapshotLoadExtern(prototype);
+  if (isSave) {
+    if (!(prototype->params.size() == 2 && dynamic_cast<Str*>(prototype->params[0]->kind) &&
+        isRootKind(prototype->params[1]) && dynamic_cast<Bool*>(prototype->returnType->kind))) {
+      std::cerr << "Snapshot extern " << prototype->name->name << " should look like "
+                << "(path str, root T) bool, where T is an immutable struct, interface, or array." << std::endl;
+      exit(1);
+    }
+  } else if (isLoad) {
+    if (!(prototype->params.size() == 1 && dynamic_cast<Str*>(prototype->params[0]->kind) &&
+        isRootKind(prototype->returnType))) {
+      std::cerr << "Snapshot extern " << prototype->name->name << " should look like "
+                << "(path str) T, where T is an immutable struct, interface, or array." << std::endl;
+      exit(1);
+    }
+  } else {
+    if (!(prototype->params.size() == 1 && dynamic_cast<Str*>(prototype->params[0]->kind) &&
+        dynamic_cast<Bool*>(prototype->returnType->kind))) {
+      std::cerr << "Snapshot extern " << prototype->name->name << " should look like "
+                << "(path str) bool." << std::endl;
+      exit(1);
+    }
+    if (!findSnapshotLoadExtern(globalState, prototype)) {
+      std::cerr << "Snapshot extern " << prototype->name->name << " needs a _vsnapload extern with "
+                << "the same name before the suffix, to say what type to check for." << std::endl;
+      exit(1);
+    }
+  }
+
+  auto pathMT = prototype->params[0];
+  auto pathCharsPtrLE = globalState->getRegion(pathMT)->getStringBytesPtr(functionState, builder, args[0]);
+  auto linearRegion = globalState->linearRegion;
+  if (isSave) {
+    auto rootMT = prototype->params[1];
+    auto savedLE = linearRegion->saveSnapshot(functionState, builder, rootMT->kind, args[1], pathCharsPtrLE);
+    globalState->getRegion(rootMT)->dealias(FL(), functionState, builder, rootMT, args[1]);
+    globalState->getRegion(pathMT)->dealias(FL(), functionState, builder, pathMT, args[0]);
+    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, savedLE);
+  } else if (isLoad) {
+    auto valeRootMT = prototype->returnType;
+    auto hostRootMT = linearRegion->linearizeReference(valeRootMT);
+    auto snapshotPtrLE = buildSnapshotMap(globalState, builder, pathCharsPtrLE, valeRootMT->kind);
+    // Programs that want to fall back to something else can ask the _vsnapexists extern first.
+    buildAssert(
+        globalState, functionState, builder, LLVMBuildIsNotNull(builder, snapshotPtrLE, "mapped"),
+        "Couldn't load snapshot!");
+    auto hostRootRef = linearRegion->getSnapshotRoot(functionState, builder, hostRootMT, snapshotPtrLE);
+    auto hostRootLE = linearRegion->checkValidReference(FL(), functionState, builder, hostRootMT, hostRootRef);
+    // Unserializing doesn't free anything on the linear side, so this is fine with read-only memory.
+    auto resultRef =
+        receiveHostObjectIntoVale(globalState, functionState, builder, hostRootMT, valeRootMT, hostRootLE);
+    LLVMBuildCall(builder, globalState->externs->snapshotUnmap, &snapshotPtrLE, 1, "");
+    globalState->getRegion(pathMT)->dealias(FL(), functionState, builder, pathMT, args[0]);
+    return resultRef;
+  } else {
+    auto valeRootKind = findSnapshotLoadExtern(globalState, prototype)->returnType->kind;
+    // Mapping it is the only way to know the load will work; the file could be stale, or another
+    // snapshot of this type could be mapped already.
+    auto snapshotPtrLE = buildSnapshotMap(globalState, builder, pathCharsPtrLE, valeRootKind);
+    auto mappedLE = LLVMBuildIsNotNull(builder, snapshotPtrLE, "mapped");
+    buildIf(
+        globalState, functionState, builder, mappedLE,
+        [globalState, snapshotPtrLE](LLVMBuilderRef thenBuilder) {
+          std::vector<LLVMValueRef> unmapArgsLE = { snapshotPtrLE };
+          LLVMBuildCall(thenBuilder, globalState->externs->snapshotUnmap, unmapArgsLE.data(), unmapArgsLE.size(), "");
+        });
+    globalState->getRegion(pathMT)->dealias(FL(), functionState, builder, pathMT, args[0]);
+    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, mappedLE);
+  }
+}
 
 Ref buildExternCall(
     GlobalState* globalState,
@@ -16,201 +229,13 @@ Ref buildExternCall(
     LLVMBuilderRef builder,
     Prototype* prototype,
     const std::vector<Ref>& args) {
-  if (prototype->name->name == "__vbi_addI32") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildAdd(builder, leftLE, rightLE,"add");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_multiplyI32") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto resultIntLE = LLVMBuildMul(builder, leftLE, rightLE, "mul");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, resultIntLE);
-  } else if (prototype->name->name == "__vbi_subtractI32") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto resultIntLE = LLVMBuildSub(builder, leftLE, rightLE, "diff");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, resultIntLE);
-  } else if (prototype->name->name == "__vbi_lessThanI32") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildICmp(builder, LLVMIntSLT, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_greaterThanI32") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildICmp(builder, LLVMIntSGT, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_greaterThanOrEqI32") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildICmp(builder, LLVMIntSGE, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_lessThanOrEqI32") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildICmp(builder, LLVMIntSLE, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_eqI32") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildICmp(builder, LLVMIntEQ, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_modI32") {
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    assert(args.size() == 2);
-    auto result = LLVMBuildSRem( builder, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_divideI32") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildSDiv(builder, leftLE, rightLE,"add");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_addI64") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildAdd(builder, leftLE, rightLE,"add");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_multiplyI64") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto resultIntLE = LLVMBuildMul(builder, leftLE, rightLE, "mul");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, resultIntLE);
-  } else if (prototype->name->name == "__vbi_subtractI64") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto resultIntLE = LLVMBuildSub(builder, leftLE, rightLE, "diff");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, resultIntLE);
-  } else if (prototype->name->name == "__vbi_lessThanI64") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildICmp(builder, LLVMIntSLT, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_greaterThanI64") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildICmp(builder, LLVMIntSGT, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_greaterThanOrEqI64") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildICmp(builder, LLVMIntSGE, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_lessThanOrEqI64") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildICmp(builder, LLVMIntSLE, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_eqI64") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildICmp(builder, LLVMIntEQ, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_modI64") {
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    assert(args.size() == 2);
-    auto result = LLVMBuildSRem( builder, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_divideI64") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildSDiv(builder, leftLE, rightLE,"add");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_divideFloatFloat") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildFDiv(builder, leftLE, rightLE,"divided");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_multiplyFloatFloat") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildFMul(builder, leftLE, rightLE,"multiplied");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_subtractFloatFloat") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildFSub(builder, leftLE, rightLE,"subtracted");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_negateFloat") {
-    assert(args.size() == 1);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto result = LLVMBuildFNeg(builder, leftLE, "negated");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_strLength") {
-    assert(args.size() == 1);
-    auto resultLenLE = globalState->getRegion(globalState->metalCache->strRef)->getStringLen(functionState, builder, args[0]);
-    globalState->getRegion(globalState->metalCache->strRef)
-        ->dealias(FL(), functionState, builder, globalState->metalCache->strRef, args[0]);
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, resultLenLE);
-  } else if (prototype->name->name == "__vbi_addFloatFloat") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildFAdd(builder, leftLE, rightLE, "add");
-    return wrap(globalState->getRegion(globalState->metalCache->floatRef), globalState->metalCache->floatRef, result);
-  } else if (prototype->name->name == "__vbi_panic") {
-    // See MPESC for status codes
-    auto exitCodeLE = makeConstIntExpr(functionState, builder, LLVMInt64TypeInContext(globalState->context), 1);
-    LLVMBuildCall(builder, globalState->externs->exit, &exitCodeLE, 1, "");
-    LLVMBuildRet(builder, LLVMGetUndef(functionState->returnTypeL));
-    return wrap(globalState->getRegion(globalState->metalCache->neverRef), globalState->metalCache->neverRef, globalState->neverPtr);
-  } else if (prototype->name->name == "__vbi_getch") {
-    auto resultIntLE = LLVMBuildCall(builder, globalState->externs->getch, nullptr, 0, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, resultIntLE);
-  } else if (prototype->name->name == "__vbi_eqFloatFloat") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildFCmp(builder, LLVMRealOEQ, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_eqBoolBool") {
-    assert(args.size() == 2);
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    auto result = LLVMBuildICmp(builder, LLVMIntEQ, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_not") {
-    assert(args.size() == 1);
-    auto result = LLVMBuildNot(
-        builder,
-        checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]),
-        "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_and") {
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    assert(args.size() == 2);
-    auto result = LLVMBuildAnd( builder, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
-  } else if (prototype->name->name == "__vbi_or") {
-    auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
-    auto rightLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
-    assert(args.size() == 2);
-    auto result = LLVMBuildOr( builder, leftLE, rightLE, "");
-    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
+  if (auto intrinsic = findIntrinsic(globalState, prototype)) {
+    return (*intrinsic)(globalState, functionState, builder, prototype, args);
+  } else if (isSnapshotExtern(prototype)) {
+    return buildSnapshotExternCall(globalState, functionState, builder, prototype, args);
+  } else if (auto borrowingFuncL = getBorrowingStringBuiltin(globalState, prototype)) {
+    return buildBorrowingStringBuiltinCall(
+        globalState, functionState, builder, prototype, borrowingFuncL, args);
   } else {
     auto valeArgRefs = std::vector<Ref>{};
     valeArgRefs.reserve(args.size());
@@ -224,6 +249,17 @@ Ref buildExternCall(
     auto sizeArgsLE = std::vector<LLVMValueRef>{};
     sizeArgsLE.reserve(args.size() + 1);
 
+    auto externFuncIter = globalState->externFunctions.find(prototype->name->name);
+    assert(externFuncIter != globalState->externFunctions.end());
+    auto externFuncL = externFuncIter->second;
+    bool isBuiltin = std::string(LLVMGetValueName(externFuncL)).rfind("vale_abi___vale_", 0) == 0;
+
+    // Args we lent to the extern instead of copying, which we dealias once it returns.
+    std::vector<int> lentArgIndices;
+    // Args whose copies we got from (or gave to) the serialize cache, with the source object's
+    // address and the copy, to hand back once the extern returns.
+    std::vector<std::tuple<int, LLVMValueRef, LLVMValueRef>> memoizedArgs;
+
     for (int i = 0; i < args.size(); i++) {
       auto valeArgRefMT = prototype->params[i];
       auto hostArgRefMT =
@@ -232,9 +268,65 @@ Ref buildExternCall(
               valeArgRefMT);
 
       auto valeArg = valeArgRefs[i];
-      auto [hostArgRefLE, argSizeLE] =
-          sendValeObjectIntoHost(
-              globalState, functionState, builder, valeArgRefMT, hostArgRefMT, valeArg);
+      LLVMValueRef hostArgRefLE = nullptr;
+      LLVMValueRef argSizeLE = nullptr;
+      // Builtins free their arguments, and SASP externs want a buffer they can keep, so they
+      // still get copies.
+      if (globalState->opt->zeroCopyExterns &&
+          !isBuiltin &&
+          valeArgRefMT->ownership == Ownership::SHARE &&
+          globalState->getRegion(valeArgRefMT) == globalState->rcImm &&
+          !includeSizeParam(globalState, prototype, i) &&
+          globalState->rcImm->canLendToExtern(valeArgRefMT->kind)) {
+        hostArgRefLE = globalState->rcImm->lendToExtern(functionState, builder, valeArgRefMT, valeArg);
+        lentArgIndices.push_back(i);
+      } else if (!isBuiltin &&
+          valeArgRefMT->ownership == Ownership::SHARE &&
+          globalState->getRegion(valeArgRefMT) == globalState->rcImm &&
+          globalState->rcImm->memoizesExternSerialize(valeArgRefMT->kind)) {
+        auto int8PtrLT = LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0);
+        auto hostArgRefLT = globalState->linearRegion->translateType(hostArgRefMT);
+        auto sourceLE =
+            globalState->getRegion(valeArgRefMT)
+                ->checkValidReference(FL(), functionState, builder, valeArgRefMT, valeArg);
+        auto sourceI8PtrLE = LLVMBuildPointerCast(builder, sourceLE, int8PtrLT, "sourceI8Ptr");
+        auto cachedI8PtrLE =
+            LLVMBuildCall(builder, globalState->externs->serializeCacheLend, &sourceI8PtrLE, 1, "cached");
+        auto imageLocalPtrLE =
+            makeMidasLocal(
+                functionState, builder, int8PtrLT, "imagePtrLocal", cachedI8PtrLE);
+        auto missedLE = LLVMBuildIsNull(builder, cachedI8PtrLE, "missed");
+        buildIf(
+            globalState, functionState, builder, missedLE,
+            [globalState, functionState, valeArgRefMT, hostArgRefMT, valeArg, sourceI8PtrLE, int8PtrLT, imageLocalPtrLE](
+                LLVMBuilderRef thenBuilder) {
+              auto[hostRef, sizeRef] =
+                  globalState->linearRegion->receiveUnencryptedAlienReference(
+                      functionState, thenBuilder, valeArgRefMT, hostArgRefMT, valeArg);
+              auto hostLE =
+                  globalState->linearRegion->checkValidReference(
+                      FL(), functionState, thenBuilder, hostArgRefMT, hostRef);
+              auto sizeLE =
+                  globalState->linearRegion->checkValidReference(
+                      FL(), functionState, thenBuilder, globalState->getLengthRefMT(), sizeRef);
+              auto imageI8PtrLE = LLVMBuildPointerCast(thenBuilder, hostLE, int8PtrLT, "imageI8Ptr");
+              std::vector<LLVMValueRef> addArgsLE = {
+                  sourceI8PtrLE,
+                  imageI8PtrLE,
+                  globalState->widenLengthToI64(thenBuilder, sizeLE)
+              };
+              LLVMBuildCall(
+                  thenBuilder, globalState->externs->serializeCacheAdd, addArgsLE.data(), addArgsLE.size(), "");
+              LLVMBuildStore(thenBuilder, imageI8PtrLE, imageLocalPtrLE);
+            });
+        auto imageI8PtrLE = LLVMBuildLoad(builder, imageLocalPtrLE, "imageI8Ptr");
+        hostArgRefLE = LLVMBuildPointerCast(builder, imageI8PtrLE, hostArgRefLT, "image");
+        memoizedArgs.emplace_back(i, sourceI8PtrLE, imageI8PtrLE);
+      } else {
+        std::tie(hostArgRefLE, argSizeLE) =
+            sendValeObjectIntoHost(
+                globalState, functionState, builder, valeArgRefMT, hostArgRefMT, valeArg);
+      }
       if (typeNeedsPointerParameter(globalState, valeArgRefMT)) {
         auto hostArgRefLT = globalState->getRegion(valeArgRefMT)->getExternalType(valeArgRefMT);
         assert(LLVMGetTypeKind(hostArgRefLT) != LLVMPointerTypeKind);
@@ -250,9 +342,11 @@ Ref buildExternCall(
     hostArgsLE.insert(hostArgsLE.end(), sizeArgsLE.begin(), sizeArgsLE.end());
     sizeArgsLE.clear();
 
-    auto externFuncIter = globalState->externFunctions.find(prototype->name->name);
-    assert(externFuncIter != globalState->externFunctions.end());
-    auto externFuncL = externFuncIter->second;
+    // Our builtins print through the same output buffer, but anything else might print on its
+    // own, so it should see everything we've printed so far come out first.
+    if (!isBuiltin) {
+      LLVMBuildCall(builder, globalState->externs->flush, nullptr, 0, "");
+    }
 
     buildFlare(FL(), globalState, functionState, builder, "Suspending function ", functionState->containingFuncName);
     buildFlare(FL(), globalState, functionState, builder, "Calling extern function ", prototype->name->name);
@@ -271,6 +365,19 @@ Ref buildExternCall(
     }
 
     buildFlare(FL(), globalState, functionState, builder, "Done calling function ", prototype->name->name);
+
+    for (int i : lentArgIndices) {
+      globalState->getRegion(prototype->params[i])
+          ->dealias(FL(), functionState, builder, prototype->params[i], valeArgRefs[i]);
+    }
+    // We held on to these until now so their copies couldn't be forgotten mid-call.
+    for (auto[i, sourceI8PtrLE, imageI8PtrLE] : memoizedArgs) {
+      std::vector<LLVMValueRef> returnArgsLE = { sourceI8PtrLE, imageI8PtrLE };
+      LLVMBuildCall(
+          builder, globalState->externs->serializeCacheReturn, returnArgsLE.data(), returnArgsLE.size(), "");
+      globalState->getRegion(prototype->params[i])
+          ->dealias(FL(), functionState, builder, prototype->params[i], valeArgRefs[i]);
+    }
     buildFlare(FL(), globalState, functionState, builder, "Resuming function ", functionState->containingFuncName);
 
     if (prototype->returnType->kind == globalState->metalCache->never) {
@@ -1,11 +1,105 @@
 #include <iostream>
 #include "function/expressions/shared/shared.h"
 #include "region/common/controlblock.h"
+#include "region/linear/linear.h"
+#include "utils/branch.h"
 
 #include "translatetype.h"
 
 #include "function/expression.h"
 
+// Beyond this many implementing structs, comparing itables costs more than the indirect call.
+constexpr int MAX_DEVIRTUALIZED_TARGETS = 4;
+
+// The function that this edge's itable has at indexInEdge, cast to the type that the itable
+// holds it as, so it takes the same arguments as an indirect call would.
+static LLVMValueRef getEdgeMethodFunctionPtr(
+    GlobalState* globalState,
+    Edge* edge,
+    int indexInEdge) {
+  auto structPrototype = edge->structPrototypesByInterfaceMethod[indexInEdge].second;
+  auto functionL = globalState->lookupFunction(structPrototype);
+  auto interfaceFunctionsLT = globalState->getInterfaceFunctionTypes(edge->interfaceName);
+  return LLVMConstBitCast(functionL, interfaceFunctionsLT[indexInEdge]);
+}
+
+static Ref buildIndirectInterfaceCall(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    InterfaceCall* call,
+    const std::vector<Ref>& argsLE) {
+  auto virtualArgRefMT = call->functionType->params[call->virtualParamIndex];
+  auto virtualArgRef = argsLE[call->virtualParamIndex];
+  auto methodFunctionPtrLE =
+      globalState->getRegion(virtualArgRefMT)
+          ->getInterfaceMethodFunctionPtr(
+              functionState, builder, virtualArgRefMT, virtualArgRef, call->indexInEdge);
+  return buildInterfaceCall(
+      globalState, functionState, builder, call->functionType, methodFunctionPtrLE, argsLE,
+      call->virtualParamIndex);
+}
+
+static Ref buildDirectInterfaceCall(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    InterfaceCall* call,
+    Edge* edge,
+    const std::vector<Ref>& argsLE) {
+  auto methodFunctionPtrLE = getEdgeMethodFunctionPtr(globalState, edge, call->indexInEdge);
+  return buildInterfaceCall(
+      globalState, functionState, builder, call->functionType, methodFunctionPtrLE, argsLE,
+      call->virtualParamIndex);
+}
+
+// Calls each candidate edge's method directly if the itable matches it, trying them in order,
+// and falls back to the indirect call if none do.
+static Ref buildItableSwitch(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    InterfaceCall* call,
+    const std::vector<Edge*>& edges,
+    int edgeIndex,
+    const std::vector<Ref>& argsLE) {
+  if (edgeIndex == edges.size()) {
+    return buildIndirectInterfaceCall(globalState, functionState, builder, call, argsLE);
+  }
+  auto edge = edges[edgeIndex];
+
+  auto virtualArgRefMT = call->functionType->params[call->virtualParamIndex];
+  auto virtualArgRef = argsLE[call->virtualParamIndex];
+  LLVMValueRef itablePtrLE = nullptr;
+  LLVMValueRef newVirtualArgLE = nullptr;
+  std::tie(itablePtrLE, newVirtualArgLE) =
+      globalState->getRegion(virtualArgRefMT)
+          ->explodeInterfaceRef(functionState, builder, virtualArgRefMT, virtualArgRef);
+  auto edgePtrLE = globalState->getInterfaceTablePtr(edge);
+  auto itablePtrDiffLE = LLVMBuildPtrDiff(builder, itablePtrLE, edgePtrLE, "ptrDiff");
+  auto itablePtrsMatchLE =
+      LLVMBuildICmp(builder, LLVMIntEQ, itablePtrDiffLE, constI64LE(globalState, 0), "ptrsMatch");
+  auto itablePtrsMatchRef =
+      wrap(globalState->getRegion(globalState->metalCache->boolRef),
+          globalState->metalCache->boolRef,
+          itablePtrsMatchLE);
+
+  auto returnMT = call->functionType->returnType;
+  return buildIfElse(
+      globalState, functionState, builder, itablePtrsMatchRef,
+      globalState->getRegion(returnMT)->translateType(returnMT),
+      returnMT,
+      returnMT,
+      [globalState, functionState, call, edge, &argsLE](LLVMBuilderRef thenBuilder) {
+        return buildDirectInterfaceCall(
+            globalState, functionState, thenBuilder, call, edge, argsLE);
+      },
+      [globalState, functionState, call, &edges, edgeIndex, &argsLE](LLVMBuilderRef elseBuilder) {
+        return buildItableSwitch(
+            globalState, functionState, elseBuilder, call, edges, edgeIndex + 1, argsLE);
+      });
+}
+
 Ref translateInterfaceCall(
     GlobalState* globalState,
     FunctionState* functionState,
@@ -19,33 +113,45 @@ Ref translateInterfaceCall(
   auto indexInEdge = call->indexInEdge;
   auto functionType = call->functionType;
 
-  auto argExprsLE =
+  auto argsLE =
       translateExpressions(globalState, functionState, blockState, builder, call->argExprs);
-
-  auto argsLE = std::vector<Ref>{};
-  argsLE.reserve(call->argExprs.size());
   for (int i = 0; i < call->argExprs.size(); i++) {
-    auto argLE = translateExpression(globalState, functionState, blockState, builder, call->argExprs[i]);
     globalState->getRegion(call->functionType->params[i])
-        ->checkValidReference(FL(), functionState, builder, call->functionType->params[i], argLE);
-    argsLE.push_back(argLE);
+        ->checkValidReference(FL(), functionState, builder, call->functionType->params[i], argsLE[i]);
   }
 
-
   auto virtualArgRefMT = functionType->params[virtualParamIndex];
-  auto virtualArgRef = argsLE[virtualParamIndex];
-  auto methodFunctionPtrLE =
-      globalState->getRegion(virtualArgRefMT)
-          ->getInterfaceMethodFunctionPtr(functionState, builder, virtualArgRefMT, virtualArgRef, indexInEdge);
+
+  // Since we see every edge in the program, we know every struct this call could land in. The
+  // linear region numbers its substructs instead of using itables, so it doesn't get this.
+  std::vector<Edge*> edges;
+  bool devirtualize = false;
+  if (globalState->opt->devirtualizeInterfaceCalls &&
+      globalState->getRegion(virtualArgRefMT) != globalState->linearRegion) {
+    globalState->numInterfaceCalls++;
+    auto edgesI = globalState->edgesByInterface.find(interfaceRef);
+    if (edgesI != globalState->edgesByInterface.end()) {
+      edges = edgesI->second;
+    }
+    bool isMetalMethod =
+        !edges.empty() && indexInEdge < edges[0]->structPrototypesByInterfaceMethod.size();
+    bool returnsNever = functionType->returnType->kind == globalState->metalCache->never;
+    // With one implementation there's nothing to compare, so a never-returning call can stay
+    // straight-line. With several, it would need a branch that can't rejoin.
+    devirtualize =
+        isMetalMethod &&
+        (edges.size() == 1 || (edges.size() <= MAX_DEVIRTUALIZED_TARGETS && !returnsNever));
+  }
+
+  if (devirtualize) {
+    globalState->numDevirtualizedInterfaceCalls++;
+  }
   auto resultLE =
-      buildInterfaceCall(
-          globalState,
-          functionState,
-          builder,
-          call->functionType,
-          methodFunctionPtrLE,
-          argExprsLE,
-          call->virtualParamIndex);
+      !devirtualize ?
+      buildIndirectInterfaceCall(globalState, functionState, builder, call, argsLE) :
+      edges.size() == 1 ?
+      buildDirectInterfaceCall(globalState, functionState, builder, call, edges[0], argsLE) :
+      buildItableSwitch(globalState, functionState, builder, call, edges, 0, argsLE);
   globalState->getRegion(call->functionType->returnType)
       ->checkValidReference(FL(), functionState, builder, call->functionType->returnType, resultLE);
 
@@ -0,0 +1,340 @@
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+#include "function/expressions/shared/shared.h"
+
+#include "externs.h"
+
+#include "function/expression.h"
+#include "function/expressions/expressions.h"
+
+// Builtin externs (the __vbi_ ones) that we lower straight to instructions instead of calling
+// anything. See findIntrinsic.
+
+namespace {
+
+using UnaryInstructionBuilder = LLVMValueRef(*)(LLVMBuilderRef, LLVMValueRef, const char*);
+using BinaryInstructionBuilder = LLVMValueRef(*)(LLVMBuilderRef, LLVMValueRef, LLVMValueRef, const char*);
+
+// Declares an LLVM intrinsic like llvm.ctpop, specialized for these types.
+LLVMValueRef getLlvmIntrinsic(
+    GlobalState* globalState,
+    const std::string& name,
+    std::vector<LLVMTypeRef> overloadTypesLT) {
+  auto intrinsicId = LLVMLookupIntrinsicID(name.c_str(), name.size());
+  if (intrinsicId == 0) {
+    // Only use intrinsics that LLVM 11 has, that's the oldest we support.
+    std::cerr << "This LLVM doesn't have intrinsic " << name << "!" << std::endl;
+    exit(1);
+  }
+  return LLVMGetIntrinsicDeclaration(
+      globalState->mod, intrinsicId, overloadTypesLT.data(), overloadTypesLT.size());
+}
+
+std::vector<LLVMValueRef> getArgsLE(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Prototype* prototype,
+    const std::vector<Ref>& args) {
+  assert(args.size() == prototype->params.size());
+  std::vector<LLVMValueRef> argsLE;
+  for (int i = 0; i < args.size(); i++) {
+    argsLE.push_back(
+        checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[i], args[i]));
+  }
+  return argsLE;
+}
+
+// An intrinsic that just computes its result from its arguments.
+IntrinsicLowering pureIntrinsic(
+    std::function<LLVMValueRef(GlobalState*, FunctionState*, LLVMBuilderRef, const std::vector<LLVMValueRef>&)> buildResult) {
+  return [buildResult](
+      GlobalState* globalState,
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      Prototype* prototype,
+      const std::vector<Ref>& args) {
+    auto argsLE = getArgsLE(globalState, functionState, builder, prototype, args);
+    auto resultLE = buildResult(globalState, functionState, builder, argsLE);
+    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, resultLE);
+  };
+}
+
+IntrinsicLowering unaryInstruction(UnaryInstructionBuilder buildInstruction, const std::string& name) {
+  return pureIntrinsic(
+      [buildInstruction, name](GlobalState*, FunctionState*, LLVMBuilderRef builder, const std::vector<LLVMValueRef>& argsLE) {
+        assert(argsLE.size() == 1);
+        return buildInstruction(builder, argsLE[0], name.c_str());
+      });
+}
+
+IntrinsicLowering binaryInstruction(BinaryInstructionBuilder buildInstruction, const std::string& name) {
+  return pureIntrinsic(
+      [buildInstruction, name](GlobalState*, FunctionState*, LLVMBuilderRef builder, const std::vector<LLVMValueRef>& argsLE) {
+        assert(argsLE.size() == 2);
+        return buildInstruction(builder, argsLE[0], argsLE[1], name.c_str());
+      });
+}
+
+IntrinsicLowering intCompare(LLVMIntPredicate predicate) {
+  return pureIntrinsic(
+      [predicate](GlobalState*, FunctionState*, LLVMBuilderRef builder, const std::vector<LLVMValueRef>& argsLE) {
+        assert(argsLE.size() == 2);
+        return LLVMBuildICmp(builder, predicate, argsLE[0], argsLE[1], "");
+      });
+}
+
+IntrinsicLowering floatCompare(LLVMRealPredicate predicate) {
+  return pureIntrinsic(
+      [predicate](GlobalState*, FunctionState*, LLVMBuilderRef builder, const std::vector<LLVMValueRef>& argsLE) {
+        assert(argsLE.size() == 2);
+        return LLVMBuildFCmp(builder, predicate, argsLE[0], argsLE[1], "");
+      });
+}
+
+// Picks whichever argument the comparison favors, for min and max. We don't use llvm.smin and
+// llvm.smax since LLVM 11 doesn't have them, and this compiles to the same thing.
+IntrinsicLowering intSelect(LLVMIntPredicate predicate, const std::string& name) {
+  return pureIntrinsic(
+      [predicate, name](GlobalState*, FunctionState*, LLVMBuilderRef builder, const std::vector<LLVMValueRef>& argsLE) {
+        assert(argsLE.size() == 2);
+        auto firstWinsLE = LLVMBuildICmp(builder, predicate, argsLE[0], argsLE[1], "firstWins");
+        return LLVMBuildSelect(builder, firstWinsLE, argsLE[0], argsLE[1], name.c_str());
+      });
+}
+
+// Calls an LLVM intrinsic that's overloaded on its argument's type, like llvm.ctpop.
+IntrinsicLowering llvmIntrinsic(const std::string& intrinsicName) {
+  return pureIntrinsic(
+      [intrinsicName](GlobalState* globalState, FunctionState*, LLVMBuilderRef builder, const std::vector<LLVMValueRef>& argsLE) {
+        auto funcL = getLlvmIntrinsic(globalState, intrinsicName, {LLVMTypeOf(argsLE[0])});
+        auto callArgsLE = argsLE;
+        return LLVMBuildCall(builder, funcL, callArgsLE.data(), callArgsLE.size(), "");
+      });
+}
+
+// For llvm.ctlz and llvm.cttz, which give the bit width for zero, instead of poison, if we
+// tell them to.
+IntrinsicLowering countZeros(const std::string& intrinsicName) {
+  return pureIntrinsic(
+      [intrinsicName](GlobalState* globalState, FunctionState*, LLVMBuilderRef builder, const std::vector<LLVMValueRef>& argsLE) {
+        assert(argsLE.size() == 1);
+        auto funcL = getLlvmIntrinsic(globalState, intrinsicName, {LLVMTypeOf(argsLE[0])});
+        std::vector<LLVMValueRef> callArgsLE = { argsLE[0], constI1LE(globalState, false) };
+        return LLVMBuildCall(builder, funcL, callArgsLE.data(), callArgsLE.size(), "zeros");
+      });
+}
+
+// Shifts by the amount modulo the bit width, like Java and C# do, since LLVM gives poison for
+// anything bigger.
+IntrinsicLowering shift(BinaryInstructionBuilder buildShift) {
+  return pureIntrinsic(
+      [buildShift](GlobalState*, FunctionState*, LLVMBuilderRef builder, const std::vector<LLVMValueRef>& argsLE) {
+        assert(argsLE.size() == 2);
+        auto intLT = LLVMTypeOf(argsLE[0]);
+        auto maskLE = LLVMConstInt(intLT, LLVMGetIntTypeWidth(intLT) - 1, false);
+        auto amountLE = LLVMBuildAnd(builder, argsLE[1], maskLE, "amount");
+        return buildShift(builder, argsLE[0], amountLE, "shifted");
+      });
+}
+
+// Calls one of the llvm.*.with.overflow intrinsics, and panics if it overflowed.
+IntrinsicLowering checkedArithmetic(const std::string& intrinsicName) {
+  return pureIntrinsic(
+      [intrinsicName](GlobalState* globalState, FunctionState* functionState, LLVMBuilderRef builder, const std::vector<LLVMValueRef>& argsLE) {
+        assert(argsLE.size() == 2);
+        auto funcL = getLlvmIntrinsic(globalState, intrinsicName, {LLVMTypeOf(argsLE[0])});
+        auto callArgsLE = argsLE;
+        auto resultAndOverflowLE =
+            LLVMBuildCall(builder, funcL, callArgsLE.data(), callArgsLE.size(), "resultAndOverflow");
+        auto overflowedLE = LLVMBuildExtractValue(builder, resultAndOverflowLE, 1, "overflowed");
+        buildAssert(
+            globalState, functionState, builder, LLVMBuildNot(builder, overflowedLE, ""),
+            "Integer overflow!");
+        return LLVMBuildExtractValue(builder, resultAndOverflowLE, 0, "result");
+      });
+}
+
+// Converts a float to an integer, rounding toward zero, and clamping anything out of range to
+// the nearest integer we can represent. NaN becomes zero.
+// This is what llvm.fptosi.sat does, but LLVM 11 doesn't have it.
+IntrinsicLowering saturatingFloatToInt(LLVMTypeRef (*getIntType)(LLVMContextRef)) {
+  return pureIntrinsic(
+      [getIntType](GlobalState* globalState, FunctionState*, LLVMBuilderRef builder, const std::vector<LLVMValueRef>& argsLE) {
+        assert(argsLE.size() == 1);
+        auto floatLE = argsLE[0];
+        auto floatLT = LLVMTypeOf(floatLE);
+        auto intLT = getIntType(globalState->context);
+        int bits = LLVMGetIntTypeWidth(intLT);
+        // -2^(bits-1) is the smallest int, and 2^(bits-1) is one past the biggest. Both are exact
+        // as doubles, unlike the biggest int.
+        auto minFloatLE = LLVMConstReal(floatLT, -std::ldexp(1.0, bits - 1));
+        auto pastMaxFloatLE = LLVMConstReal(floatLT, std::ldexp(1.0, bits - 1));
+        auto minIntLE = LLVMConstInt(intLT, 1ULL << (bits - 1), false);
+        auto maxIntLE = LLVMConstInt(intLT, (1ULL << (bits - 1)) - 1, false);
+        // Out of range, fptosi gives poison, but we only select it when it's in range.
+        auto convertedLE = LLVMBuildFPToSI(builder, floatLE, intLT, "converted");
+        auto tooLowLE = LLVMBuildFCmp(builder, LLVMRealOLT, floatLE, minFloatLE, "tooLow");
+        auto tooHighLE = LLVMBuildFCmp(builder, LLVMRealOGE, floatLE, pastMaxFloatLE, "tooHigh");
+        auto isNanLE = LLVMBuildFCmp(builder, LLVMRealUNO, floatLE, floatLE, "isNan");
+        auto resultLE = LLVMBuildSelect(builder, tooLowLE, minIntLE, convertedLE, "clampedLow");
+        resultLE = LLVMBuildSelect(builder, tooHighLE, maxIntLE, resultLE, "clamped");
+        return LLVMBuildSelect(builder, isNanLE, LLVMConstInt(intLT, 0, false), resultLE, "saturated");
+      });
+}
+
+Ref buildStrLength(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Prototype* prototype,
+    const std::vector<Ref>& args) {
+  assert(args.size() == 1);
+  auto strMT = globalState->metalCache->strRef;
+  auto lengthLE = globalState->getRegion(strMT)->getStringLen(functionState, builder, args[0]);
+  globalState->getRegion(strMT)->dealias(FL(), functionState, builder, strMT, args[0]);
+  auto lengthRef = wrap(globalState->getRegion(globalState->getLengthRefMT()), globalState->getLengthRefMT(), lengthLE);
+  return globalState->lengthToInt(functionState, builder, prototype->returnType, lengthRef);
+}
+
+Ref buildPanic(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Prototype* prototype,
+    const std::vector<Ref>& args) {
+  LLVMBuildCall(builder, globalState->externs->flush, nullptr, 0, "");
+  // See MPESC for status codes
+  auto exitCodeLE = makeConstIntExpr(functionState, builder, LLVMInt64TypeInContext(globalState->context), 1);
+  LLVMBuildCall(builder, globalState->externs->exit, &exitCodeLE, 1, "");
+  LLVMBuildRet(builder, LLVMGetUndef(functionState->returnTypeL));
+  return wrap(globalState->getRegion(globalState->metalCache->neverRef), globalState->metalCache->neverRef, globalState->neverPtr);
+}
+
+Ref buildGetch(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Prototype* prototype,
+    const std::vector<Ref>& args) {
+  auto resultIntLE = LLVMBuildCall(builder, globalState->externs->getch, nullptr, 0, "");
+  return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, resultIntLE);
+}
+
+// Every intrinsic, by the name of the builtin extern it lowers.
+//
+// Valestrom and Midas don't agree on which package the builtins are in, so we can't intern these
+// names up front. Instead, findIntrinsic looks each extern's name up here once, and remembers
+// what it found by its Name* in GlobalState::intrinsicsByName.
+const std::unordered_map<std::string, IntrinsicLowering>& getIntrinsicsByExternName() {
+  static const std::unordered_map<std::string, IntrinsicLowering> intrinsicsByExternName = {
+      {"__vbi_addI32", binaryInstruction(LLVMBuildAdd, "add")},
+      {"__vbi_subtractI32", binaryInstruction(LLVMBuildSub, "diff")},
+      {"__vbi_multiplyI32", binaryInstruction(LLVMBuildMul, "mul")},
+      {"__vbi_divideI32", binaryInstruction(LLVMBuildSDiv, "divided")},
+      {"__vbi_modI32", binaryInstruction(LLVMBuildSRem, "mod")},
+      {"__vbi_negateI32", unaryInstruction(LLVMBuildNeg, "negated")},
+      {"__vbi_lessThanI32", intCompare(LLVMIntSLT)},
+      {"__vbi_greaterThanI32", intCompare(LLVMIntSGT)},
+      {"__vbi_lessThanOrEqI32", intCompare(LLVMIntSLE)},
+      {"__vbi_greaterThanOrEqI32", intCompare(LLVMIntSGE)},
+      {"__vbi_eqI32", intCompare(LLVMIntEQ)},
+
+      {"__vbi_addI64", binaryInstruction(LLVMBuildAdd, "add")},
+      {"__vbi_subtractI64", binaryInstruction(LLVMBuildSub, "diff")},
+      {"__vbi_multiplyI64", binaryInstruction(LLVMBuildMul, "mul")},
+      {"__vbi_divideI64", binaryInstruction(LLVMBuildSDiv, "divided")},
+      {"__vbi_modI64", binaryInstruction(LLVMBuildSRem, "mod")},
+      {"__vbi_lessThanI64", intCompare(LLVMIntSLT)},
+      {"__vbi_greaterThanI64", intCompare(LLVMIntSGT)},
+      {"__vbi_lessThanOrEqI64", intCompare(LLVMIntSLE)},
+      {"__vbi_greaterThanOrEqI64", intCompare(LLVMIntSGE)},
+      {"__vbi_eqI64", intCompare(LLVMIntEQ)},
+
+      {"__vbi_addFloatFloat", binaryInstruction(LLVMBuildFAdd, "add")},
+      {"__vbi_subtractFloatFloat", binaryInstruction(LLVMBuildFSub, "subtracted")},
+      {"__vbi_multiplyFloatFloat", binaryInstruction(LLVMBuildFMul, "multiplied")},
+      {"__vbi_divideFloatFloat", binaryInstruction(LLVMBuildFDiv, "divided")},
+      {"__vbi_negateFloat", unaryInstruction(LLVMBuildFNeg, "negated")},
+      {"__vbi_lessThanFloat", floatCompare(LLVMRealOLT)},
+      {"__vbi_greaterThanFloat", floatCompare(LLVMRealOGT)},
+      {"__vbi_eqFloatFloat", floatCompare(LLVMRealOEQ)},
+
+      {"__vbi_eqBoolBool", intCompare(LLVMIntEQ)},
+      {"__vbi_not", unaryInstruction(LLVMBuildNot, "")},
+      {"__vbi_and", binaryInstruction(LLVMBuildAnd, "")},
+      {"__vbi_or", binaryInstruction(LLVMBuildOr, "")},
+
+      {"__vbi_addCheckedI32", checkedArithmetic("llvm.sadd.with.overflow")},
+      {"__vbi_subtractCheckedI32", checkedArithmetic("llvm.ssub.with.overflow")},
+      {"__vbi_multiplyCheckedI32", checkedArithmetic("llvm.smul.with.overflow")},
+      {"__vbi_addCheckedI64", checkedArithmetic("llvm.sadd.with.overflow")},
+      {"__vbi_subtractCheckedI64", checkedArithmetic("llvm.ssub.with.overflow")},
+      {"__vbi_multiplyCheckedI64", checkedArithmetic("llvm.smul.with.overflow")},
+
+      {"__vbi_popcountI32", llvmIntrinsic("llvm.ctpop")},
+      {"__vbi_countLeadingZerosI32", countZeros("llvm.ctlz")},
+      {"__vbi_countTrailingZerosI32", countZeros("llvm.cttz")},
+      {"__vbi_shiftLeftI32", shift(LLVMBuildShl)},
+      {"__vbi_shiftRightI32", shift(LLVMBuildAShr)},
+      {"__vbi_shiftRightLogicalI32", shift(LLVMBuildLShr)},
+      {"__vbi_bitAndI32", binaryInstruction(LLVMBuildAnd, "and")},
+      {"__vbi_bitOrI32", binaryInstruction(LLVMBuildOr, "or")},
+      {"__vbi_bitXorI32", binaryInstruction(LLVMBuildXor, "xor")},
+      {"__vbi_popcountI64", llvmIntrinsic("llvm.ctpop")},
+      {"__vbi_countLeadingZerosI64", countZeros("llvm.ctlz")},
+      {"__vbi_countTrailingZerosI64", countZeros("llvm.cttz")},
+      {"__vbi_shiftLeftI64", shift(LLVMBuildShl)},
+      {"__vbi_shiftRightI64", shift(LLVMBuildAShr)},
+      {"__vbi_shiftRightLogicalI64", shift(LLVMBuildLShr)},
+      {"__vbi_bitAndI64", binaryInstruction(LLVMBuildAnd, "and")},
+      {"__vbi_bitOrI64", binaryInstruction(LLVMBuildOr, "or")},
+      {"__vbi_bitXorI64", binaryInstruction(LLVMBuildXor, "xor")},
+
+      {"__vbi_minI32", intSelect(LLVMIntSLT, "min")},
+      {"__vbi_maxI32", intSelect(LLVMIntSGT, "max")},
+      {"__vbi_minI64", intSelect(LLVMIntSLT, "min")},
+      {"__vbi_maxI64", intSelect(LLVMIntSGT, "max")},
+      // These ignore a NaN if the other one isn't NaN.
+      {"__vbi_minFloat", llvmIntrinsic("llvm.minnum")},
+      {"__vbi_maxFloat", llvmIntrinsic("llvm.maxnum")},
+
+      {"__vbi_saturatingFloatI32", saturatingFloatToInt(LLVMInt32TypeInContext)},
+      {"__vbi_saturatingFloatI64", saturatingFloatToInt(LLVMInt64TypeInContext)},
+      {"__vbi_saturatingI64I32", pureIntrinsic(
+          [](GlobalState* globalState, FunctionState*, LLVMBuilderRef builder, const std::vector<LLVMValueRef>& argsLE) {
+            assert(argsLE.size() == 1);
+            auto int64LT = LLVMInt64TypeInContext(globalState->context);
+            auto minLE = LLVMConstInt(int64LT, INT32_MIN, true);
+            auto maxLE = LLVMConstInt(int64LT, INT32_MAX, true);
+            auto tooLowLE = LLVMBuildICmp(builder, LLVMIntSLT, argsLE[0], minLE, "tooLow");
+            auto atLeastMinLE = LLVMBuildSelect(builder, tooLowLE, minLE, argsLE[0], "atLeastMin");
+            auto tooHighLE = LLVMBuildICmp(builder, LLVMIntSGT, atLeastMinLE, maxLE, "tooHigh");
+            auto clampedLE = LLVMBuildSelect(builder, tooHighLE, maxLE, atLeastMinLE, "clamped");
+            return LLVMBuildTrunc(builder, clampedLE, LLVMInt32TypeInContext(globalState->context), "saturated");
+          })},
+
+      {"__vbi_strLength", buildStrLength},
+      {"__vbi_strLengthI64", buildStrLength},
+      {"__vbi_panic", buildPanic},
+      {"__vbi_getch", buildGetch},
+  };
+  return intrinsicsByExternName;
+}
+
+} // namespace
+
+const IntrinsicLowering* findIntrinsic(GlobalState* globalState, Prototype* prototype) {
+  auto iter = globalState->intrinsicsByName.find(prototype->name);
+  if (iter == globalState->intrinsicsByName.end()) {
+    const IntrinsicLowering* intrinsic = nullptr;
+    auto& intrinsicsByExternName = getIntrinsicsByExternName();
+    auto externNameIter = intrinsicsByExternName.find(prototype->name->name);
+    if (externNameIter != intrinsicsByExternName.end()) {
+      intrinsic = &externNameIter->second;
+    }
+    iter = globalState->intrinsicsByName.emplace(prototype->name, intrinsic).first;
+  }
+  return iter->second;
+}
@@ -31,7 +31,9 @@ Ref translateLocalLoad(
   auto resultRef =
       globalState->getRegion(localType)->upgradeLoadResultToRefWithTargetOwnership(
           functionState, builder, localType, resultType, LoadResult{sourceRef});
-  globalState->getRegion(resultType)->alias(FL(), functionState, builder, resultType, resultRef);
+  if (!functionState->rcElisions.aliasElided(localLoad)) {
+    globalState->getRegion(resultType)->alias(FL(), functionState, builder, resultType, resultRef);
+  }
 
   return resultRef;
 }
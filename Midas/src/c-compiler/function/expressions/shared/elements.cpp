@@ -21,7 +21,12 @@ LLVMValueRef checkIndexInBounds(
   auto indexLE =
       globalState->getRegion(inntRefMT)
           ->checkValidReference(FL(), functionState, builder, inntRefMT, indexRef);
-  auto isNonNegativeLE = LLVMBuildICmp(builder, LLVMIntSGE, indexLE, constI32LE(globalState, 0), "isNonNegative");
+  if (functionState->indicesKnownInBounds.count(indexLE)) {
+    // The loop around us already compared this index to this array's length.
+    return indexLE;
+  }
+  auto zeroLE = LLVMConstInt(LLVMIntTypeInContext(globalState->context, intMT->bits), 0, false);
+  auto isNonNegativeLE = LLVMBuildICmp(builder, LLVMIntSGE, indexLE, zeroLE, "isNonNegative");
   auto isUnderLength = LLVMBuildICmp(builder, LLVMIntSLT, indexLE, sizeLE, "isUnderLength");
   auto isWithinBounds = LLVMBuildAnd(builder, isNonNegativeLE, isUnderLength, "isWithinBounds");
   buildAssert(globalState, functionState, builder, isWithinBounds, "Index out of bounds!");
@@ -60,21 +65,18 @@ LLVMValueRef getRuntimeSizedArrayLengthPtr(
           runtimeSizedArrayWrapperPtrLE.refLE,
           1, // Length is after the control block and before contents.
           "rsaLenPtr");
-  assert(LLVMTypeOf(resultLE) == LLVMPointerType(LLVMInt32TypeInContext(globalState->context), 0));
+  assert(LLVMTypeOf(resultLE) == LLVMPointerType(globalState->getLengthLT(), 0));
   return resultLE;
 }
 
 
-LoadResult loadElement(
+LoadResult loadInnerArrayMember(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
     LLVMValueRef elemsPtrLE,
     Reference* elementRefM,
-    Ref sizeRef,
-    Ref indexRef) {
-  auto indexLE = checkIndexInBounds(globalState, functionState, builder, globalState->metalCache->i32, sizeRef, indexRef);
-
+    LLVMValueRef indexLE) {
   assert(LLVMGetTypeKind(LLVMTypeOf(elemsPtrLE)) == LLVMPointerTypeKind);
   LLVMValueRef indices[2] = {
       constI32LE(globalState, 0),
@@ -92,6 +94,19 @@ LoadResult loadElement(
   return LoadResult{sourceRef};
 }
 
+LoadResult loadElement(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    LLVMValueRef elemsPtrLE,
+    Reference* elementRefM,
+    Int* indexMT,
+    Ref sizeRef,
+    Ref indexRef) {
+  auto indexLE = checkIndexInBounds(globalState, functionState, builder, indexMT, sizeRef, indexRef);
+  return loadInnerArrayMember(globalState, functionState, builder, elemsPtrLE, elementRefM, indexLE);
+}
+
 void storeInnerArrayMember(
     GlobalState* globalState,
     FunctionState* functionState,
@@ -135,18 +150,19 @@ Ref swapElement(
     LLVMBuilderRef builder,
     Location location,
     Reference* elementRefM,
+    Int* indexMT,
     Ref sizeRef,
     LLVMValueRef arrayPtrLE,
     Ref indexRef,
     Ref sourceRef) {
   assert(location != Location::INLINE); // impl
 
-  auto indexLE = checkIndexInBounds(globalState, functionState, builder, globalState->metalCache->i32, sizeRef, indexRef);
+  auto indexLE = checkIndexInBounds(globalState, functionState, builder, indexMT, sizeRef, indexRef);
   auto sourceLE =
       globalState->getRegion(elementRefM)
           ->checkValidReference(FL(), functionState, builder, elementRefM, sourceRef);
   buildFlare(FL(), globalState, functionState, builder);
-  auto resultLE = loadElement(globalState, functionState, builder, arrayPtrLE, elementRefM, sizeRef, indexRef);
+  auto resultLE = loadInnerArrayMember(globalState, functionState, builder, arrayPtrLE, elementRefM, indexLE);
   storeInnerArrayMember(globalState, functionState, builder, arrayPtrLE, indexLE, sourceLE);
   return resultLE.move();
 }
@@ -157,13 +173,14 @@ void initializeElement(
     LLVMBuilderRef builder,
     Location location,
     Reference* elementRefM,
+    Int* indexMT,
     Ref sizeRef,
     LLVMValueRef arrayPtrLE,
     Ref indexRef,
     Ref sourceRef) {
   assert(location != Location::INLINE); // impl
 
-  auto indexLE = checkIndexInBounds(globalState, functionState, builder, globalState->metalCache->i32, sizeRef, indexRef);
+  auto indexLE = checkIndexInBounds(globalState, functionState, builder, indexMT, sizeRef, indexRef);
   auto sourceLE =
       globalState->getRegion(elementRefM)
           ->checkValidReference(FL(), functionState, builder, elementRefM, sourceRef);
@@ -175,19 +192,22 @@ void intRangeLoop(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
+    Int* innt,
     Ref sizeRef,
     std::function<void(Ref, LLVMBuilderRef)> iterationBuilder) {
+  auto intLT = LLVMIntTypeInContext(globalState->context, innt->bits);
+  auto inntRefMT = globalState->metalCache->getReference(Ownership::SHARE, Location::INLINE, innt);
   auto sizeLE =
-      globalState->getRegion(globalState->metalCache->i32Ref)
-          ->checkValidReference(FL(), functionState, builder, globalState->metalCache->i32Ref, sizeRef);
+      globalState->getRegion(inntRefMT)
+          ->checkValidReference(FL(), functionState, builder, inntRefMT, sizeRef);
 
   LLVMValueRef iterationIndexPtrLE =
       makeMidasLocal(
           functionState,
           builder,
-          LLVMInt32TypeInContext(globalState->context),
+          intLT,
           "iterationIndex",
-          constI32LE(globalState, 0));
+          LLVMConstInt(intLT, 0, false));
 
   buildWhile(
       globalState,
@@ -200,11 +220,11 @@ void intRangeLoop(
             LLVMBuildICmp(conditionBuilder, LLVMIntSLT, iterationIndexLE, sizeLE, "iterationIndexIsBeforeEnd");
         return wrap(globalState->getRegion(globalState->metalCache->boolRef), globalState->metalCache->boolRef, isBeforeEndLE);
       },
-      [globalState, iterationBuilder, iterationIndexPtrLE](LLVMBuilderRef bodyBuilder) {
+      [globalState, iterationBuilder, innt, inntRefMT, iterationIndexPtrLE](LLVMBuilderRef bodyBuilder) {
         auto iterationIndexLE = LLVMBuildLoad(bodyBuilder, iterationIndexPtrLE, "iterationIndex");
-        auto iterationIndexRef = wrap(globalState->getRegion(globalState->metalCache->i32Ref), globalState->metalCache->i32Ref, iterationIndexLE);
+        auto iterationIndexRef = wrap(globalState->getRegion(inntRefMT), inntRefMT, iterationIndexLE);
         iterationBuilder(iterationIndexRef, bodyBuilder);
-        adjustCounter(globalState, bodyBuilder, globalState->metalCache->i32, iterationIndexPtrLE, 1);
+        adjustCounter(globalState, bodyBuilder, innt, iterationIndexPtrLE, 1);
       });
 }
 
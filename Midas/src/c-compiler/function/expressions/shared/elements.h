@@ -30,6 +30,7 @@ void initializeElement(
     LLVMBuilderRef builder,
     Location location,
     Reference* elementRefM,
+    Int* indexMT,
     Ref sizeLE,
     LLVMValueRef arrayPtrLE,
     Ref indexLE,
@@ -41,6 +42,7 @@ Ref swapElement(
     LLVMBuilderRef builder,
     Location location,
     Reference* elementRefM,
+    Int* indexMT,
     Ref sizeLE,
     LLVMValueRef arrayPtrLE,
     Ref indexLE,
@@ -54,6 +56,7 @@ LoadResult loadElement(
     LLVMBuilderRef builder,
     LLVMValueRef elemsPtrLE,
     Reference* elementRefM,
+    Int* indexMT,
     Ref sizeRef,
     Ref indexRef);
 
@@ -61,6 +64,7 @@ void intRangeLoop(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
+    Int* innt,
     Ref sizeRef,
     std::function<void(Ref, LLVMBuilderRef)> iterationBuilder);
 
@@ -93,4 +97,13 @@ void storeInnerArrayMember(
     LLVMValueRef indexLE,
     LLVMValueRef sourceLE);
 
+// Like loadElement, but doesn't check the index, the caller already did.
+LoadResult loadInnerArrayMember(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    LLVMValueRef elemsPtrLE,
+    Reference* elementRefM,
+    LLVMValueRef indexLE);
+
 #endif
@@ -77,6 +77,10 @@ LLVMValueRef adjustStrongRc(
       assert(false);
   }
 
+  if (globalState->opt->printMemOverhead && refM->ownership != Ownership::SHARE) {
+    adjustCounter(globalState, builder, globalState->metalCache->i64, globalState->mutRcAdjustCounter, 1);
+  }
+
   auto controlBlockPtrLE =
       kindStructsSource->getControlBlockPtr(from, functionState, builder, exprRef, refM);
   auto rcPtrLE = kindStructsSource->getStrongRcPtrFromControlBlockPtr(builder, refM, controlBlockPtrLE);
@@ -158,6 +162,43 @@ void buildPrint(
   buildPrint(globalState, builder, LLVMConstInt(LLVMInt64TypeInContext(globalState->context), num, false));
 }
 
+static void addFunctionAttribute(GlobalState* globalState, LLVMValueRef functionL, const std::string& name) {
+  auto kind = LLVMGetEnumAttributeKindForName(name.c_str(), name.size());
+  LLVMAddAttributeAtIndex(
+      functionL, LLVMAttributeFunctionIndex, LLVMCreateEnumAttribute(globalState->context, kind, 0));
+}
+
+void buildFail(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    const std::string& message,
+    int exitCode) {
+  auto key = std::to_string(exitCode) + ":" + message;
+  auto iter = globalState->failFunctions.find(key);
+  if (iter == globalState->failFunctions.end()) {
+    auto functionLT = LLVMFunctionType(LLVMVoidTypeInContext(globalState->context), nullptr, 0, false);
+    auto name = std::string("__vale_fail") + std::to_string(globalState->failFunctions.size());
+    auto functionL = LLVMAddFunction(globalState->mod, name.c_str(), functionLT);
+    LLVMSetLinkage(functionL, LLVMInternalLinkage);
+    addFunctionAttribute(globalState, functionL, "cold");
+    addFunctionAttribute(globalState, functionL, "noinline");
+    addFunctionAttribute(globalState, functionL, "noreturn");
+    addFunctionAttribute(globalState, functionL, "nounwind");
+
+    auto failBuilder = LLVMCreateBuilderInContext(globalState->context);
+    LLVMPositionBuilderAtEnd(failBuilder, LLVMAppendBasicBlockInContext(globalState->context, functionL, "entry"));
+    buildPrint(globalState, failBuilder, message);
+    LLVMBuildCall(failBuilder, globalState->externs->flush, nullptr, 0, "");
+    auto exitCodeIntLE = LLVMConstInt(LLVMInt64TypeInContext(globalState->context), exitCode, false);
+    LLVMBuildCall(failBuilder, globalState->externs->exit, &exitCodeIntLE, 1, "");
+    LLVMBuildUnreachable(failBuilder);
+    LLVMDisposeBuilder(failBuilder);
+
+    iter = globalState->failFunctions.emplace(key, functionL).first;
+  }
+  LLVMBuildCall(builder, iter->second, nullptr, 0, "");
+}
+
 // We'll assert if conditionLE is false.
 void buildAssert(
     GlobalState* globalState,
@@ -175,12 +216,10 @@ void buildAssertWithExitCode(
     LLVMValueRef conditionLE,
     int exitCode,
     const std::string& failMessage) {
-  buildIf(
+  buildColdIf(
       globalState, functionState, builder, isZeroLE(builder, conditionLE),
       [globalState, exitCode, failMessage](LLVMBuilderRef thenBuilder) {
-        buildPrint(globalState, thenBuilder, failMessage + " Exiting!\n");
-        auto exitCodeIntLE = LLVMConstInt(LLVMInt64TypeInContext(globalState->context), exitCode, false);
-        LLVMBuildCall(thenBuilder, globalState->externs->exit, &exitCodeIntLE, 1, "");
+        buildFail(globalState, thenBuilder, failMessage + " Exiting!\n", exitCode);
       });
 }
 
@@ -194,7 +233,7 @@ void buildAssertIntEq(
     const std::string& failMessage) {
   assert(LLVMTypeOf(aLE) == LLVMTypeOf(bLE));
   auto conditionLE = LLVMBuildICmp(builder, LLVMIntEQ, aLE, bLE, "assertCondition");
-  buildIf(
+  buildColdIf(
       globalState, functionState, builder, isZeroLE(builder, conditionLE),
       [globalState, functionState, failMessage, aLE, bLE](LLVMBuilderRef thenBuilder) {
         buildPrint(globalState, thenBuilder, "Assertion failed! Expected ");
@@ -282,7 +321,7 @@ void buildAssertCensusContains(
             builder, ptrLE, LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0), "");
 
     auto isNullLE = LLVMBuildIsNull(builder, resultAsVoidPtrLE, "isNull");
-    buildIf(globalState, functionState, builder, isNullLE,
+    buildColdIf(globalState, functionState, builder, isNullLE,
             [globalState, checkerAFL, ptrLE](LLVMBuilderRef thenBuilder) {
               buildPrintAreaAndFileAndLine(globalState, thenBuilder, checkerAFL);
               buildPrint(globalState, thenBuilder, "Object null, so not in census, exiting!\n");
@@ -297,7 +336,7 @@ void buildAssertCensusContains(
     auto isRegisteredBoolLE =
         LLVMBuildTruncOrBitCast(
             builder, isRegisteredIntLE, LLVMInt1TypeInContext(globalState->context), "");
-    buildIf(globalState, functionState, builder, isZeroLE(builder, isRegisteredBoolLE),
+    buildColdIf(globalState, functionState, builder, isZeroLE(builder, isRegisteredBoolLE),
         [globalState, checkerAFL, ptrLE](LLVMBuilderRef thenBuilder) {
           buildPrintAreaAndFileAndLine(globalState, thenBuilder, checkerAFL);
           buildPrint(globalState, thenBuilder, "Object &");
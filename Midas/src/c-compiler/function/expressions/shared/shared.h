@@ -55,6 +55,15 @@ LLVMValueRef strongRcIsZero(
     ControlBlockPtrLE exprLE);
 
 
+// Calls a function that prints the message and exits with the code. There's one such function per
+// message and code, marked cold and never inlined, so the failure paths of checks don't take up
+// room in the functions doing the checking.
+void buildFail(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    const std::string& message,
+    int exitCode);
+
 void buildAssert(
     GlobalState* globalState,
     FunctionState* functionState,
@@ -1,5 +1,6 @@
 #include "string.h"
 #include "region/common/heap.h"
+#include "region/rcimm/rcimm.h"
 
 LLVMValueRef getInnerStrPtrFromWrapperPtr(
     LLVMBuilderRef builder,
@@ -47,7 +48,12 @@ Ref buildConstantVStr(
     LLVMBuilderRef builder,
     const std::string& contents) {
 
-  auto lengthLE = constI32LE(globalState, contents.length());
+  if (globalState->opt->staticStrings && !globalState->opt->census &&
+      globalState->getRegion(globalState->metalCache->strRef) == globalState->rcImm) {
+    return globalState->rcImm->constantStr(functionState, builder, contents);
+  }
+
+  auto lengthLE = LLVMConstInt(globalState->getLengthLT(), contents.length(), false);
 
   auto strRef =
       globalState->getRegion(globalState->metalCache->strRef)
@@ -12,6 +12,17 @@ Ref translateWhile(
     BlockState* blockState,
     LLVMBuilderRef builder,
     While* whiile) {
+  // Check these once up here, so the accesses in the loop don't have to.
+  // See InferredKnownLives::hoistedChecksByWhile.
+  auto hoistedChecksIter = functionState->inferredKnownLives.hoistedChecksByWhile.find(whiile);
+  if (hoistedChecksIter != functionState->inferredKnownLives.hoistedChecksByWhile.end()) {
+    for (auto local : hoistedChecksIter->second) {
+      auto region = globalState->getRegion(local->type);
+      auto localAddr = blockState->getLocalAddr(local->id);
+      auto ref = region->loadLocal(functionState, builder, local, localAddr);
+      region->lockWeakRef(FL(), functionState, builder, local->type, ref, false);
+    }
+  }
   buildWhile(
       globalState,
       functionState, builder,
@@ -7,6 +7,8 @@
 #include "function.h"
 #include "expression.h"
 #include "boundary.h"
+#include "utils/aliasing.h"
+#include "function/expressions/shared/elements.h"
 
 LLVMValueRef declareFunction(
     GlobalState* globalState,
@@ -22,6 +24,9 @@ LLVMValueRef declareFunction(
   auto valeFunctionNameL = functionM->prototype->name->name;
 
   LLVMValueRef valeFunctionL = LLVMAddFunction(globalState->mod, valeFunctionNameL.c_str(), valeFunctionTypeL);
+  if (globalState->opt->emitAliasMetadata) {
+    addParamAliasAttributes(globalState, valeFunctionL, functionM->prototype);
+  }
 
   assert(globalState->functions.count(functionM->prototype->name->name) == 0);
   globalState->functions.emplace(functionM->prototype->name->name, valeFunctionL);
@@ -171,6 +176,109 @@ void exportFunction(GlobalState* globalState, Package* package, Function* functi
   LLVMDisposeBuilder(builder);
 }
 
+bool canBatchExport(GlobalState* globalState, Prototype* prototype) {
+  auto isBatchable = [globalState](Reference* refMT) {
+    return dynamic_cast<Int*>(refMT->kind) ||
+        dynamic_cast<Bool*>(refMT->kind) ||
+        dynamic_cast<Float*>(refMT->kind) ||
+        (refMT->ownership == Ownership::SHARE &&
+            refMT->location != Location::INLINE &&
+            dynamic_cast<StructKind*>(refMT->kind) &&
+            !typeNeedsPointerParameter(globalState, refMT));
+  };
+  for (auto paramMT : prototype->params) {
+    if (!isBatchable(paramMT)) {
+      return false;
+    }
+  }
+  return prototype->returnType == globalState->metalCache->emptyTupleStructRef ||
+      isBatchable(prototype->returnType);
+}
+
+void exportBatchFunction(GlobalState* globalState, Package* package, Function* functionM) {
+  auto prototype = functionM->prototype;
+  auto int32LT = LLVMInt32TypeInContext(globalState->context);
+  bool returnsVoid = translatesToCVoid(globalState, prototype->returnType);
+
+  // The count, then the results array unless it returns nothing, then an array per parameter.
+  std::vector<LLVMTypeRef> batchParamTypesL = { int32LT };
+  if (!returnsVoid) {
+    batchParamTypesL.push_back(
+        LLVMPointerType(globalState->getRegion(prototype->returnType)->getExternalType(prototype->returnType), 0));
+  }
+  int firstArgsParamIndex = batchParamTypesL.size();
+  for (auto valeParamRefMT : prototype->params) {
+    batchParamTypesL.push_back(
+        LLVMPointerType(globalState->getRegion(valeParamRefMT)->getExternalType(valeParamRefMT), 0));
+  }
+  auto voidLT = LLVMVoidTypeInContext(globalState->context);
+  LLVMTypeRef batchFunctionTypeL =
+      LLVMFunctionType(voidLT, batchParamTypesL.data(), batchParamTypesL.size(), 0);
+
+  auto batchName = std::string("vale_abi_") + package->getFunctionExportName(prototype) + "_batch";
+  LLVMValueRef batchFunctionL = LLVMAddFunction(globalState->mod, batchName.c_str(), batchFunctionTypeL);
+  LLVMSetLinkage(batchFunctionL, LLVMExternalLinkage);
+
+  // Unlike exportFunction, this needs a separate locals block, so anything receiving or sending an
+  // argument makes its locals once, not once per iteration.
+  auto localsBuilder = LLVMCreateBuilderInContext(globalState->context);
+  LLVMBasicBlockRef localsBlockL = LLVMAppendBasicBlockInContext(globalState->context, batchFunctionL, "localsBlock");
+  LLVMPositionBuilderAtEnd(localsBuilder, localsBlockL);
+  LLVMBasicBlockRef firstBlockL = LLVMAppendBasicBlockInContext(globalState->context, batchFunctionL, "codeStartBlock");
+  LLVMBuilderRef builder = LLVMCreateBuilderInContext(globalState->context);
+  LLVMPositionBuilderAtEnd(builder, firstBlockL);
+
+  FunctionState functionState(batchName, batchFunctionL, voidLT, localsBuilder);
+  buildFlare(FL(), globalState, &functionState, builder, "Calling batch export function ", batchName, " from native");
+
+  auto i32MT = globalState->metalCache->i32Ref;
+  auto countRef = wrap(globalState->getRegion(i32MT), i32MT, LLVMGetParam(batchFunctionL, 0));
+  intRangeLoop(
+      globalState, &functionState, builder, globalState->metalCache->i32, countRef,
+      [globalState, &functionState, prototype, returnsVoid, batchFunctionL, firstArgsParamIndex, i32MT](
+          Ref indexRef, LLVMBuilderRef bodyBuilder) {
+        auto indexLE =
+            globalState->getRegion(i32MT)->checkValidReference(FL(), &functionState, bodyBuilder, i32MT, indexRef);
+
+        std::vector<Ref> argsToActualFunction;
+        for (int logicalParamIndex = 0; logicalParamIndex < prototype->params.size(); logicalParamIndex++) {
+          auto valeParamMT = prototype->params[logicalParamIndex];
+          auto hostParamMT =
+              (valeParamMT->ownership == Ownership::SHARE ?
+               globalState->linearRegion->linearizeReference(valeParamMT) :
+               valeParamMT);
+          auto cArgsPtrLE = LLVMGetParam(batchFunctionL, firstArgsParamIndex + logicalParamIndex);
+          auto cArgPtrLE = LLVMBuildGEP(bodyBuilder, cArgsPtrLE, &indexLE, 1, "argPtr");
+          auto hostArgRefLE = LLVMBuildLoad(bodyBuilder, cArgPtrLE, "arg");
+          argsToActualFunction.push_back(
+              receiveHostObjectIntoVale(
+                  globalState, &functionState, bodyBuilder, hostParamMT, valeParamMT, hostArgRefLE));
+        }
+
+        auto valeReturnRef = buildCall(globalState, &functionState, bodyBuilder, prototype, argsToActualFunction);
+
+        if (!returnsVoid) {
+          auto valeReturnMT = prototype->returnType;
+          auto hostReturnMT =
+              (valeReturnMT->ownership == Ownership::SHARE ?
+               globalState->linearRegion->linearizeReference(valeReturnMT) :
+               valeReturnMT);
+          auto [hostReturnRefLE, hostReturnSizeLE] =
+              sendValeObjectIntoHost(
+                  globalState, &functionState, bodyBuilder, valeReturnMT, hostReturnMT, valeReturnRef);
+          auto resultPtrLE = LLVMBuildGEP(bodyBuilder, LLVMGetParam(batchFunctionL, 1), &indexLE, 1, "resultPtr");
+          LLVMBuildStore(bodyBuilder, hostReturnRefLE, resultPtrLE);
+        }
+      });
+
+  buildFlare(FL(), globalState, &functionState, builder, "Done calling batch export function ", batchName, " from native");
+  LLVMBuildRetVoid(builder);
+  LLVMBuildBr(localsBuilder, firstBlockL);
+
+  LLVMDisposeBuilder(builder);
+  LLVMDisposeBuilder(localsBuilder);
+}
+
 LLVMValueRef declareExternFunction(
     GlobalState* globalState,
     Package* package,
@@ -198,7 +306,7 @@ LLVMValueRef declareExternFunction(
 
   for (int i = 0; i < prototypeM->params.size(); i++) {
     if (includeSizeParam(globalState, prototypeM, i)) {
-      externParamTypesL.push_back(LLVMInt32TypeInContext(globalState->context));
+      externParamTypesL.push_back(globalState->getLengthLT());
     }
   }
 
@@ -234,6 +342,37 @@ void translateFunction(
 
   FunctionState functionState(
       functionM->prototype->name->name, functionL, returnTypeL, localsBuilder);
+  if (globalState->opt->elideRcAdjustments) {
+    functionState.rcElisions = analyzeRcElisions(globalState, functionM);
+    if (globalState->opt->printOptStats && functionState.rcElisions.numElided() > 0) {
+      std::cout << "RC elision: removed " << functionState.rcElisions.numElided()
+          << " adjustments from " << functionM->prototype->name->name << std::endl;
+    }
+  }
+  if (globalState->opt->elideChecksForKnownLive && globalState->opt->inferKnownLive) {
+    functionState.inferredKnownLives = inferKnownLives(globalState, functionM);
+    if (globalState->opt->printOptStats && functionState.inferredKnownLives.size() > 0) {
+      std::cout << "Known live: inferred " << functionState.inferredKnownLives.size()
+          << " accesses in " << functionM->prototype->name->name << std::endl;
+    }
+  }
+  if (globalState->opt->hoistLoopChecks) {
+    functionState.inBoundsAccesses = findInBoundsAccesses(globalState, functionM);
+  }
+  if (globalState->opt->stackAllocateStructs) {
+    functionState.stackAllocations = findStackAllocations(globalState, functionM);
+    if (globalState->opt->printOptStats && functionState.stackAllocations.size() > 0) {
+      std::cout << "Stack allocation: moved " << functionState.stackAllocations.size()
+          << " structs to the stack in " << functionM->prototype->name->name << std::endl;
+    }
+  }
+  if (globalState->opt->printOptStats &&
+      (functionState.inferredKnownLives.numHoistedChecks() > 0 ||
+          functionState.inBoundsAccesses.size() > 0)) {
+    std::cout << "Loop checks: hoisted " << functionState.inferredKnownLives.numHoistedChecks()
+        << " liveness checks and removed " << functionState.inBoundsAccesses.size()
+        << " bounds checks in " << functionM->prototype->name->name << std::endl;
+  }
 
   // There are other builders made elsewhere for various blocks in the function,
   // but this is the one for the top level.
@@ -348,3 +487,18 @@ void declareAndDefineExtraFunction(
   declareExtraFunction(globalState, prototype, llvmName);
   defineFunctionBody(globalState, prototype, definer);
 }
+
+void internalizeFunctions(GlobalState* globalState) {
+  auto internalize = [](LLVMValueRef functionL) {
+    // Anything without a body is defined somewhere else, like in C.
+    if (!LLVMIsDeclaration(functionL)) {
+      LLVMSetLinkage(functionL, LLVMInternalLinkage);
+    }
+  };
+  for (auto [name, functionL] : globalState->functions) {
+    internalize(functionL);
+  }
+  for (auto [prototype, functionL] : globalState->extraFunctions) {
+    internalize(functionL);
+  }
+}
@@ -11,6 +11,10 @@
 #include "metal/ast.h"
 #include "metal/instructions.h"
 #include "globalstate.h"
+#include "function/analysis/rcelision.h"
+#include "function/analysis/knownlive.h"
+#include "function/analysis/loopbounds.h"
+#include "function/analysis/stackalloc.h"
 
 class BlockState {
 private:
@@ -127,6 +131,24 @@ public:
   LLVMBuilderRef localsBuilder;
   int nextBlockNumber = 1;
   int instructionDepthInAst = 0;
+  // RC adjustments that the analysis found unnecessary, see analyzeRcElisions.
+  RcElisions rcElisions;
+  // Accesses that the analysis proved are to a live object, see inferKnownLives.
+  InferredKnownLives inferredKnownLives;
+  // Array accesses that the analysis proved are in bounds, see findInBoundsAccesses.
+  InBoundsAccesses inBoundsAccesses;
+  // The translated indices of those accesses. checkIndexInBounds skips these,
+  // so the regions don't need to thread another flag down to it.
+  std::unordered_set<LLVMValueRef> indicesKnownInBounds;
+  // Structs that the analysis proved never leave this function, see findStackAllocations.
+  StackAllocations stackAllocations;
+  // Set while we make or destroy one of those, so mallocKnownSize and
+  // innerDeallocateYonder use the stack instead of the heap.
+  bool allocatingOnStack = false;
+  bool deallocatingFromStack = false;
+  // Set in functions that unserialize into a slab, see slab.c. Heap allocations there come from
+  // the slab, and put their offset in this local for the region to put in the control block.
+  LLVMValueRef slabOffsetPtrLE = nullptr;
 
   FunctionState(
       std::string containingFuncName_,
@@ -153,6 +175,14 @@ LLVMValueRef declareFunction(
 
 void exportFunction(GlobalState* globalState, Package* package, Function* functionM);
 
+// Whether we can make a _batch variant of this export, see exportBatchFunction. Only for
+// primitives and immutable structs, which C can hand us in plain arrays.
+bool canBatchExport(GlobalState* globalState, Prototype* prototype);
+
+// With --batch-exports, a thunk that takes a count, an array for the results, and an array for
+// each parameter, and calls the function once per index. Saves C a boundary crossing per call.
+void exportBatchFunction(GlobalState* globalState, Package* package, Function* functionM);
+
 LLVMValueRef declareExternFunction(
     GlobalState* globalState,
     Package* package,
@@ -177,6 +207,11 @@ void declareAndDefineExtraFunction(
     std::string llvmName,
     std::function<void(FunctionState*, LLVMBuilderRef)> definer);
 
+// Gives every Vale function and extra function we defined internal linkage. Only the export
+// thunks and main need to be seen from outside the module, and this lets LLVM drop, specialize and
+// change the calling convention of the rest.
+void internalizeFunctions(GlobalState* globalState);
+
 bool typeNeedsPointerParameter(GlobalState* globalState, Reference* returnMT);
 bool translatesToCVoid(GlobalState* globalState, Reference* returnMT);
 LLVMTypeRef translateReturnType(GlobalState* globalState, Reference* returnMT);
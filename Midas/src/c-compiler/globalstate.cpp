@@ -9,6 +9,8 @@
 GlobalState::GlobalState(AddressNumberer* addressNumberer_) :
     addressNumberer(addressNumberer_),
     interfaceTablePtrs(0, addressNumberer->makeHasher<Edge*>()),
+    edgesByInterface(0, addressNumberer->makeHasher<InterfaceKind*>()),
+    intrinsicsByName(0, addressNumberer->makeHasher<Name*>()),
     interfaceExtraMethods(0, addressNumberer->makeHasher<InterfaceKind*>()),
     overridesBySubstructByInterface(0, addressNumberer->makeHasher<InterfaceKind*>()),
     extraFunctions(0, addressNumberer->makeHasher<Prototype*>()),
@@ -159,28 +161,92 @@ Ref GlobalState::constI64(int64_t x) {
 Ref GlobalState::constI32(int32_t x) {
   return wrap(getRegion(metalCache->i32Ref), metalCache->i32Ref, constI32LE(this, x));
 }
+
+Int* GlobalState::getLengthMT() {
+  return opt->wideLengths ? metalCache->i64 : metalCache->i32;
+}
+Reference* GlobalState::getLengthRefMT() {
+  return opt->wideLengths ? metalCache->i64Ref : metalCache->i32Ref;
+}
+LLVMTypeRef GlobalState::getLengthLT() {
+  return LLVMIntTypeInContext(context, getLengthMT()->bits);
+}
+Ref GlobalState::constLength(int64_t x) {
+  return opt->wideLengths ? constI64(x) : constI32(x);
+}
+Ref GlobalState::intToLength(
+    FunctionState* functionState, LLVMBuilderRef builder, Reference* intMT, Ref intRef) {
+  auto intBits = dynamic_cast<Int*>(intMT->kind)->bits;
+  auto lengthBits = getLengthMT()->bits;
+  if (intBits == lengthBits) {
+    return intRef;
+  }
+  auto intLE = getRegion(intMT)->checkValidReference(FL(), functionState, builder, intMT, intRef);
+  LLVMValueRef lengthLE = nullptr;
+  if (intBits < lengthBits) {
+    // Sign extended, so a negative index stays out of bounds.
+    lengthLE = LLVMBuildSExt(builder, intLE, getLengthLT(), "asLength");
+  } else {
+    auto fitsLE =
+        LLVMBuildAnd(
+            builder,
+            LLVMBuildICmp(builder, LLVMIntSGE, intLE, constI64LE(this, INT32_MIN), "notTooLow"),
+            LLVMBuildICmp(builder, LLVMIntSLE, intLE, constI64LE(this, INT32_MAX), "notTooHigh"),
+            "fitsInLength");
+    buildAssert(this, functionState, builder, fitsLE, "Index or size too big, try --wide-lengths!");
+    lengthLE = LLVMBuildTrunc(builder, intLE, getLengthLT(), "asLength");
+  }
+  return wrap(getRegion(getLengthRefMT()), getLengthRefMT(), lengthLE);
+}
+Ref GlobalState::lengthToInt(
+    FunctionState* functionState, LLVMBuilderRef builder, Reference* intMT, Ref lengthRef) {
+  auto intBits = dynamic_cast<Int*>(intMT->kind)->bits;
+  auto lengthBits = getLengthMT()->bits;
+  if (intBits == lengthBits) {
+    return lengthRef;
+  }
+  auto lengthLE = getRegion(getLengthRefMT())->checkValidReference(FL(), functionState, builder, getLengthRefMT(), lengthRef);
+  auto intLT = LLVMIntTypeInContext(context, intBits);
+  LLVMValueRef intLE = nullptr;
+  if (intBits > lengthBits) {
+    // Lengths, and the indices we loop over, are never negative.
+    intLE = LLVMBuildZExt(builder, lengthLE, intLT, "asInt");
+  } else {
+    // Clamping would be worse, a loop up to the length would silently stop partway through.
+    auto fitsLE = LLVMBuildICmp(builder, LLVMIntSLE, lengthLE, constI64LE(this, INT32_MAX), "fitsInInt");
+    buildAssert(this, functionState, builder, fitsLE, "Length too big for an int, try lenI64!");
+    intLE = LLVMBuildTrunc(builder, lengthLE, intLT, "asInt");
+  }
+  return wrap(getRegion(intMT), intMT, intLE);
+}
+LLVMValueRef GlobalState::widenLengthToI64(LLVMBuilderRef builder, LLVMValueRef lengthLE) {
+  if (opt->wideLengths) {
+    return lengthLE;
+  }
+  return LLVMBuildZExt(builder, lengthLE, LLVMInt64TypeInContext(context), "lenAsI64");
+}
 Ref GlobalState::constI1(bool b) {
   return wrap(getRegion(metalCache->boolRef), metalCache->boolRef, constI1LE(this, b));
 }
 Ref GlobalState::buildAdd(FunctionState* functionState, LLVMBuilderRef builder, Ref a, Ref b) {
   auto intMT = metalCache->i32Ref;
-  auto addPrototype = metalCache->getPrototype(metalCache->getName(metalCache->builtinPackageCoord, "__addI32"), intMT, {intMT, intMT});
+  auto addPrototype = metalCache->getPrototype(metalCache->getName(metalCache->builtinPackageCoord, "__vbi_addI32"), intMT, {intMT, intMT});
   return buildExternCall(this, functionState, builder, addPrototype, { a, b });
 }
 Ref GlobalState::buildMod(FunctionState* functionState, LLVMBuilderRef builder, Ref a, Ref b) {
   auto intMT = metalCache->i32Ref;
-  auto addPrototype = metalCache->getPrototype(metalCache->getName(metalCache->builtinPackageCoord, "__mod"), intMT, {intMT, intMT});
+  auto addPrototype = metalCache->getPrototype(metalCache->getName(metalCache->builtinPackageCoord, "__vbi_modI32"), intMT, {intMT, intMT});
   return buildExternCall(this, functionState, builder, addPrototype, { a, b });
 }
 Ref GlobalState::buildDivide(FunctionState* functionState, LLVMBuilderRef builder, Ref a, Ref b) {
   auto intMT = metalCache->i32Ref;
-  auto addPrototype = metalCache->getPrototype(metalCache->getName(metalCache->builtinPackageCoord, "__divideI32"), intMT, {intMT, intMT});
+  auto addPrototype = metalCache->getPrototype(metalCache->getName(metalCache->builtinPackageCoord, "__vbi_divideI32"), intMT, {intMT, intMT});
   return buildExternCall(this, functionState, builder, addPrototype, { a, b });
 }
 
 Ref GlobalState::buildMultiply(FunctionState* functionState, LLVMBuilderRef builder, Ref a, Ref b) {
   auto intMT = metalCache->i32Ref;
-  auto addPrototype = metalCache->getPrototype(metalCache->getName(metalCache->builtinPackageCoord, "__multiplyIntInt"), intMT, {intMT, intMT});
+  auto addPrototype = metalCache->getPrototype(metalCache->getName(metalCache->builtinPackageCoord, "__vbi_multiplyI32"), intMT, {intMT, intMT});
   return buildExternCall(this, functionState, builder, addPrototype, { a, b });
 }
 
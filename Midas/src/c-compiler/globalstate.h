@@ -3,7 +3,9 @@
 
 #include <llvm-c/Core.h>
 
+#include <functional>
 #include <unordered_map>
+#include <unordered_set>
 #include <metal/metalcache.h>
 #include <region/common/defaultlayout/structs.h>
 
@@ -19,6 +21,12 @@ class KindStructs;
 class ControlBlock;
 class Linear;
 class RCImm;
+class GlobalState;
+class FunctionState;
+
+// Lowers a call to a builtin extern straight to instructions, see findIntrinsic.
+using IntrinsicLowering =
+    std::function<Ref(GlobalState*, FunctionState*, LLVMBuilderRef, Prototype*, const std::vector<Ref>&)>;
 
 constexpr int LGT_ENTRY_MEMBER_INDEX_FOR_GEN = 0;
 constexpr int LGT_ENTRY_MEMBER_INDEX_FOR_NEXT_FREE = 1;
@@ -77,11 +85,25 @@ public:
 
   LLVMBuilderRef stringConstantBuilder = nullptr;
   std::unordered_map<std::string, LLVMValueRef> stringConstants;
+  // The outlined failure paths, by exit code and message, see buildFail.
+  std::unordered_map<std::string, LLVMValueRef> failFunctions;
 
   std::unordered_map<Edge*, LLVMValueRef, AddressHasher<Edge*>> interfaceTablePtrs;
+  // Every struct that implements each interface. We see the whole program, so an interface call
+  // can only ever land in one of these.
+  std::unordered_map<InterfaceKind*, std::vector<Edge*>, AddressHasher<InterfaceKind*>> edgesByInterface;
+  // How many interface calls we turned into direct calls, and how many we looked at.
+  int numDevirtualizedInterfaceCalls = 0;
+  int numInterfaceCalls = 0;
+  // The TBAA type node for each struct's contents, see addMemberTbaaTag.
+  std::unordered_map<LLVMTypeRef, LLVMValueRef> tbaaStructTypeNodes;
 
   std::unordered_map<std::string, LLVMValueRef> functions;
   std::unordered_map<std::string, LLVMValueRef> externFunctions;
+  // What findIntrinsic found for each extern's name, or null if it's not an intrinsic.
+  std::unordered_map<Name*, const IntrinsicLowering*, AddressHasher<Name*>> intrinsicsByName;
+  // Functions that can't free a mutable object, see findNonFreeingFunctions.
+  std::unordered_set<std::string> nonFreeingFunctionNames;
 
   // This is temporary, Valestrom should soon embed mutability and region into the kind for us
   // so we won't have to do this.
@@ -189,6 +211,20 @@ public:
 
   Ref constI64(int64_t x);
   Ref constI32(int32_t x);
+
+  // Runtime-sized arrays' and strings' lengths, and indices into them, are i64 with
+  // --wide-lengths and i32 otherwise. Vale can use either an int or an i64 for these, so we
+  // convert the indices and sizes it gives us, and the lengths we give it.
+  Int* getLengthMT();
+  Reference* getLengthRefMT();
+  LLVMTypeRef getLengthLT();
+  Ref constLength(int64_t x);
+  // Panics if an i64 doesn't fit in an i32 length.
+  Ref intToLength(FunctionState* functionState, LLVMBuilderRef builder, Reference* intMT, Ref intRef);
+  // Panics if the length doesn't fit in an i32.
+  Ref lengthToInt(FunctionState* functionState, LLVMBuilderRef builder, Reference* intMT, Ref lengthRef);
+  // For computing sizes in bytes.
+  LLVMValueRef widenLengthToI64(LLVMBuilderRef builder, LLVMValueRef lengthLE);
   Ref constI1(bool b);
   Ref buildAdd(FunctionState* functionState, LLVMBuilderRef builder, Ref a, Ref b);
   Ref buildMod(FunctionState* functionState, LLVMBuilderRef builder, Ref a, Ref b);
@@ -92,6 +92,10 @@ Prototype* makeValeMainFunction(
           buildPrint(
               globalState, entryBuilder,
               LLVMBuildLoad(entryBuilder, globalState->livenessCheckCounter, "livenessCheckCounter"));
+          buildPrint(globalState, entryBuilder, "\nMut RC adjustments: ");
+          buildPrint(
+              globalState, entryBuilder,
+              LLVMBuildLoad(entryBuilder, globalState->mutRcAdjustCounter, "mutRcAdjustCounter"));
           buildPrint(globalState, entryBuilder, "\n");
         }
         buildFlare(FL(), globalState, functionState, entryBuilder);
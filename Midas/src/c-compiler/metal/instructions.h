@@ -678,14 +678,18 @@ public:
   Expression* sourceExpr;
   Reference* sourceType;
   bool sourceKnownLive;
+  // An int for len(), an i64 for lenI64().
+  Reference* resultType;
 
   ArrayLength(
       Expression* sourceExpr_,
       Reference* sourceType_,
-      bool sourceKnownLive_) :
+      bool sourceKnownLive_,
+      Reference* resultType_) :
       sourceExpr(sourceExpr_),
       sourceType(sourceType_),
-      sourceKnownLive(sourceKnownLive_) {}
+      sourceKnownLive(sourceKnownLive_),
+      resultType(resultType_) {}
 };
 
 
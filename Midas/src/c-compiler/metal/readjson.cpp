@@ -473,7 +473,8 @@ Expression* readExpression(MetalCache* cache, const json& expression) {
     return new ArrayLength(
         readExpression(cache, expression["sourceExpr"]),
         readReference(cache, expression["sourceType"]),
-        expression["sourceKnownLive"]);
+        expression["sourceKnownLive"],
+        readReference(cache, expression["resultType"]));
   } else if (type == "StructToInterfaceUpcast") {
     return new StructToInterfaceUpcast(
         readExpression(cache, expression["sourceExpr"]),
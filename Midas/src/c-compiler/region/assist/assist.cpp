@@ -291,13 +291,11 @@ void Assist::noteWeakableDestroyed(
     ControlBlockPtrLE controlBlockPtrLE) {
   auto rc = kindStructs.getStrongRcFromControlBlockPtr(builder, refM, controlBlockPtrLE);
   auto conditionLE = LLVMBuildICmp(builder, LLVMIntEQ, rc, constI32LE(globalState, 0), "assertCondition");
-  buildIf(
+  buildColdIf(
       globalState, functionState, builder, isZeroLE(builder, conditionLE),
       [this](LLVMBuilderRef thenBuilder) {
-        buildPrint(globalState, thenBuilder, "Error: Dangling pointers detected!");
         // See MPESC for status codes
-        auto exitCodeIntLE = LLVMConstInt(LLVMInt64TypeInContext(globalState->context), 1, false);
-        LLVMBuildCall(thenBuilder, globalState->externs->exit, &exitCodeIntLE, 1, "");
+        buildFail(globalState, thenBuilder, "Error: Dangling pointers detected!", 1);
       });
 
   if (auto structKindM = dynamic_cast<StructKind*>(refM->kind)) {
@@ -730,7 +728,7 @@ Ref Assist::storeElementInRSA(
   auto arrayElementsPtrLE = getRuntimeSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   buildFlare(FL(), globalState, functionState, builder);
   return ::swapElement(
-      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, globalState->getLengthMT(), sizeRef, arrayElementsPtrLE, indexRef, elementRef);
 }
 
 Ref Assist::upcast(
@@ -910,7 +908,7 @@ void Assist::initializeElementInRSA(
   auto sizeRef = ::getRuntimeSizedArrayLength(globalState, functionState, builder, arrayWrapperPtrLE);
   auto arrayElementsPtrLE = getRuntimeSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   ::initializeElement(
-      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, globalState->getLengthMT(), sizeRef, arrayElementsPtrLE, indexRef, elementRef);
 }
 
 Ref Assist::deinitializeElementFromRSA(
@@ -941,7 +939,7 @@ void Assist::initializeElementInSSA(
   auto sizeRef = globalState->constI32(ssaDef->size);
   auto arrayElementsPtrLE = getStaticSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   ::initializeElement(
-      globalState, functionState, builder, ssaRefMT->location, ssaDef->rawArray->elementType, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+      globalState, functionState, builder, ssaRefMT->location, ssaDef->rawArray->elementType, globalState->metalCache->i32, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
 }
 
 Ref Assist::deinitializeElementFromSSA(
@@ -7,6 +7,7 @@
 #include <utils/counters.h>
 #include <function/expressions/shared/elements.h>
 #include <utils/branch.h>
+#include <utils/aliasing.h>
 #include <function/expressions/shared/string.h>
 #include "common.h"
 
@@ -108,17 +109,20 @@ LoadResult loadInnerInnerStructMember(
           builder,
           ptrToMemberLE,
           memberName.c_str());
+  addMemberTbaaTag(globalState, result, LLVMGetElementType(LLVMTypeOf(innerStructPtrLE)), memberIndex);
   return LoadResult{wrap(globalState->getRegion(expectedType), expectedType, result)};
 }
 
 void storeInnerInnerStructMember(
-    LLVMBuilderRef builder, LLVMValueRef innerStructPtrLE, int memberIndex, std::string memberName, LLVMValueRef newValueLE) {
+    GlobalState* globalState, LLVMBuilderRef builder, LLVMValueRef innerStructPtrLE, int memberIndex, std::string memberName, LLVMValueRef newValueLE) {
   assert(LLVMGetTypeKind(LLVMTypeOf(innerStructPtrLE)) == LLVMPointerTypeKind);
-  LLVMBuildStore(
-      builder,
-      newValueLE,
-      LLVMBuildStructGEP(
-          builder, innerStructPtrLE, memberIndex, memberName.c_str()));
+  auto storeLE =
+      LLVMBuildStore(
+          builder,
+          newValueLE,
+          LLVMBuildStructGEP(
+              builder, innerStructPtrLE, memberIndex, memberName.c_str()));
+  addMemberTbaaTag(globalState, storeLE, LLVMGetElementType(LLVMTypeOf(innerStructPtrLE)), memberIndex);
 }
 
 LLVMValueRef getItablePtrFromInterfacePtr(
@@ -195,7 +199,7 @@ LoadResult loadElementFromSSAInner(
           LLVMConstInt(LLVMInt32TypeInContext(globalState->context), size, false));
   buildFlare(FL(), globalState, functionState, builder);
   return loadElement(
-      globalState, functionState, builder, arrayElementsPtrLE, elementType, sizeRef, indexRef);
+      globalState, functionState, builder, arrayElementsPtrLE, elementType, globalState->metalCache->i32, sizeRef, indexRef);
 }
 
 // Checks that the generation is <= to the actual one.
@@ -330,7 +334,9 @@ void innerDeallocateYonder(
         "");
   }
 
-  callFree(globalState, builder, controlBlockPtrLE.refLE);
+  if (!functionState->deallocatingFromStack) {
+    callFree(globalState, builder, controlBlockPtrLE.refLE);
+  }
 
   if (globalState->opt->census) {
     adjustCounter(globalState, builder, globalState->metalCache->i64, globalState->liveHeapObjCounter, -1);
@@ -389,13 +395,16 @@ void fillRuntimeSizedArray(
     Ref rsaRef) {
 
   intRangeLoop(
-      globalState, functionState, builder, sizeLE,
+      globalState, functionState, builder, globalState->getLengthMT(), sizeLE,
       [globalState, functionState, rsaRefMT, rsaMT, generatorMethod, generatorType, rsaRef, generatorLE](
           Ref indexRef, LLVMBuilderRef bodyBuilder) {
         globalState->getRegion(generatorType)->alias(
             AFL("ConstructRSA generate iteration"),
             functionState, bodyBuilder, generatorType, generatorLE);
-        std::vector<Ref> argExprsLE = { generatorLE, indexRef };
+        // The generator takes the same kind of int that the size was, so this always fits.
+        auto intIndexRef =
+            globalState->lengthToInt(functionState, bodyBuilder, generatorMethod->params[1], indexRef);
+        std::vector<Ref> argExprsLE = { generatorLE, intIndexRef };
 
         auto elementRef =
             buildCall(
@@ -419,7 +428,7 @@ void fillStaticSizedArrayFromCallable(
     Ref ssaRef) {
 
   intRangeLoop(
-      globalState, functionState, builder, sizeLE,
+      globalState, functionState, builder, globalState->metalCache->i32, sizeLE,
       [globalState, functionState, ssaRefMT, ssaMT, generatorMethod, generatorType, ssaRef, generatorLE](
           Ref indexRef, LLVMBuilderRef bodyBuilder) {
         globalState->getRegion(generatorType)->alias(
@@ -453,15 +462,29 @@ LLVMValueRef callMalloc(
   }
 }
 
+// Like callMalloc, but in a function that unserializes into a slab, takes the bytes from the slab.
+static LLVMValueRef callMallocOrSlabMalloc(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    LLVMValueRef sizeLE) {
+  if (functionState && functionState->slabOffsetPtrLE) {
+    std::vector<LLVMValueRef> argsLE = { sizeLE, functionState->slabOffsetPtrLE };
+    return LLVMBuildCall(builder, globalState->externs->slabMalloc, argsLE.data(), argsLE.size(), "");
+  } else {
+    return callMalloc(globalState, builder, sizeLE);
+  }
+}
+
 WrapperPtrLE mallocStr(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
-    LLVMValueRef lenI32LE,
+    LLVMValueRef lengthLE,
     LLVMValueRef sourceCharsPtrLE,
     KindStructs* kindStructs,
     std::function<void(LLVMBuilderRef builder, ControlBlockPtrLE controlBlockPtrLE)> fillControlBlock) {
-  auto lenI64LE = LLVMBuildZExt(builder, lenI32LE, LLVMInt64TypeInContext(globalState->context), "lenAsI64");
+  auto lenI64LE = globalState->widenLengthToI64(builder, lengthLE);
   // The +1 is for the null terminator at the end, for C compatibility.
   auto sizeBytesLE =
       LLVMBuildAdd(
@@ -474,7 +497,7 @@ WrapperPtrLE mallocStr(
               "lenPlus1"),
           "strMallocSizeBytes");
 
-  auto destCharPtrLE =callMalloc(globalState, builder, sizeBytesLE);
+  auto destCharPtrLE = callMallocOrSlabMalloc(globalState, functionState, builder, sizeBytesLE);
 
   if (globalState->opt->census) {
     adjustCounter(globalState, builder, globalState->metalCache->i64, globalState->liveHeapObjCounter, 1);
@@ -497,10 +520,10 @@ WrapperPtrLE mallocStr(
   fillControlBlock(
       builder,
       kindStructs->getConcreteControlBlockPtr(FL(), functionState, builder, globalState->metalCache->strRef, newStrWrapperPtrLE));
-  assert(LLVMTypeOf(lenI32LE) == LLVMInt32TypeInContext(globalState->context));
+  assert(LLVMTypeOf(lengthLE) == globalState->getLengthLT());
   LLVMBuildStore(
       builder,
-      lenI32LE,
+      lengthLE,
       getLenPtrFromStrWrapperPtr(builder, newStrWrapperPtrLE));
 
   // Set the null terminating character to the 0th spot and the end spot, just to guard against bugs
@@ -510,7 +533,7 @@ WrapperPtrLE mallocStr(
   std::vector<LLVMValueRef> strncpyArgsLE = { charsBeginPtr, sourceCharsPtrLE, lenI64LE };
   LLVMBuildCall(builder, globalState->externs->strncpy, strncpyArgsLE.data(), strncpyArgsLE.size(), "");
 
-  auto charsEndPtr = LLVMBuildGEP(builder, charsBeginPtr, &lenI32LE, 1, "charsEndPtr");
+  auto charsEndPtr = LLVMBuildGEP(builder, charsBeginPtr, &lengthLE, 1, "charsEndPtr");
   LLVMBuildStore(builder, constI8LE(globalState, 0), charsEndPtr);
 
   // The caller still needs to initialize the actual chars inside!
@@ -531,11 +554,14 @@ LLVMValueRef mallocKnownSize(
   LLVMValueRef resultPtrLE = nullptr;
   if (location == Location::INLINE) {
     resultPtrLE = makeMidasLocal(functionState, builder, kindLT, "newstruct", LLVMGetUndef(kindLT));
+  } else if (location == Location::YONDER && functionState && functionState->allocatingOnStack) {
+    // Zero it so the control block (such as the generation) starts out defined.
+    resultPtrLE = makeMidasLocal(functionState, builder, kindLT, "stackstruct", LLVMConstNull(kindLT));
   } else if (location == Location::YONDER) {
     size_t sizeBytes = LLVMABISizeOfType(globalState->dataLayout, kindLT);
     LLVMValueRef sizeLE = LLVMConstInt(LLVMInt64TypeInContext(globalState->context), sizeBytes, false);
 
-    auto newStructLE = callMalloc(globalState, builder, sizeLE);
+    auto newStructLE = callMallocOrSlabMalloc(globalState, functionState, builder, sizeLE);
 
     resultPtrLE =
         LLVMBuildBitCast(
@@ -570,7 +596,8 @@ void fillInnerStruct(
     auto memberLE =
         globalState->getRegion(memberType)
             ->checkValidReference(FL(), functionState, builder, structM->members[i]->type, memberRef);
-    LLVMBuildStore(builder, memberLE, ptrLE);
+    auto storeLE = LLVMBuildStore(builder, memberLE, ptrLE);
+    addMemberTbaaTag(globalState, storeLE, LLVMGetElementType(LLVMTypeOf(innerStructPtrLE)), i);
   }
 }
 
@@ -717,11 +744,12 @@ Ref transmuteWeakRef(
 
 LLVMValueRef mallocRuntimeSizedArray(
     GlobalState* globalState,
+    FunctionState* functionState,
     LLVMBuilderRef builder,
     LLVMTypeRef rsaWrapperLT,
     LLVMTypeRef rsaElementLT,
-    LLVMValueRef lenI32LE) {
-  auto lenI64LE = LLVMBuildZExt(builder, lenI32LE, LLVMInt64TypeInContext(globalState->context), "lenI16");
+    LLVMValueRef lengthLE) {
+  auto lenI64LE = globalState->widenLengthToI64(builder, lengthLE);
   auto sizeBytesLE =
       LLVMBuildAdd(
           builder,
@@ -733,7 +761,7 @@ LLVMValueRef mallocRuntimeSizedArray(
               ""),
           "rsaMallocSizeBytes");
 
-  auto newWrapperPtrLE = callMalloc(globalState, builder, sizeBytesLE);
+  auto newWrapperPtrLE = callMallocOrSlabMalloc(globalState, functionState, builder, sizeBytesLE);
 
   if (globalState->opt->census) {
     adjustCounter(globalState, builder, globalState->metalCache->i64, globalState->liveHeapObjCounter, 1);
@@ -776,8 +804,8 @@ Ref getRuntimeSizedArrayLength(
     LLVMBuilderRef builder,
     WrapperPtrLE arrayRefLE) {
   auto lengthPtrLE = getRuntimeSizedArrayLengthPtr(globalState, builder, arrayRefLE);
-  auto intLE = LLVMBuildLoad(builder, lengthPtrLE, "rsaLen");
-  return wrap(globalState->getRegion(globalState->metalCache->i32Ref), globalState->metalCache->i32Ref, intLE);
+  auto lengthLE = LLVMBuildLoad(builder, lengthPtrLE, "rsaLen");
+  return wrap(globalState->getRegion(globalState->getLengthRefMT()), globalState->getLengthRefMT(), lengthLE);
 }
 
 ControlBlock makeAssistAndNaiveRCNonWeakableControlBlock(GlobalState* globalState) {
@@ -1188,7 +1216,7 @@ LoadResult regularLoadElementFromRSAWithoutUpgrade(
               globalState->getRegion(rsaRefMT)->checkValidReference(FL(), functionState, builder, rsaRefMT, arrayRef)));
   buildFlare(FL(), globalState, functionState, builder);
   return loadElement(
-      globalState, functionState, builder, arrayElementsPtrLE, elementType, sizeRef, indexRef);
+      globalState, functionState, builder, arrayElementsPtrLE, elementType, globalState->getLengthMT(), sizeRef, indexRef);
 }
 
 LoadResult resilientLoadElementFromRSAWithoutUpgrade(
@@ -1218,7 +1246,7 @@ LoadResult resilientLoadElementFromRSAWithoutUpgrade(
                   arrayRef)));
       buildFlare(FL(), globalState, functionState, builder);
       return loadElement(
-          globalState, functionState, builder, arrayElementsPtrLE, elementType, sizeRef, indexRef);
+          globalState, functionState, builder, arrayElementsPtrLE, elementType, globalState->getLengthMT(), sizeRef, indexRef);
     }
     case Ownership::BORROW: {
       auto wrapperPtrLE =
@@ -1232,7 +1260,7 @@ LoadResult resilientLoadElementFromRSAWithoutUpgrade(
       buildFlare(FL(), globalState, functionState, builder);
       return loadElement(
           globalState, functionState, builder, arrayElementsPtrLE, elementType,
-          sizeRef, indexRef);
+          globalState->getLengthMT(), sizeRef, indexRef);
     }
     case Ownership::WEAK:
       assert(false); // VIR never loads from a weak ref
@@ -1261,7 +1289,7 @@ Ref regularStoreElementInSSA(
   buildFlare(FL(), globalState, functionState, builder);
   return swapElement(
       globalState, functionState, builder, ssaRefMT->location,
-      elementType, globalState->constI32(size), arrayElementsPtrLE, indexRef, elementRef);
+      elementType, globalState->metalCache->i32, globalState->constI32(size), arrayElementsPtrLE, indexRef, elementRef);
 }
 
 void regularInitializeElementInSSA(
@@ -1284,7 +1312,7 @@ void regularInitializeElementInSSA(
   buildFlare(FL(), globalState, functionState, builder);
   initializeElement(
       globalState, functionState, builder, ssaRefMT->location,
-      elementType, globalState->constI32(size), arrayElementsPtrLE, indexRef, elementRef);
+      elementType, globalState->metalCache->i32, globalState->constI32(size), arrayElementsPtrLE, indexRef, elementRef);
 }
 
 Ref constructRuntimeSizedArray(
@@ -1303,9 +1331,9 @@ Ref constructRuntimeSizedArray(
   buildFlare(FL(), globalState, functionState, builder, "Constructing RSA!");
 
   auto sizeLE =
-      globalState->getRegion(globalState->metalCache->i32Ref)->checkValidReference(FL(),
-          functionState, builder, globalState->metalCache->i32Ref, sizeRef);
-  auto ptrLE = mallocRuntimeSizedArray(globalState, builder, rsaWrapperPtrLT, rsaElementLT, sizeLE);
+      globalState->getRegion(globalState->getLengthRefMT())->checkValidReference(FL(),
+          functionState, builder, globalState->getLengthRefMT(), sizeRef);
+  auto ptrLE = mallocRuntimeSizedArray(globalState, functionState, builder, rsaWrapperPtrLT, rsaElementLT, sizeLE);
   auto rsaWrapperPtrLE =
       kindStructs->makeWrapperPtr(FL(), functionState, builder, rsaMT, ptrLE);
   fillControlBlock(
@@ -1738,7 +1766,7 @@ void storeMemberStrong(
           globalState->getRegion(structRefMT)->checkValidReference(
               FL(), functionState, builder, structRefMT, structRef));
   innerStructPtrLE = kindStructs->getStructContentsPtr(builder, structRefMT->kind, wrapperPtrLE);
-  storeInnerInnerStructMember(builder, innerStructPtrLE, memberIndex, memberName, newValueLE);
+  storeInnerInnerStructMember(globalState, builder, innerStructPtrLE, memberIndex, memberName, newValueLE);
 }
 
 void storeMemberWeak(
@@ -1757,7 +1785,7 @@ void storeMemberWeak(
       globalState->getRegion(structRefMT)->lockWeakRef(
           FL(), functionState, builder, structRefMT, structRef, structKnownLive);
   innerStructPtrLE = kindStructs->getStructContentsPtr(builder, structRefMT->kind, wrapperPtrLE);
-  storeInnerInnerStructMember(builder, innerStructPtrLE, memberIndex, memberName, newValueLE);
+  storeInnerInnerStructMember(globalState, builder, innerStructPtrLE, memberIndex, memberName, newValueLE);
 }
 
 LLVMValueRef getInterfaceMethodFunctionPtrFromItable(
@@ -1810,7 +1838,7 @@ void initializeElementInRSA(
   auto arrayElementsPtrLE = getRuntimeSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   ::initializeElement(
       globalState, functionState, builder, rsaRefMT->location,
-      rsaDef->rawArray->elementType, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+      rsaDef->rawArray->elementType, globalState->getLengthMT(), sizeRef, arrayElementsPtrLE, indexRef, elementRef);
 }
 
 Ref normalLocalLoad(GlobalState* globalState, FunctionState* functionState, LLVMBuilderRef builder, Local* local, LLVMValueRef localAddr) {
@@ -45,7 +45,7 @@ LoadResult loadInnerInnerStructMember(
   FunctionState* functionState,
     LLVMBuilderRef builder, LLVMValueRef innerStructPtrLE, int memberIndex, Reference* expectedType, std::string memberName);
 void storeInnerInnerStructMember(
-    LLVMBuilderRef builder, LLVMValueRef innerStructPtrLE, int memberIndex, std::string memberName, LLVMValueRef newValueLE);
+    GlobalState* globalState, LLVMBuilderRef builder, LLVMValueRef innerStructPtrLE, int memberIndex, std::string memberName, LLVMValueRef newValueLE);
 
 
 LLVMValueRef getItablePtrFromInterfacePtr(
@@ -220,6 +220,7 @@ Ref transmuteWeakRef(
 
 LLVMValueRef mallocRuntimeSizedArray(
     GlobalState* globalState,
+    FunctionState* functionState,
     LLVMBuilderRef builder,
     LLVMTypeRef rsaWrapperLT,
     LLVMTypeRef rsaElementLT,
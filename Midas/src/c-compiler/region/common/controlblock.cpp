@@ -39,6 +39,9 @@ void ControlBlock::build() {
       case ControlBlockMember::TETHER_32B:
         membersL.push_back(int32LT);
         break;
+      case ControlBlockMember::SLAB_OFFSET_32B:
+        membersL.push_back(int32LT);
+        break;
       case ControlBlockMember::GENERATION_32B:
         assert(membersL.empty()); // Generation should be at the top of the object
         membersL.push_back(int32LT);
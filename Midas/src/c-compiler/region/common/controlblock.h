@@ -23,6 +23,9 @@ enum class ControlBlockMember {
   // It's 32B because we put it in the spot where the generational heap puts its size,
   // like we do with the UNUSED_32B elsewhere.
   TETHER_32B,
+  // Where an object we unserialized into a slab is, relative to the slab. Also in the
+  // generational heap's size spot, so it's not used with that.
+  SLAB_OFFSET_32B,
 };
 
 class ControlBlock {
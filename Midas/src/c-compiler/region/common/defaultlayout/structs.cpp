@@ -35,7 +35,7 @@ KindStructs::KindStructs(
         LLVMStructCreateNamed(
             globalState->context, "__Str");
     std::vector<LLVMTypeRef> memberTypesL;
-    memberTypesL.push_back(LLVMInt32TypeInContext(globalState->context));
+    memberTypesL.push_back(globalState->getLengthLT());
     memberTypesL.push_back(LLVMArrayType(int8LT, 0));
     LLVMStructSetBody(
         stringInnerStructL, memberTypesL.data(), memberTypesL.size(), false);
@@ -360,7 +360,7 @@ void KindStructs::defineRuntimeSizedArray(
 
   elementsL.push_back(weakable == Weakability::WEAKABLE ? weakableControlBlock.getStruct() : nonWeakableControlBlock.getStruct());
 
-  elementsL.push_back(LLVMInt32TypeInContext(globalState->context));
+  elementsL.push_back(globalState->getLengthLT());
 
   elementsL.push_back(innerArrayLT);
 
@@ -622,7 +622,7 @@ LLVMValueRef HybridGenerationalMemory::lockGenFatPtr(
       adjustCounter(globalState, builder, globalState->metalCache->i64, globalState->livenessCheckCounter, 1);
     }
     auto isAliveLE = getIsAliveFromWeakFatPtr(functionState, builder, refM, fatPtrLE, knownLive);
-    buildIf(
+    buildColdIf(
         globalState, functionState, builder, isZeroLE(builder, isAliveLE),
         [this, from, functionState, fatPtrLE](LLVMBuilderRef thenBuilder) {
           if (globalState->opt->regionOverride == RegionOverride::RESILIENT_V3 ||
@@ -308,7 +308,7 @@ LLVMValueRef LgtWeaks::lockLgtiFatPtr(
     // Do nothing
   } else {
     auto isAliveLE = getIsAliveFromWeakFatPtr(functionState, builder, refM, fatPtrLE, knownLive);
-    buildIf(
+    buildColdIf(
         globalState, functionState, builder, isZeroLE(builder, isAliveLE),
         [this, functionState, fatPtrLE](LLVMBuilderRef thenBuilder) {
           //        buildPrintAreaAndFileAndLine(globalState, thenBuilder, from);
@@ -358,7 +358,7 @@ LLVMValueRef LgtWeaks::getNewLgti(
           resultLgtiLE,
           LLVMBuildLoad(builder, getLgtCapacityPtr(builder), "lgtCapacity"),
           "atCapacity");
-  buildIf(
+  buildColdIf(
       globalState, functionState,
       builder,
       atCapacityLE,
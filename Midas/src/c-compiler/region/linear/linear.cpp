@@ -10,6 +10,7 @@
 #include <midasfunctions.h>
 #include "linear.h"
 #include "translatetype.h"
+#include "externs.h"
 #include "region/rcimm/rcimm.h"
 
 Ref unsafeCast(
@@ -59,11 +60,16 @@ LLVMValueRef hexRoundUp(
 //  return LLVMBuildIntToPtr(builder, roundedLoweredRawPointerIntLE, LLVMTypeOf(rawPtrLE), "loweredRoundedRawPtr");
 //}
 
+// The smallest buffer a single-pass serialize will start with, so small messages don't start
+// with a zero-byte buffer before their first retry.
+constexpr uint64_t MIN_SERIALIZE_BUFFER_SIZE = 1024;
+
 Linear::Linear(GlobalState* globalState_)
   : globalState(globalState_),
     structs(globalState_),
     hostKindByValeKind(0, globalState->addressNumberer->makeHasher<Kind*>()),
-    valeKindByHostKind(0, globalState->addressNumberer->makeHasher<Kind*>()) {
+    valeKindByHostKind(0, globalState->addressNumberer->makeHasher<Kind*>()),
+    serializeSizeHintPtrByKind(0, globalState->addressNumberer->makeHasher<Kind*>()) {
 
   regionKind =
       globalState->metalCache->getStructKind(
@@ -79,6 +85,9 @@ Linear::Linear(GlobalState* globalState_)
       LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0),
       // Offset into the destination buffer to write to
       LLVMInt64TypeInContext(globalState->context),
+      // Size of the destination buffer. We don't write anything that would end past this, we just
+      // keep bumping the offset so we know how big the buffer needed to be.
+      LLVMInt64TypeInContext(globalState->context),
 //      // "rootMetadataBytesNeeded", the number of bytes needed after the next thing is serialized, see MAPOWN.
 //      LLVMInt64TypeInContext(globalState->context),
       // Eventually we might want a hash map or something in here, if we want to avoid serialize duplicates
@@ -669,8 +678,8 @@ Ref Linear::getRuntimeSizedArrayLength(
     bool arrayKnownLive) {
   auto arrayRefLE = checkValidReference(FL(), functionState, builder, rsaRefMT, arrayRef);
   auto resultLE = LLVMBuildStructGEP(builder, arrayRefLE, 0, "rsaLenPtr");
-  auto intLE = LLVMBuildLoad(builder, resultLE, "rsaLen");
-  return wrap(globalState->getRegion(globalState->metalCache->i32Ref), globalState->metalCache->i32Ref, intLE);
+  auto lengthLE = LLVMBuildLoad(builder, resultLE, "rsaLen");
+  return wrap(globalState->getRegion(globalState->getLengthRefMT()), globalState->getLengthRefMT(), lengthLE);
 }
 
 LLVMValueRef Linear::checkValidReference(
@@ -750,7 +759,7 @@ LoadResult Linear::loadElementFromRSA(
   auto arrayRefLE = checkValidReference(FL(), functionState, builder, hostRsaRefMT, arrayRef);
   // Size is the first member in the RSA struct.
   auto sizeLE = LLVMBuildLoad(builder, LLVMBuildStructGEP(builder, arrayRefLE, 0, "rsaSizePtr"), "rsaSize");
-  auto sizeRef = wrap(this, globalState->metalCache->i32Ref, sizeLE);
+  auto sizeRef = wrap(this, globalState->getLengthRefMT(), sizeLE);
   // Elements is the 1th member in the RSA struct, after size.
   auto elementsPtrLE = LLVMBuildStructGEP(builder, arrayRefLE, 1, "rsaElemsPtr");
 
@@ -764,7 +773,7 @@ LoadResult Linear::loadElementFromRSA(
   buildFlare(FL(), globalState, functionState, builder);
   return loadElement(
       globalState, functionState, builder, elementsPtrLE,
-      hostElementType, sizeRef, indexRef);
+      hostElementType, globalState->getLengthMT(), sizeRef, indexRef);
 }
 
 
@@ -845,9 +854,12 @@ Ref Linear::innerConstructStaticSizedArray(
   auto ssaRef = getDestinationRef(functionState, builder, regionInstanceRef, ssaRefMT);
   auto ssaPtrLE = checkValidReference(FL(), functionState, builder, ssaRefMT, ssaRef);
 
-  auto dryRunBoolLE = globalState->getRegion(boolMT)->checkValidReference(FL(), functionState, builder, boolMT, dryRunBoolRef);
+//  reserveRootMetadataBytesIfNeeded(functionState, builder, regionInstanceRef);
+  bumpDestinationOffset(functionState, builder, regionInstanceRef, sizeLE); // moved
+
+  auto shouldWriteLE = buildShouldWrite(functionState, builder, regionInstanceRef, dryRunBoolRef);
   buildIf(
-      globalState, functionState, builder, LLVMBuildNot(builder, dryRunBoolLE, "notDryRun"),
+      globalState, functionState, builder, shouldWriteLE,
       [this, functionState, ssaPtrLE, hostSsaMT](LLVMBuilderRef thenBuilder) mutable {
         buildFlare(FL(), globalState, functionState, thenBuilder);
 
@@ -860,9 +872,6 @@ Ref Linear::innerConstructStaticSizedArray(
         // Caller still needs to initialize the elements!
       });
 
-//  reserveRootMetadataBytesIfNeeded(functionState, builder, regionInstanceRef);
-  bumpDestinationOffset(functionState, builder, regionInstanceRef, sizeLE); // moved
-
   buildFlare(FL(), globalState, functionState, builder);
 
   return ssaRef;
@@ -879,13 +888,13 @@ Ref Linear::innerConstructRuntimeSizedArray(
   buildFlare(FL(), globalState, functionState, builder);
 
   auto boolMT = globalState->metalCache->boolRef;
-  auto i32RefMT = globalState->metalCache->i32Ref;
+  auto lengthRefMT = globalState->getLengthRefMT();
 
   assert(rsaRefMT->kind == rsaMT);
   assert(globalState->getRegion(rsaMT) == this);
 
-  auto lenI32LE = globalState->getRegion(i32RefMT)->checkValidReference(FL(), functionState, builder, i32RefMT, sizeRef);
-  auto lenI64LE = LLVMBuildZExt(builder, lenI32LE, LLVMInt64TypeInContext(globalState->context), "");
+  auto lengthLE = globalState->getRegion(lengthRefMT)->checkValidReference(FL(), functionState, builder, lengthRefMT, sizeRef);
+  auto lenI64LE = globalState->widenLengthToI64(builder, lengthLE);
 
   auto sizeLE = predictShallowSize(functionState, builder, true, rsaMT, lenI64LE);
   buildFlare(FL(), globalState, functionState, builder);
@@ -893,14 +902,17 @@ Ref Linear::innerConstructRuntimeSizedArray(
   auto rsaRef = getDestinationRef(functionState, builder, regionInstanceRef, rsaRefMT);
   auto rsaPtrLE = checkValidReference(FL(), functionState, builder, rsaRefMT, rsaRef);
 
-  auto dryRunBoolLE = globalState->getRegion(boolMT)->checkValidReference(FL(), functionState, builder, boolMT, dryRunBoolRef);
+//  reserveRootMetadataBytesIfNeeded(functionState, builder, regionInstanceRef);
+  bumpDestinationOffset(functionState, builder, regionInstanceRef, sizeLE); // moved
+
+  auto shouldWriteLE = buildShouldWrite(functionState, builder, regionInstanceRef, dryRunBoolRef);
   buildIf(
-      globalState, functionState, builder, LLVMBuildNot(builder, dryRunBoolLE, "notDryRun"),
-      [this, functionState, rsaPtrLE, lenI32LE, rsaMT](LLVMBuilderRef thenBuilder) mutable {
+      globalState, functionState, builder, shouldWriteLE,
+      [this, functionState, rsaPtrLE, lengthLE, rsaMT](LLVMBuilderRef thenBuilder) mutable {
         buildFlare(FL(), globalState, functionState, thenBuilder);
 
         auto rsaLT = structs.getRuntimeSizedArrayStruct(rsaMT);
-        auto rsaWithLenVal = LLVMBuildInsertValue(thenBuilder, LLVMGetUndef(rsaLT), lenI32LE, 0, "rsaWithLen");
+        auto rsaWithLenVal = LLVMBuildInsertValue(thenBuilder, LLVMGetUndef(rsaLT), lengthLE, 0, "rsaWithLen");
         LLVMBuildStore(thenBuilder, rsaWithLenVal, rsaPtrLE);
 
         buildFlare(FL(), globalState, functionState, thenBuilder);
@@ -908,9 +920,6 @@ Ref Linear::innerConstructRuntimeSizedArray(
         // Caller still needs to initialize the elements!
       });
 
-//  reserveRootMetadataBytesIfNeeded(functionState, builder, regionInstanceRef);
-  bumpDestinationOffset(functionState, builder, regionInstanceRef, sizeLE); // moved
-
   buildFlare(FL(), globalState, functionState, builder);
 
   return rsaRef;
@@ -929,14 +938,14 @@ Ref Linear::innerMallocStr(
     Ref regionInstanceRef,
     FunctionState* functionState,
     LLVMBuilderRef builder,
-    LLVMValueRef lenI32LE,
+    LLVMValueRef lengthLE,
     LLVMValueRef sourceCharsPtrLE,
     Ref dryRunBoolRef) {
   auto boolMT = globalState->metalCache->boolRef;
 
-  auto lenI64LE = LLVMBuildZExt(builder, lenI32LE, LLVMInt64TypeInContext(globalState->context), "");
+  auto lenI64LE = globalState->widenLengthToI64(builder, lengthLE);
 
-  auto sizeLE = predictShallowSize(functionState, builder, true, linearStr, lenI32LE);
+  auto sizeLE = predictShallowSize(functionState, builder, true, linearStr, lenI64LE);
   buildFlare(FL(), globalState, functionState, builder);
 
   buildFlare(FL(), globalState, functionState, builder, "bumping by size: ", lenI64LE);
@@ -944,12 +953,13 @@ Ref Linear::innerMallocStr(
   auto strRef = getDestinationRef(functionState, builder, regionInstanceRef, linearStrRefMT);
   auto strPtrLE = checkValidReference(FL(), functionState, builder, linearStrRefMT, strRef);
 
-  auto dryRunBoolLE = globalState->getRegion(boolMT)->checkValidReference(FL(), functionState, builder, boolMT, dryRunBoolRef);
+  bumpDestinationOffset(functionState, builder, regionInstanceRef, sizeLE); // moved
 
+  auto shouldWriteLE = buildShouldWrite(functionState, builder, regionInstanceRef, dryRunBoolRef);
   buildIf(
-      globalState, functionState, builder, LLVMBuildNot(builder, dryRunBoolLE, "notDryRun"),
-      [this, functionState, strPtrLE, lenI32LE, lenI64LE, strRef, sourceCharsPtrLE](LLVMBuilderRef thenBuilder) mutable {
-        auto strWithLenValLE = LLVMBuildInsertValue(thenBuilder, LLVMGetUndef(structs.getStringStruct()), lenI32LE, 0, "strWithLen");
+      globalState, functionState, builder, shouldWriteLE,
+      [this, functionState, strPtrLE, lengthLE, lenI64LE, strRef, sourceCharsPtrLE](LLVMBuilderRef thenBuilder) mutable {
+        auto strWithLenValLE = LLVMBuildInsertValue(thenBuilder, LLVMGetUndef(structs.getStringStruct()), lengthLE, 0, "strWithLen");
         LLVMBuildStore(thenBuilder, strWithLenValLE, strPtrLE);
 
         buildFlare(FL(), globalState, functionState, thenBuilder, "length for str: ", lenI64LE);
@@ -973,8 +983,6 @@ Ref Linear::innerMallocStr(
         return strRef;
       });
 
-  bumpDestinationOffset(functionState, builder, regionInstanceRef, sizeLE); // moved
-
   return strRef;
 }
 
@@ -1086,6 +1094,38 @@ std::string Linear::getExportName(Package* currentPackage, Reference* hostRefMT,
   }
 }
 
+std::string Linear::getLentToExternsDefC(const std::string& name, Kind* valeKind) {
+  bool lentInPlace = globalState->opt->zeroCopyExterns && globalState->rcImm->canLendToExtern(valeKind);
+  if (!lentInPlace && !globalState->rcImm->memoizesExternSerialize(valeKind)) {
+    return "";
+  }
+  std::stringstream s;
+  s << "// Externs get these lent to them, they're only valid until the extern returns." << std::endl;
+  s << "// Don't free them." << std::endl;
+  s << "#define " << name << "_LENT_TO_EXTERNS 1" << std::endl;
+  return s.str();
+}
+
+std::string Linear::getSnapshotDefC(const std::string& name, Kind* valeKind) {
+  bool isSnapshotRoot = false;
+  for (auto[packageCoord, package] : globalState->program->packages) {
+    for (auto[externName, prototype] : package->externNameToFunction) {
+      if ((isSnapshotSaveExtern(prototype) && prototype->params.size() == 2 &&
+              prototype->params[1]->kind == valeKind) ||
+          (isSnapshotLoadExtern(prototype) && prototype->returnType->kind == valeKind)) {
+        isSnapshotRoot = true;
+      }
+    }
+  }
+  if (!isSnapshotRoot) {
+    return "";
+  }
+  std::stringstream s;
+  s << "// Pass this to __vale_snapshotMap to map a snapshot of this type in place." << std::endl;
+  s << "#define " << name << "_SNAPSHOT_TYPE_HASH 0x" << std::hex << getSnapshotTypeHash(valeKind) << "ULL" << std::endl;
+  return s.str();
+}
+
 std::string Linear::generateStructDefsC(
     Package* currentPackage,
     StructDefinition* structDefM) {
@@ -1099,6 +1139,8 @@ std::string Linear::generateStructDefsC(
     s << "  " << getExportName(currentPackage, hostRefMT, true) << " " << member->name << ";" << std::endl;
   }
   s << "} " << name << ";" << std::endl;
+  s << getLentToExternsDefC(name, structDefM->kind);
+  s << getSnapshotDefC(name, structDefM->kind);
   return s.str();
 }
 
@@ -1129,6 +1171,7 @@ std::string Linear::generateInterfaceDefsC(
   s << "typedef struct " << interfaceName << " {" << std::endl;
   s << "void* obj; uint64_t type;" << std::endl;
   s << "} " << interfaceName << ";" << std::endl;
+  s << getSnapshotDefC(interfaceName, interfaceDefM->kind);
 
   return s.str();
 }
@@ -1143,9 +1186,11 @@ std::string Linear::generateRuntimeSizedArrayDefsC(
 
   std::stringstream s;
   s << "typedef struct " << rsaName << " {" << std::endl;
-  s << "  uint32_t length;" << std::endl;
+  s << "  ValeLength length;" << std::endl;
   s << "  " << getExportName(currentPackage, hostMemberRefMT, true) << " elements[0];" << std::endl;
   s << "} " << rsaName << ";" << std::endl;
+  s << getLentToExternsDefC(rsaName, rsaDefM->kind);
+  s << getSnapshotDefC(rsaName, rsaDefM->kind);
   return s.str();
 }
 
@@ -1163,6 +1208,8 @@ std::string Linear::generateStaticSizedArrayDefsC(
   s << "typedef struct " << rsaName << " {" << std::endl;
   s << "  " << getExportName(currentPackage, hostMemberRefMT, true) << " elements[" << ssaDefM->size << "];" << std::endl;
   s << "} " << rsaName << ";" << std::endl;
+  s << getLentToExternsDefC(rsaName, ssaDefM->kind);
+  s << getSnapshotDefC(rsaName, ssaDefM->kind);
   return s.str();
 }
 
@@ -1182,6 +1229,10 @@ std::pair<Ref, Ref> Linear::topLevelSerialize(
 //  auto startMetadataSize =
 //      LLVMABISizeOfType(globalState->dataLayout, structs.getStructStruct(startMetadataKind));
 
+  if (globalState->opt->singlePassSerialize) {
+    return topLevelSerializeSinglePass(functionState, builder, valeKind, ref);
+  }
+
   auto valeRefMT =
       globalState->metalCache->getReference(
           Ownership::SHARE, Location::YONDER, valeKind);
@@ -1195,11 +1246,12 @@ std::pair<Ref, Ref> Linear::topLevelSerialize(
   auto dryRunInitialRegionStructLE = LLVMGetUndef(regionLT);
   dryRunInitialRegionStructLE = LLVMBuildInsertValue(builder, dryRunInitialRegionStructLE, nullLT, 0, "regionStruct");
   dryRunInitialRegionStructLE = LLVMBuildInsertValue(builder, dryRunInitialRegionStructLE, dryRunCounterBeginLE, 1, "regionStruct");
+  dryRunInitialRegionStructLE = LLVMBuildInsertValue(builder, dryRunInitialRegionStructLE, constI64LE(globalState, 0), 2, "regionStruct");
 //  dryRunInitialRegionStructLE = LLVMBuildInsertValue(builder, dryRunInitialRegionStructLE, constI64LE(globalState, rootMetadataSize), 2, "regionStruct");
   auto dryRunRegionInstancePtrLE = makeMidasLocal(functionState, builder, regionLT, "region", dryRunInitialRegionStructLE);
   auto dryRunRegionInstanceRef = wrap(this, regionRefMT, dryRunRegionInstancePtrLE);
 
-  callSerialize(functionState, builder, valeKind, dryRunRegionInstanceRef, ref, globalState->constI1(true));
+  callSerializeRoot(functionState, builder, valeKind, dryRunRegionInstanceRef, ref, globalState->constI1(true));
 
 //  // Reserve some space for the beginning metadata block
 //  bumpDestinationOffset(functionState, builder, dryRunRegionInstanceRef, constI64LE(globalState, startMetadataSize));
@@ -1214,6 +1266,7 @@ std::pair<Ref, Ref> Linear::topLevelSerialize(
   auto initialRegionStructLE = LLVMGetUndef(regionLT);
   initialRegionStructLE = LLVMBuildInsertValue(builder, initialRegionStructLE, bufferBeginPtrLE, 0, "regionStruct");
   initialRegionStructLE = LLVMBuildInsertValue(builder, initialRegionStructLE, constI64LE(globalState, 0), 1, "regionStruct");
+  initialRegionStructLE = LLVMBuildInsertValue(builder, initialRegionStructLE, sizeIntLE, 2, "regionStruct");
 //  initialRegionStructLE = LLVMBuildInsertValue(builder, initialRegionStructLE, constI64LE(globalState, rootMetadataSize), 2, "regionStruct");
   auto regionInstancePtrLE = makeMidasLocal(functionState, builder, regionLT, "region", initialRegionStructLE);
   auto regionInstanceRef = wrap(this, regionRefMT, regionInstancePtrLE);
@@ -1228,7 +1281,7 @@ std::pair<Ref, Ref> Linear::topLevelSerialize(
 //          "trailingBeginPtrPtr");
 
   auto resultRef =
-      callSerialize(
+      callSerializeRoot(
           functionState, builder, valeKind, regionInstanceRef, ref, globalState->constI1(false));
 
   auto rootObjectPtrLE =
@@ -1268,13 +1321,302 @@ std::pair<Ref, Ref> Linear::topLevelSerialize(
 
   auto sizeRef =
       wrap(
-          globalState->getRegion(globalState->metalCache->i32Ref),
-          globalState->metalCache->i32Ref,
-          LLVMBuildTrunc(builder, sizeIntLE, LLVMInt32TypeInContext(globalState->context), "truncd"));
+          globalState->getRegion(globalState->getLengthRefMT()),
+          globalState->getLengthRefMT(),
+          LLVMBuildTrunc(builder, sizeIntLE, globalState->getLengthLT(), "truncd"));
 
   return std::make_pair(resultRef, sizeRef);
 }
 
+Ref Linear::makeRegionInstance(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    LLVMValueRef bufferBeginPtrLE,
+    LLVMValueRef capacityIntLE) {
+  auto regionLT = structs.getStructStruct(regionKind);
+  auto regionStructLE = LLVMGetUndef(regionLT);
+  regionStructLE = LLVMBuildInsertValue(builder, regionStructLE, bufferBeginPtrLE, 0, "regionStruct");
+  regionStructLE = LLVMBuildInsertValue(builder, regionStructLE, constI64LE(globalState, 0), 1, "regionStruct");
+  regionStructLE = LLVMBuildInsertValue(builder, regionStructLE, capacityIntLE, 2, "regionStruct");
+  auto regionInstancePtrLE = makeMidasLocal(functionState, builder, regionLT, "region", regionStructLE);
+  return wrap(this, regionRefMT, regionInstancePtrLE);
+}
+
+LLVMValueRef Linear::getSerializeSizeHintPtr(Kind* valeKind) {
+  auto iter = serializeSizeHintPtrByKind.find(valeKind);
+  if (iter != serializeSizeHintPtrByKind.end()) {
+    return iter->second;
+  }
+  auto int64LT = LLVMInt64TypeInContext(globalState->context);
+  auto name = namePrefix + "_serializeSizeHint_" + std::to_string(serializeSizeHintPtrByKind.size());
+  auto sizeHintPtrLE = LLVMAddGlobal(globalState->mod, int64LT, name.c_str());
+  LLVMSetInitializer(sizeHintPtrLE, LLVMConstInt(int64LT, 0, false));
+  LLVMSetLinkage(sizeHintPtrLE, LLVMPrivateLinkage);
+  serializeSizeHintPtrByKind.emplace(valeKind, sizeHintPtrLE);
+  return sizeHintPtrLE;
+}
+
+std::pair<Ref, Ref> Linear::topLevelSerializeSinglePass(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Kind* valeKind,
+    Ref ref) {
+  auto valeRefMT =
+      globalState->metalCache->getReference(
+          Ownership::SHARE, Location::YONDER, valeKind);
+  auto hostRefMT = linearizeReference(valeRefMT);
+
+  // Start with a buffer as big as the biggest one this kind has needed so far.
+  auto sizeHintPtrLE = getSerializeSizeHintPtr(valeKind);
+  auto sizeHintLE = LLVMBuildLoad(builder, sizeHintPtrLE, "sizeHint");
+  auto minCapacityLE = constI64LE(globalState, MIN_SERIALIZE_BUFFER_SIZE);
+  auto capacityIntLE =
+      LLVMBuildSelect(
+          builder,
+          LLVMBuildICmp(builder, LLVMIntULT, sizeHintLE, minCapacityLE, "hintTooSmall"),
+          minCapacityLE,
+          sizeHintLE,
+          "capacity");
+  auto bufferBeginPtrLE = callMalloc(globalState, builder, capacityIntLE);
+  auto regionInstanceRef = makeRegionInstance(functionState, builder, bufferBeginPtrLE, capacityIntLE);
+  auto regionInstancePtrLE =
+      checkValidReference(FL(), functionState, builder, regionRefMT, regionInstanceRef);
+
+  auto firstResultRef =
+      callSerializeRoot(
+          functionState, builder, valeKind, regionInstanceRef, ref, globalState->constI1(false));
+  auto resultPtrLE =
+      makeMidasLocal(
+          functionState, builder, translateType(hostRefMT), "serialized",
+          checkValidReference(FL(), functionState, builder, hostRefMT, firstResultRef));
+
+  // Anything that didn't fit wasn't written, but the offset kept counting, so now we know exactly
+  // how big the buffer has to be. Throw this one away and do it again.
+  auto sizeIntLE = getDestinationOffset(builder, regionInstancePtrLE);
+  auto overflowedLE = LLVMBuildICmp(builder, LLVMIntUGT, sizeIntLE, capacityIntLE, "overflowed");
+  buildColdIf(
+      globalState, functionState, builder, overflowedLE,
+      [this, functionState, valeKind, ref, hostRefMT, bufferBeginPtrLE, sizeHintPtrLE, sizeIntLE, resultPtrLE](
+          LLVMBuilderRef thenBuilder) {
+        callFree(globalState, thenBuilder, bufferBeginPtrLE);
+        LLVMBuildStore(thenBuilder, sizeIntLE, sizeHintPtrLE);
+
+        auto retryBufferBeginPtrLE = callMalloc(globalState, thenBuilder, sizeIntLE);
+        auto retryRegionInstanceRef =
+            makeRegionInstance(functionState, thenBuilder, retryBufferBeginPtrLE, sizeIntLE);
+        auto retryResultRef =
+            callSerializeRoot(
+                functionState, thenBuilder, valeKind, retryRegionInstanceRef, ref, globalState->constI1(false));
+        LLVMBuildStore(
+            thenBuilder,
+            checkValidReference(FL(), functionState, thenBuilder, hostRefMT, retryResultRef),
+            resultPtrLE);
+
+        auto retryRegionInstancePtrLE =
+            checkValidReference(FL(), functionState, thenBuilder, regionRefMT, retryRegionInstanceRef);
+        auto retrySizeIntLE = getDestinationOffset(thenBuilder, retryRegionInstancePtrLE);
+        auto condLE = LLVMBuildICmp(thenBuilder, LLVMIntEQ, retrySizeIntLE, sizeIntLE, "cond");
+        buildAssert(globalState, functionState, thenBuilder, condLE, "Serialization size mismatch!");
+      });
+
+  auto resultRef = wrap(this, hostRefMT, LLVMBuildLoad(builder, resultPtrLE, "serialized"));
+  auto sizeRef =
+      wrap(
+          globalState->getRegion(globalState->getLengthRefMT()),
+          globalState->getLengthRefMT(),
+          LLVMBuildTrunc(builder, sizeIntLE, globalState->getLengthLT(), "truncd"));
+
+  return std::make_pair(resultRef, sizeRef);
+}
+
+LLVMValueRef Linear::saveSnapshot(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Kind* valeKind,
+    Ref ref,
+    LLVMValueRef pathCharsPtrLE) {
+  auto int1LT = LLVMInt1TypeInContext(globalState->context);
+  auto int8PtrLT = LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0);
+  auto valeRefMT =
+      globalState->metalCache->getReference(
+          Ownership::SHARE, Location::YONDER, valeKind);
+  auto hostRefMT = linearizeReference(valeRefMT);
+  auto typeHashLE = constI64LE(globalState, getSnapshotTypeHash(valeKind));
+
+  // The buffer has to be exactly where the snapshot will be mapped, so we can't grow it if it turns
+  // out too small. Measure first.
+  auto dryRunRegionInstanceRef =
+      makeRegionInstance(functionState, builder, LLVMConstNull(int8PtrLT), constI64LE(globalState, 0));
+  callSerializeRoot(functionState, builder, valeKind, dryRunRegionInstanceRef, ref, globalState->constI1(true));
+  auto dryRunRegionInstancePtrLE =
+      checkValidReference(FL(), functionState, builder, regionRefMT, dryRunRegionInstanceRef);
+  auto sizeIntLE = getDestinationOffset(builder, dryRunRegionInstancePtrLE);
+
+  std::vector<LLVMValueRef> allocateArgsLE = { sizeIntLE, typeHashLE };
+  auto bufferBeginPtrLE =
+      LLVMBuildCall(
+          builder, globalState->externs->snapshotAllocate, allocateArgsLE.data(), allocateArgsLE.size(),
+          "snapshotBuffer");
+  auto savedPtrLE = makeMidasLocal(functionState, builder, int1LT, "savedPtr", LLVMConstInt(int1LT, 0, false));
+  buildIf(
+      globalState, functionState, builder, LLVMBuildIsNotNull(builder, bufferBeginPtrLE, "allocated"),
+      [this, functionState, valeKind, ref, hostRefMT, pathCharsPtrLE, typeHashLE, bufferBeginPtrLE, sizeIntLE,
+          savedPtrLE, int8PtrLT](LLVMBuilderRef thenBuilder) {
+        auto regionInstanceRef = makeRegionInstance(functionState, thenBuilder, bufferBeginPtrLE, sizeIntLE);
+        auto rootRef =
+            callSerializeRoot(
+                functionState, thenBuilder, valeKind, regionInstanceRef, ref, globalState->constI1(false));
+        LLVMValueRef rootPtrLE = nullptr;
+        LLVMValueRef rootTypeLE = constI64LE(globalState, 0);
+        if (dynamic_cast<InterfaceKind*>(valeKind)) {
+          std::tie(rootTypeLE, rootPtrLE) = explodeInterfaceRef(functionState, thenBuilder, hostRefMT, rootRef);
+        } else {
+          rootPtrLE = checkValidReference(FL(), functionState, thenBuilder, hostRefMT, rootRef);
+        }
+        std::vector<LLVMValueRef> writeArgsLE = {
+            pathCharsPtrLE,
+            bufferBeginPtrLE,
+            sizeIntLE,
+            LLVMBuildPointerCast(thenBuilder, rootPtrLE, int8PtrLT, "rootI8Ptr"),
+            rootTypeLE,
+            typeHashLE
+        };
+        auto writtenLE =
+            LLVMBuildCall(
+                thenBuilder, globalState->externs->snapshotWrite, writeArgsLE.data(), writeArgsLE.size(),
+                "written");
+        LLVMBuildStore(
+            thenBuilder,
+            LLVMBuildICmp(thenBuilder, LLVMIntNE, writtenLE, LLVMConstInt(LLVMTypeOf(writtenLE), 0, false), "saved"),
+            savedPtrLE);
+        std::vector<LLVMValueRef> freeArgsLE = { bufferBeginPtrLE, sizeIntLE };
+        LLVMBuildCall(thenBuilder, globalState->externs->snapshotFree, freeArgsLE.data(), freeArgsLE.size(), "");
+      });
+  return LLVMBuildLoad(builder, savedPtrLE, "saved");
+}
+
+Ref Linear::getSnapshotRoot(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Reference* hostRefMT,
+    LLVMValueRef snapshotPtrLE) {
+  auto rootPtrLE = LLVMBuildCall(builder, globalState->externs->snapshotRoot, &snapshotPtrLE, 1, "rootPtr");
+  if (dynamic_cast<InterfaceKind*>(hostRefMT->kind)) {
+    auto rootTypeLE =
+        LLVMBuildCall(builder, globalState->externs->snapshotRootType, &snapshotPtrLE, 1, "rootType");
+    auto interfaceRefLE = LLVMGetUndef(translateType(hostRefMT));
+    interfaceRefLE = LLVMBuildInsertValue(builder, interfaceRefLE, rootPtrLE, 0, "rootRef");
+    interfaceRefLE = LLVMBuildInsertValue(builder, interfaceRefLE, rootTypeLE, 1, "rootRef");
+    return wrap(this, hostRefMT, interfaceRefLE);
+  }
+  return wrap(this, hostRefMT, LLVMBuildPointerCast(builder, rootPtrLE, translateType(hostRefMT), "root"));
+}
+
+// FNV-1a, so a snapshot's hash doesn't depend on which compiler built us.
+static void mixSnapshotHash(uint64_t* hash, const std::string& s) {
+  for (unsigned char c : s) {
+    *hash = (*hash ^ c) * 0x100000001b3ULL;
+  }
+  // Separates this string from the next one.
+  *hash = (*hash ^ 0xFF) * 0x100000001b3ULL;
+}
+
+uint64_t Linear::getSnapshotTypeHash(Kind* valeKind) {
+  std::unordered_set<Kind*, AddressHasher<Kind*>> hashedKinds(
+      0, globalState->addressNumberer->makeHasher<Kind*>());
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  hashSnapshotLayout(valeKind, &hashedKinds, &hash);
+  return hash;
+}
+
+// Must match SNAPSHOT_NUM_SLOTS in snapshot.c.
+static const uint64_t SNAPSHOT_NUM_SLOTS = 64;
+
+void Linear::checkSnapshotSlots() {
+  // For each slot, the hash that's using it and an extern that snapshots that type.
+  std::unordered_map<uint64_t, std::pair<uint64_t, std::string>> slotToHashAndExternName;
+  for (auto[packageCoord, package] : globalState->program->packages) {
+    for (auto[externName, prototype] : package->externNameToFunction) {
+      Kind* rootKind = nullptr;
+      if (isSnapshotSaveExtern(prototype) && prototype->params.size() == 2) {
+        rootKind = prototype->params[1]->kind;
+      } else if (isSnapshotLoadExtern(prototype)) {
+        rootKind = prototype->returnType->kind;
+      } else {
+        continue;
+      }
+      auto hash = getSnapshotTypeHash(rootKind);
+      auto slot = hash % SNAPSHOT_NUM_SLOTS;
+      auto iter = slotToHashAndExternName.emplace(slot, std::make_pair(hash, prototype->name->name)).first;
+      if (iter->second.first != hash) {
+        std::cerr << "Snapshot externs " << iter->second.second << " and " << prototype->name->name
+                  << " have different types that would be mapped at the same address (slot " << slot
+                  << " of " << SNAPSHOT_NUM_SLOTS << "). Renaming either type will move it to another "
+                  << "slot." << std::endl;
+        exit(1);
+      }
+    }
+  }
+}
+
+void Linear::hashSnapshotLayout(
+    Kind* valeKind,
+    std::unordered_set<Kind*, AddressHasher<Kind*>>* hashedKinds,
+    uint64_t* hash) {
+  if (auto innt = dynamic_cast<Int*>(valeKind)) {
+    mixSnapshotHash(hash, "i" + std::to_string(innt->bits));
+  } else if (dynamic_cast<Bool*>(valeKind)) {
+    mixSnapshotHash(hash, "bool");
+  } else if (dynamic_cast<Float*>(valeKind)) {
+    mixSnapshotHash(hash, "float");
+  } else if (dynamic_cast<Str*>(valeKind)) {
+    mixSnapshotHash(hash, "str");
+  } else if (dynamic_cast<Never*>(valeKind)) {
+    mixSnapshotHash(hash, "never");
+  } else if (auto structKind = dynamic_cast<StructKind*>(valeKind)) {
+    mixSnapshotHash(hash, structKind->fullName->name);
+    if (!hashedKinds->insert(valeKind).second) {
+      return;
+    }
+    auto hostStructKind = dynamic_cast<StructKind*>(linearizeKind(structKind));
+    mixSnapshotHash(
+        hash, std::to_string(LLVMABISizeOfType(globalState->dataLayout, structs.getStructStruct(hostStructKind))));
+    for (auto member : globalState->program->getStruct(structKind)->members) {
+      mixSnapshotHash(hash, member->name);
+      mixSnapshotHash(hash, member->type->location == Location::INLINE ? "inl" : "yon");
+      hashSnapshotLayout(member->type->kind, hashedKinds, hash);
+    }
+  } else if (auto interfaceKind = dynamic_cast<InterfaceKind*>(valeKind)) {
+    mixSnapshotHash(hash, interfaceKind->fullName->name);
+    if (!hashedKinds->insert(valeKind).second) {
+      return;
+    }
+    // The order matters too, it decides each substruct's type number.
+    auto hostInterfaceKind = dynamic_cast<InterfaceKind*>(linearizeKind(interfaceKind));
+    for (auto hostStructKind : structs.getOrderedSubstructs(hostInterfaceKind)) {
+      hashSnapshotLayout(valeKindByHostKind.find(hostStructKind)->second, hashedKinds, hash);
+    }
+  } else if (auto ssaMT = dynamic_cast<StaticSizedArrayT*>(valeKind)) {
+    mixSnapshotHash(hash, ssaMT->name->name);
+    if (!hashedKinds->insert(valeKind).second) {
+      return;
+    }
+    auto ssaDefM = globalState->program->getStaticSizedArray(ssaMT);
+    mixSnapshotHash(hash, std::to_string(ssaDefM->size));
+    hashSnapshotLayout(ssaDefM->rawArray->elementType->kind, hashedKinds, hash);
+  } else if (auto rsaMT = dynamic_cast<RuntimeSizedArrayT*>(valeKind)) {
+    mixSnapshotHash(hash, rsaMT->name->name);
+    if (!hashedKinds->insert(valeKind).second) {
+      return;
+    }
+    auto rsaDefM = globalState->program->getRuntimeSizedArray(rsaMT);
+    hashSnapshotLayout(rsaDefM->rawArray->elementType->kind, hashedKinds, hash);
+  } else {
+    std::cerr << "Unimplemented type in snapshots: " << typeid(*valeKind).name() << std::endl;
+    assert(false);
+  }
+}
+
 std::pair<Ref, Ref> Linear::receiveUnencryptedAlienReference(
     FunctionState* functionState,
     LLVMBuilderRef builder,
@@ -1293,16 +1635,16 @@ std::pair<Ref, Ref> Linear::receiveUnencryptedAlienReference(
 
   if (dynamic_cast<Int*>(sourceRefMT->kind)) {
     auto resultRef = wrap(globalState->getRegion(sourceRefMT), targetRefMT, sourceRefLE);
-    auto sizeRef = globalState->constI32(LLVMABISizeOfType(globalState->dataLayout, translateType(targetRefMT)));
+    auto sizeRef = globalState->constLength(LLVMABISizeOfType(globalState->dataLayout, translateType(targetRefMT)));
     return std::make_pair(resultRef, sizeRef);
   } else if (dynamic_cast<Bool*>(sourceRefMT->kind)) {
     auto resultLE = LLVMBuildZExt(builder, sourceRefLE, LLVMInt8TypeInContext(globalState->context), "boolAsI8");
     auto resultRef = wrap(globalState->getRegion(sourceRefMT), targetRefMT, resultLE);
-    auto sizeRef = globalState->constI32(LLVMABISizeOfType(globalState->dataLayout, translateType(targetRefMT)));
+    auto sizeRef = globalState->constLength(LLVMABISizeOfType(globalState->dataLayout, translateType(targetRefMT)));
     return std::make_pair(resultRef, sizeRef);
   } else if (dynamic_cast<Float*>(sourceRefMT->kind)) {
     auto resultRef = wrap(globalState->getRegion(sourceRefMT), targetRefMT, sourceRefLE);
-    auto sizeRef = globalState->constI32(LLVMABISizeOfType(globalState->dataLayout, translateType(targetRefMT)));
+    auto sizeRef = globalState->constLength(LLVMABISizeOfType(globalState->dataLayout, translateType(targetRefMT)));
     return std::make_pair(resultRef, sizeRef);
   } else if (dynamic_cast<Str*>(sourceRefMT->kind) ||
       dynamic_cast<StructKind*>(sourceRefMT->kind) ||
@@ -1313,7 +1655,7 @@ std::pair<Ref, Ref> Linear::receiveUnencryptedAlienReference(
       if (sourceRefMT == globalState->metalCache->emptyTupleStructRef) {
         auto emptyTupleRefMT = linearizeReference(globalState->metalCache->emptyTupleStructRef);
         auto resultRef = wrap(this, emptyTupleRefMT, LLVMGetUndef(translateType(emptyTupleRefMT)));
-        auto sizeRef = globalState->constI32(LLVMABISizeOfType(globalState->dataLayout, translateType(targetRefMT)));
+        auto sizeRef = globalState->constLength(LLVMABISizeOfType(globalState->dataLayout, translateType(targetRefMT)));
         return std::make_pair(resultRef, sizeRef);
       } else {
         assert(false);
@@ -1425,6 +1767,78 @@ Ref Linear::callSerialize(
   }
 }
 
+Ref Linear::callSerializeRoot(
+    FunctionState *functionState,
+    LLVMBuilderRef builder,
+    Kind* valeKind,
+    Ref regionInstanceRef,
+    Ref objectRef,
+    Ref dryRunBoolRef) {
+  if (!globalState->opt->preserveSharing) {
+    return callSerialize(functionState, builder, valeKind, regionInstanceRef, objectRef, dryRunBoolRef);
+  }
+  // Each pass starts over, since the copies from a dry run or a buffer we outgrew aren't real.
+  LLVMBuildCall(builder, globalState->externs->sharingBegin, nullptr, 0, "");
+  auto resultRef = callSerialize(functionState, builder, valeKind, regionInstanceRef, objectRef, dryRunBoolRef);
+  LLVMBuildCall(builder, globalState->externs->sharingEnd, nullptr, 0, "");
+  return resultRef;
+}
+
+Ref Linear::callSerializeOrFindShared(
+    FunctionState *functionState,
+    LLVMBuilderRef builder,
+    Reference* sourceRefMT,
+    Ref regionInstanceRef,
+    Ref sourceRef,
+    Ref dryRunBoolRef) {
+  if (!globalState->opt->preserveSharing) {
+    return callSerialize(functionState, builder, sourceRefMT->kind, regionInstanceRef, sourceRef, dryRunBoolRef);
+  }
+  auto int8PtrLT = LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0);
+  auto hostRefMT = linearizeReference(sourceRefMT);
+  auto hostRefLT = translateType(hostRefMT);
+  auto sourceLE =
+      globalState->getRegion(sourceRefMT)->checkValidReference(FL(), functionState, builder, sourceRefMT, sourceRef);
+  auto sourceI8PtrLE = LLVMBuildPointerCast(builder, sourceLE, int8PtrLT, "sourceI8Ptr");
+
+  // Only objects with other references could show up again, so only they're worth looking up.
+  // Copies made in a dry run aren't real pointers, but they're never null, which is all we need.
+  auto sharedLE = globalState->rcImm->isShared(functionState, builder, sourceRefMT, sourceRef);
+  auto foundPtrLE =
+      makeMidasLocal(functionState, builder, int8PtrLT, "sharedCopyPtr", LLVMConstNull(int8PtrLT));
+  buildIf(
+      globalState, functionState, builder, sharedLE,
+      [this, sourceI8PtrLE, foundPtrLE](LLVMBuilderRef thenBuilder) {
+        LLVMValueRef argLE = sourceI8PtrLE;
+        auto foundLE = LLVMBuildCall(thenBuilder, globalState->externs->sharingFind, &argLE, 1, "sharedCopy");
+        LLVMBuildStore(thenBuilder, foundLE, foundPtrLE);
+      });
+  auto foundLE = LLVMBuildLoad(builder, foundPtrLE, "sharedCopy");
+  auto resultLE =
+      buildSimpleIfElse(
+          globalState, functionState, builder, LLVMBuildIsNull(builder, foundLE, "notFound"), hostRefLT,
+          [this, functionState, sourceRefMT, hostRefMT, regionInstanceRef, sourceRef, dryRunBoolRef, sourceI8PtrLE, sharedLE, int8PtrLT](
+              LLVMBuilderRef thenBuilder) {
+            auto copyRef =
+                callSerialize(
+                    functionState, thenBuilder, sourceRefMT->kind, regionInstanceRef, sourceRef, dryRunBoolRef);
+            auto copyLE = checkValidReference(FL(), functionState, thenBuilder, hostRefMT, copyRef);
+            buildIf(
+                globalState, functionState, thenBuilder, sharedLE,
+                [this, sourceI8PtrLE, copyLE, int8PtrLT](LLVMBuilderRef addBuilder) {
+                  std::vector<LLVMValueRef> argsLE = {
+                      sourceI8PtrLE, LLVMBuildPointerCast(addBuilder, copyLE, int8PtrLT, "copyI8Ptr")
+                  };
+                  LLVMBuildCall(addBuilder, globalState->externs->sharingAdd, argsLE.data(), argsLE.size(), "");
+                });
+            return copyLE;
+          },
+          [hostRefLT, foundLE](LLVMBuilderRef elseBuilder) {
+            return LLVMBuildPointerCast(elseBuilder, foundLE, hostRefLT, "sharedCopy");
+          });
+  return wrap(this, hostRefMT, resultLE);
+}
+
 void Linear::bumpDestinationOffset(
     FunctionState* functionState,
     LLVMBuilderRef builder,
@@ -1467,6 +1881,24 @@ LLVMValueRef Linear::getDestinationOffset(
   return LLVMBuildLoad(builder, destinationOffsetPtrLE, "destinationOffset");
 }
 
+LLVMValueRef Linear::buildShouldWrite(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Ref regionInstanceRef,
+    Ref dryRunBoolRef) {
+  auto boolMT = globalState->metalCache->boolRef;
+  auto regionInstancePtrLE =
+      checkValidReference(FL(), functionState, builder, regionRefMT, regionInstanceRef);
+  auto destinationOffsetLE = getDestinationOffset(builder, regionInstancePtrLE);
+  auto destinationCapacityPtrLE =
+      LLVMBuildStructGEP(builder, regionInstancePtrLE, 2, "destinationCapacityPtr");
+  auto destinationCapacityLE = LLVMBuildLoad(builder, destinationCapacityPtrLE, "destinationCapacity");
+  auto fitsLE = LLVMBuildICmp(builder, LLVMIntULE, destinationOffsetLE, destinationCapacityLE, "fits");
+  auto dryRunBoolLE =
+      globalState->getRegion(boolMT)->checkValidReference(FL(), functionState, builder, boolMT, dryRunBoolRef);
+  return LLVMBuildAnd(builder, LLVMBuildNot(builder, dryRunBoolLE, "notDryRun"), fitsLE, "shouldWrite");
+}
+
 LLVMValueRef Linear::getDestinationPtr(
     FunctionState* functionState,
     LLVMBuilderRef builder,
@@ -1556,9 +1988,13 @@ void Linear::defineConcreteSerializeFunction(Kind* valeKind) {
         } else if (
             dynamic_cast<Str*>(sourceMemberRefMT->kind) ||
             dynamic_cast<StructKind*>(sourceMemberRefMT->kind) ||
-            dynamic_cast<InterfaceKind*>(sourceMemberRefMT->kind) ||
             dynamic_cast<StaticSizedArrayT*>(sourceMemberRefMT->kind) ||
             dynamic_cast<RuntimeSizedArrayT*>(sourceMemberRefMT->kind)) {
+          auto destinationMemberRef =
+              callSerializeOrFindShared(
+                  functionState, builder, sourceMemberRefMT, regionInstanceRef, sourceMemberRef, dryRunBoolRef);
+          return destinationMemberRef;
+        } else if (dynamic_cast<InterfaceKind*>(sourceMemberRefMT->kind)) {
           auto destinationMemberRef =
               callSerialize(
                   functionState, builder, sourceMemberRefMT->kind, regionInstanceRef, sourceMemberRef, dryRunBoolRef);
@@ -1584,6 +2020,8 @@ void Linear::defineConcreteSerializeFunction(Kind* valeKind) {
 
           auto hostObjectRef = innerAllocate(regionInstanceRef, FL(), functionState, builder, hostObjectRefMT);
           auto innerStructPtrLE = checkValidReference(FL(), functionState, builder, hostObjectRefMT, hostObjectRef);
+          // Decided now, before the members move the offset past the struct.
+          auto shouldWriteLE = buildShouldWrite(functionState, builder, regionInstanceRef, dryRunBoolRef);
 
           std::vector<Ref> hostMemberRefs;
           for (int i = 0; i < valeStructDefM->members.size(); i++) {
@@ -1598,9 +2036,8 @@ void Linear::defineConcreteSerializeFunction(Kind* valeKind) {
                     functionState, builder, sourceMemberRefMT, regionInstanceRef, sourceMemberRef, dryRunBoolRef));
           }
 
-          auto dryRunBoolLE = globalState->getRegion(boolMT)->checkValidReference(FL(), functionState, builder, boolMT, dryRunBoolRef);
           buildIf(
-              globalState, functionState, builder, LLVMBuildNot(builder, dryRunBoolLE, "notDryRun"),
+              globalState, functionState, builder, shouldWriteLE,
               [this, functionState, valeStructDefM, hostMemberRefs, innerStructPtrLE](LLVMBuilderRef thenBuilder) {
                 for (int i = 0; i < valeStructDefM->members.size(); i++) {
                   auto hostMemberRef = hostMemberRefs[i];
@@ -1648,35 +2085,51 @@ void Linear::defineConcreteSerializeFunction(Kind* valeKind) {
               innerConstructRuntimeSizedArray(
                   regionInstanceRef,
                   functionState, builder, hostRsaRefMT, hostRsaMT, lengthRef, dryRunBoolRef);
+          auto shouldWriteLE = buildShouldWrite(functionState, builder, regionInstanceRef, dryRunBoolRef);
           auto valeMemberRefMT = globalState->program->getRuntimeSizedArray(valeRsaMT)->rawArray->elementType;
 
           buildFlare(FL(), globalState, functionState, builder);
 
-          intRangeLoop(
-              globalState, functionState, builder, lengthRef,
-              [this, functionState, hostObjectRefMT, boolMT, hostRsaRef, valeObjectRefMT, hostRsaMT, valeRsaMT, valeObjectRef, valeMemberRefMT, regionInstanceRef, serializeMemberOrElement, dryRunBoolRef](
-                  Ref indexRef, LLVMBuilderRef bodyBuilder){
-                buildFlare(FL(), globalState, functionState, bodyBuilder, "In serialize iteration!");
-
-                auto sourceMemberRef =
-                    globalState->getRegion(valeObjectRefMT)
-                        ->loadElementFromRSA(functionState, bodyBuilder, valeObjectRefMT, valeRsaMT, valeObjectRef, true, indexRef)
-                    .move();
-                buildFlare(FL(), globalState, functionState, bodyBuilder);
-                auto hostElementRef =
-                    serializeMemberOrElement(
-                        functionState, bodyBuilder, valeMemberRefMT, regionInstanceRef, sourceMemberRef, dryRunBoolRef);
-                buildFlare(FL(), globalState, functionState, bodyBuilder);
-                auto dryRunBoolLE = globalState->getRegion(boolMT)->checkValidReference(FL(), functionState, bodyBuilder, boolMT, dryRunBoolRef);
-                buildIf(
-                    globalState, functionState, bodyBuilder, LLVMBuildNot(bodyBuilder, dryRunBoolLE, "notDryRun"),
-                    [this, functionState, hostObjectRefMT, hostRsaRef, indexRef, hostElementRef, hostRsaMT](
-                        LLVMBuilderRef thenBuilder) mutable {
-                      initializeElementInRSA(
-                          functionState, thenBuilder, hostObjectRefMT, hostRsaMT, hostRsaRef, true, indexRef, hostElementRef);
-                    buildFlare(FL(), globalState, functionState, thenBuilder);
-                  });
-              });
+          if (globalState->opt->bulkCopyPrimitiveArrays && isBulkCopyableElement(valeMemberRefMT)) {
+            auto lengthRefMT = globalState->getLengthRefMT();
+            auto lengthLE =
+                globalState->getRegion(lengthRefMT)->checkValidReference(FL(), functionState, builder, lengthRefMT, lengthRef);
+            buildIf(
+                globalState, functionState, builder, shouldWriteLE,
+                [this, functionState, valeMemberRefMT, hostRsaRefMT, hostRsaRef, valeObjectRefMT, valeObjectRef, lengthLE](
+                    LLVMBuilderRef thenBuilder) {
+                  copyElementsInBulk(
+                      functionState, thenBuilder, valeMemberRefMT,
+                      getArrayElementsI8Ptr(functionState, thenBuilder, hostRsaRefMT, hostRsaRef),
+                      globalState->rcImm->getArrayElementsI8Ptr(functionState, thenBuilder, valeObjectRefMT, valeObjectRef),
+                      lengthLE);
+                });
+          } else {
+            intRangeLoop(
+                globalState, functionState, builder, globalState->getLengthMT(), lengthRef,
+                [this, functionState, hostObjectRefMT, boolMT, hostRsaRef, valeObjectRefMT, hostRsaMT, valeRsaMT, valeObjectRef, valeMemberRefMT, regionInstanceRef, serializeMemberOrElement, dryRunBoolRef, shouldWriteLE](
+                    Ref indexRef, LLVMBuilderRef bodyBuilder){
+                  buildFlare(FL(), globalState, functionState, bodyBuilder, "In serialize iteration!");
+
+                  auto sourceMemberRef =
+                      globalState->getRegion(valeObjectRefMT)
+                          ->loadElementFromRSA(functionState, bodyBuilder, valeObjectRefMT, valeRsaMT, valeObjectRef, true, indexRef)
+                      .move();
+                  buildFlare(FL(), globalState, functionState, bodyBuilder);
+                  auto hostElementRef =
+                      serializeMemberOrElement(
+                          functionState, bodyBuilder, valeMemberRefMT, regionInstanceRef, sourceMemberRef, dryRunBoolRef);
+                  buildFlare(FL(), globalState, functionState, bodyBuilder);
+                  buildIf(
+                      globalState, functionState, bodyBuilder, shouldWriteLE,
+                      [this, functionState, hostObjectRefMT, hostRsaRef, indexRef, hostElementRef, hostRsaMT](
+                          LLVMBuilderRef thenBuilder) mutable {
+                        initializeElementInRSA(
+                            functionState, thenBuilder, hostObjectRefMT, hostRsaMT, hostRsaRef, true, indexRef, hostElementRef);
+                      buildFlare(FL(), globalState, functionState, thenBuilder);
+                    });
+                });
+          }
 
           buildFlare(FL(), globalState, functionState, builder, "Returning from serialize function!");
 
@@ -1699,35 +2152,50 @@ void Linear::defineConcreteSerializeFunction(Kind* valeKind) {
               innerConstructStaticSizedArray(
                   regionInstanceRef,
                   functionState, builder, hostSsaRefMT, hostSsaMT, dryRunBoolRef);
+          auto shouldWriteLE = buildShouldWrite(functionState, builder, regionInstanceRef, dryRunBoolRef);
           auto valeMemberRefMT = globalState->program->getStaticSizedArray(valeSsaMT)->rawArray->elementType;
 
           buildFlare(FL(), globalState, functionState, builder);
 
-          intRangeLoop(
-              globalState, functionState, builder, lengthRef,
-              [this, functionState, hostObjectRefMT, boolMT, hostSsaRef, valeObjectRefMT, hostSsaMT, valeSsaMT, valeObjectRef, valeMemberRefMT, regionInstanceRef, serializeMemberOrElement, dryRunBoolRef](
-                  Ref indexRef, LLVMBuilderRef bodyBuilder){
-                buildFlare(FL(), globalState, functionState, bodyBuilder, "In serialize iteration!");
-
-                auto sourceMemberRef =
-                    globalState->getRegion(valeObjectRefMT)
-                        ->loadElementFromSSA(functionState, bodyBuilder, valeObjectRefMT, valeSsaMT, valeObjectRef, true, indexRef)
-                        .move();
-                buildFlare(FL(), globalState, functionState, bodyBuilder);
-                auto hostElementRef =
-                    serializeMemberOrElement(
-                        functionState, bodyBuilder, valeMemberRefMT, regionInstanceRef, sourceMemberRef, dryRunBoolRef);
-                buildFlare(FL(), globalState, functionState, bodyBuilder);
-                auto dryRunBoolLE = globalState->getRegion(boolMT)->checkValidReference(FL(), functionState, bodyBuilder, boolMT, dryRunBoolRef);
-                buildIf(
-                    globalState, functionState, bodyBuilder, LLVMBuildNot(bodyBuilder, dryRunBoolLE, "notDryRun"),
-                    [this, functionState, hostObjectRefMT, hostSsaRef, indexRef, hostElementRef, hostSsaMT](
-                        LLVMBuilderRef thenBuilder) mutable {
-                      initializeElementInSSA(
-                          functionState, thenBuilder, hostObjectRefMT, hostSsaMT, hostSsaRef, true, indexRef, hostElementRef);
-                      buildFlare(FL(), globalState, functionState, thenBuilder);
-                    });
-              });
+          if (globalState->opt->bulkCopyPrimitiveArrays && isBulkCopyableElement(valeMemberRefMT)) {
+            auto lengthLE =
+                globalState->getRegion(i32MT)->checkValidReference(FL(), functionState, builder, i32MT, lengthRef);
+            buildIf(
+                globalState, functionState, builder, shouldWriteLE,
+                [this, functionState, valeMemberRefMT, hostSsaRefMT, hostSsaRef, valeObjectRefMT, valeObjectRef, lengthLE](
+                    LLVMBuilderRef thenBuilder) {
+                  copyElementsInBulk(
+                      functionState, thenBuilder, valeMemberRefMT,
+                      getArrayElementsI8Ptr(functionState, thenBuilder, hostSsaRefMT, hostSsaRef),
+                      globalState->rcImm->getArrayElementsI8Ptr(functionState, thenBuilder, valeObjectRefMT, valeObjectRef),
+                      lengthLE);
+                });
+          } else {
+            intRangeLoop(
+                globalState, functionState, builder, globalState->metalCache->i32, lengthRef,
+                [this, functionState, hostObjectRefMT, boolMT, hostSsaRef, valeObjectRefMT, hostSsaMT, valeSsaMT, valeObjectRef, valeMemberRefMT, regionInstanceRef, serializeMemberOrElement, dryRunBoolRef, shouldWriteLE](
+                    Ref indexRef, LLVMBuilderRef bodyBuilder){
+                  buildFlare(FL(), globalState, functionState, bodyBuilder, "In serialize iteration!");
+
+                  auto sourceMemberRef =
+                      globalState->getRegion(valeObjectRefMT)
+                          ->loadElementFromSSA(functionState, bodyBuilder, valeObjectRefMT, valeSsaMT, valeObjectRef, true, indexRef)
+                          .move();
+                  buildFlare(FL(), globalState, functionState, bodyBuilder);
+                  auto hostElementRef =
+                      serializeMemberOrElement(
+                          functionState, bodyBuilder, valeMemberRefMT, regionInstanceRef, sourceMemberRef, dryRunBoolRef);
+                  buildFlare(FL(), globalState, functionState, bodyBuilder);
+                  buildIf(
+                      globalState, functionState, bodyBuilder, shouldWriteLE,
+                      [this, functionState, hostObjectRefMT, hostSsaRef, indexRef, hostElementRef, hostSsaMT](
+                          LLVMBuilderRef thenBuilder) mutable {
+                        initializeElementInSSA(
+                            functionState, thenBuilder, hostObjectRefMT, hostSsaMT, hostSsaRef, true, indexRef, hostElementRef);
+                        buildFlare(FL(), globalState, functionState, thenBuilder);
+                      });
+                });
+          }
 
           buildFlare(FL(), globalState, functionState, builder, "Returning from serialize function!");
 
@@ -1790,6 +2258,43 @@ Reference* Linear::unlinearizeReference(Reference* hostRefMT) {
       hostRefMT->ownership, hostRefMT->location, valeKind);
 }
 
+bool Linear::isBulkCopyableElement(Reference* valeElementRefMT) {
+  return valeElementRefMT == globalState->metalCache->i64Ref ||
+      valeElementRefMT == globalState->metalCache->i32Ref ||
+      valeElementRefMT == globalState->metalCache->floatRef;
+}
+
+void Linear::copyElementsInBulk(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Reference* valeElementRefMT,
+    LLVMValueRef destElementsI8PtrLE,
+    LLVMValueRef sourceElementsI8PtrLE,
+    LLVMValueRef lengthLE) {
+  assert(isBulkCopyableElement(valeElementRefMT));
+  auto elementLT = globalState->getRegion(valeElementRefMT)->translateType(valeElementRefMT);
+  auto elementSizeLE = constI64LE(globalState, LLVMABISizeOfType(globalState->dataLayout, elementLT));
+  // Already an i64 for runtime-sized arrays with --wide-lengths, in which case this does nothing.
+  auto lengthI64LE = LLVMBuildZExt(builder, lengthLE, LLVMInt64TypeInContext(globalState->context), "length");
+  auto numBytesLE = LLVMBuildMul(builder, lengthI64LE, elementSizeLE, "numBytes");
+  std::vector<LLVMValueRef> argsLE = { destElementsI8PtrLE, sourceElementsI8PtrLE, numBytesLE };
+  LLVMBuildCall(builder, globalState->externs->memcpy, argsLE.data(), argsLE.size(), "");
+}
+
+LLVMValueRef Linear::getArrayElementsI8Ptr(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Reference* hostArrayRefMT,
+    Ref hostArrayRef) {
+  auto arrayPtrLE = checkValidReference(FL(), functionState, builder, hostArrayRefMT, hostArrayRef);
+  auto elementsPtrLE =
+      dynamic_cast<RuntimeSizedArrayT*>(hostArrayRefMT->kind) ?
+      structs.getRuntimeSizedArrayElementsPtr(functionState, builder, arrayPtrLE) :
+      structs.getStaticSizedArrayElementsPtr(functionState, builder, arrayPtrLE);
+  return LLVMBuildPointerCast(
+      builder, elementsPtrLE, LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0), "elementsI8Ptr");
+}
+
 void Linear::initializeElementInRSA(
     FunctionState *functionState,
     LLVMBuilderRef builder,
@@ -1812,9 +2317,9 @@ void Linear::initializeElementInRSA(
   auto elementRefLE = globalState->getRegion(hostElementRefMT)->checkValidReference(FL(), functionState, builder, hostElementRefMT, elementRef);
 
   buildFlare(FL(), globalState, functionState, builder);
-  auto i32MT = globalState->metalCache->i32Ref;
+  auto lengthRefMT = globalState->getLengthRefMT();
 
-  auto indexLE = globalState->getRegion(i32MT)->checkValidReference(FL(), functionState, builder, i32MT, indexRef);
+  auto indexLE = globalState->getRegion(lengthRefMT)->checkValidReference(FL(), functionState, builder, lengthRefMT, indexRef);
 
   buildFlare(FL(), globalState, functionState, builder);
   auto rsaPtrLE = checkValidReference(FL(), functionState, builder, hostRsaRefMT, hostRsaRef);
@@ -1913,7 +2418,7 @@ LLVMValueRef Linear::getInterfaceMethodFunctionPtr(
   auto isValidEdgeNumLE =
       LLVMBuildICmp(builder, LLVMIntULT, edgeNumLE, constI64LE(globalState, orderedSubstructs.size()), "isValidEdgeNum");
 
-  buildIf(
+  buildColdIf(
       globalState, functionState, builder, isZeroLE(builder, isValidEdgeNumLE),
       [this, edgeNumLE](LLVMBuilderRef thenBuilder) {
           buildPrint(globalState, thenBuilder, "Invalid edge number (");
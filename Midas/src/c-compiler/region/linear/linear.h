@@ -4,6 +4,7 @@
 #include <llvm-c/Types.h>
 #include <globalstate.h>
 #include <iostream>
+#include <unordered_set>
 #include <region/common/primitives.h>
 #include <function/expressions/shared/afl.h>
 #include <function/function.h>
@@ -425,6 +426,48 @@ public:
   Reference* linearizeReference(Reference* immRcRefMT);
   Reference* unlinearizeReference(Reference* hostRefMT);
 
+  // Whether arrays of this element are laid out the same here as in RCImm, so we can copy all
+  // their elements across with one memcpy. Not bools, which we store as i8.
+  bool isBulkCopyableElement(Reference* valeElementRefMT);
+
+  void copyElementsInBulk(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      Reference* valeElementRefMT,
+      LLVMValueRef destElementsI8PtrLE,
+      LLVMValueRef sourceElementsI8PtrLE,
+      LLVMValueRef lengthLE);
+
+  LLVMValueRef getArrayElementsI8Ptr(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      Reference* hostArrayRefMT,
+      Ref hostArrayRef);
+
+  // Serializes this immutable into a snapshot file at the given path, see snapshot.c. Returns an
+  // i1 saying whether it worked.
+  LLVMValueRef saveSnapshot(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      Kind* valeKind,
+      Ref ref,
+      LLVMValueRef pathCharsPtrLE);
+
+  // Gets the root object of a snapshot we just mapped.
+  Ref getSnapshotRoot(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      Reference* hostRefMT,
+      LLVMValueRef snapshotPtrLE);
+
+  // A hash of the layout of everything reachable from this kind, so we never map a snapshot that
+  // a program with different types wrote.
+  uint64_t getSnapshotTypeHash(Kind* valeKind);
+
+  // Each snapshot type is mapped in a slot picked by its hash, see snapshot.c. Exits with an error
+  // if two of this program's snapshot types would share one, since they couldn't both be mapped.
+  void checkSnapshotSlots();
+
   Weakability getKindWeakability(Kind* kind) override;
 
   LLVMValueRef getInterfaceMethodFunctionPtr(
@@ -452,6 +495,19 @@ public:
   void mainCleanup(FunctionState* functionState, LLVMBuilderRef builder) override {}
 
 private:
+  // With --zero-copy-externs or --memoize-extern-serialize, a #define telling C that externs
+  // don't own this kind.
+  std::string getLentToExternsDefC(const std::string& name, Kind* valeKind);
+
+  // If a _vsnapsave or _vsnapload extern has this kind as its root, a #define with its type hash,
+  // so C can map the snapshot itself.
+  std::string getSnapshotDefC(const std::string& name, Kind* valeKind);
+
+  void hashSnapshotLayout(
+      Kind* valeKind,
+      std::unordered_set<Kind*, AddressHasher<Kind*>>* hashedKinds,
+      uint64_t* hash);
+
   void declareConcreteSerializeFunction(Kind* valeKindM);
   void defineConcreteSerializeFunction(Kind* valeKindM);
   void declareInterfaceSerializeFunction(InterfaceKind* valeKind);
@@ -497,6 +553,26 @@ private:
       Ref objectRef,
       Ref dryRunBoolRef);
 
+  // Serializes the root object of a buffer. With --preserve-sharing, this is where we start
+  // remembering the copies we make, see sharing.c.
+  Ref callSerializeRoot(
+      FunctionState *functionState,
+      LLVMBuilderRef builder,
+      Kind* valeKind,
+      Ref regionInstanceRef,
+      Ref objectRef,
+      Ref dryRunBoolRef);
+
+  // Serializes an object that something else in the buffer points to. With --preserve-sharing,
+  // if it's reachable more than once and we already have a copy, points at that instead.
+  Ref callSerializeOrFindShared(
+      FunctionState *functionState,
+      LLVMBuilderRef builder,
+      Reference* sourceRefMT,
+      Ref regionInstanceRef,
+      Ref sourceRef,
+      Ref dryRunBoolRef);
+
   // Does the entire serialization process: measuring the length, allocating a buffer, and
   // serializing into it.
   // Returns the pointer to it and the size.
@@ -506,6 +582,31 @@ private:
       Kind* valeKind,
       Ref ref);
 
+  // Serializes straight into a buffer sized by what this kind needed last time, and only if
+  // that turns out too small does it measure-and-retry like topLevelSerialize does.
+  std::pair<Ref, Ref> topLevelSerializeSinglePass(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      Kind* valeKind,
+      Ref ref);
+
+  Ref makeRegionInstance(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      LLVMValueRef bufferBeginPtrLE,
+      LLVMValueRef capacityIntLE);
+
+  // A global holding the biggest buffer we've needed to serialize this kind.
+  LLVMValueRef getSerializeSizeHintPtr(Kind* valeKind);
+
+  // Whether to write the thing we just reserved space for. False on a dry run, and when it
+  // doesn't fit in the buffer.
+  LLVMValueRef buildShouldWrite(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      Ref regionInstanceRef,
+      Ref dryRunBoolRef);
+
   void bumpDestinationOffset(
       FunctionState* functionState,
       LLVMBuilderRef builder,
@@ -550,6 +651,11 @@ private:
       Kind*,
       AddressHasher<Kind*>> valeKindByHostKind;
 
+  std::unordered_map<
+      Kind*,
+      LLVMValueRef,
+      AddressHasher<Kind*>> serializeSizeHintPtrByKind;
+
   std::string namePrefix = "__Linear";
 
   StructKind* regionKind = nullptr;
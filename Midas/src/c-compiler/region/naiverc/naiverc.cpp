@@ -652,7 +652,7 @@ Ref NaiveRC::storeElementInRSA(
   auto arrayElementsPtrLE = getRuntimeSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   buildFlare(FL(), globalState, functionState, builder);
   return ::swapElement(
-      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, globalState->getLengthMT(), sizeRef, arrayElementsPtrLE, indexRef, elementRef);
 }
 
 Ref NaiveRC::upcast(
@@ -965,7 +965,7 @@ void NaiveRC::initializeElementInSSA(
   auto sizeRef = globalState->constI32(ssaDef->size);
   auto arrayElementsPtrLE = getStaticSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   ::initializeElement(
-      globalState, functionState, builder, ssaRefMT->location, ssaDef->rawArray->elementType, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+      globalState, functionState, builder, ssaRefMT->location, ssaDef->rawArray->elementType, globalState->metalCache->i32, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
 }
 
 Ref NaiveRC::deinitializeElementFromSSA(
@@ -10,6 +10,13 @@
 #include "rcimm.h"
 #include "translatetype.h"
 #include "region/linear/linear.h"
+#include "externs.h"
+
+// The generational heap keeps its sizes where we'd keep the slab offset, and the census wants to
+// see every malloc.
+static bool unserializesIntoSlabs(GlobalState* globalState) {
+  return globalState->opt->slabUnserialize && !globalState->opt->genHeap && !globalState->opt->census;
+}
 
 void fillControlBlock(
     AreaAndFileAndLine from,
@@ -25,6 +32,18 @@ void fillControlBlock(
       fillControlBlockCensusFields(
           from, globalState, functionState, structs, builder, kindM, newControlBlockLE, typeName);
   newControlBlockLE = insertStrongRc(globalState, builder, structs, kindM, newControlBlockLE);
+  if (unserializesIntoSlabs(globalState)) {
+    // Zero means it didn't come from a slab.
+    auto slabOffsetLE =
+        functionState && functionState->slabOffsetPtrLE ?
+        LLVMBuildLoad(builder, functionState->slabOffsetPtrLE, "slabOffset") :
+        constI32LE(globalState, 0);
+    newControlBlockLE =
+        LLVMBuildInsertValue(
+            builder, newControlBlockLE, slabOffsetLE,
+            structs->getControlBlock(kindM)->getMemberIndex(ControlBlockMember::SLAB_OFFSET_32B),
+            "controlBlockWithSlabOffset");
+  }
   LLVMBuildStore(builder, newControlBlockLE, controlBlockPtrLE.refLE);
 }
 
@@ -33,7 +52,10 @@ ControlBlock makeImmControlBlock(GlobalState* globalState) {
   controlBlock.addMember(ControlBlockMember::STRONG_RC_32B);
   // This is where we put the size in the current generational heap, we can use it for something
   // else until we get rid of that.
-  controlBlock.addMember(ControlBlockMember::UNUSED_32B);
+  controlBlock.addMember(
+      unserializesIntoSlabs(globalState) ?
+      ControlBlockMember::SLAB_OFFSET_32B :
+      ControlBlockMember::UNUSED_32B);
   if (globalState->opt->census) {
     controlBlock.addMember(ControlBlockMember::CENSUS_TYPE_STR);
     controlBlock.addMember(ControlBlockMember::CENSUS_OBJ_ID);
@@ -44,7 +66,9 @@ ControlBlock makeImmControlBlock(GlobalState* globalState) {
 
 RCImm::RCImm(GlobalState* globalState_)
   : globalState(globalState_),
-    kindStructs(globalState, makeImmControlBlock(globalState), makeImmControlBlock(globalState), LLVMStructCreateNamed(globalState->context, "immUnused")) {
+    kindStructs(globalState, makeImmControlBlock(globalState), makeImmControlBlock(globalState), LLVMStructCreateNamed(globalState->context, "immUnused")),
+    memoizableExternParamKinds(0, globalState->addressNumberer->makeHasher<Kind*>()),
+    unserializeSlabHintPtrByKind(0, globalState->addressNumberer->makeHasher<Kind*>()) {
 }
 
 RegionId* RCImm::getRegionId() {
@@ -595,7 +619,116 @@ void RCImm::initializeElementInRSA(
   auto arrayElementsPtrLE = getRuntimeSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   ::initializeElement(
       globalState, functionState, builder, rsaRefMT->location,
-      elementType, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+      elementType, globalState->getLengthMT(), sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+}
+
+bool RCImm::canLendToExtern(Kind* valeKind) {
+  auto linearRegion = globalState->linearRegion;
+  if (auto structKind = dynamic_cast<StructKind*>(valeKind)) {
+    for (auto member : globalState->program->getStruct(structKind)->members) {
+      if (!linearRegion->isBulkCopyableElement(member->type)) {
+        return false;
+      }
+    }
+    return true;
+  } else if (auto ssaMT = dynamic_cast<StaticSizedArrayT*>(valeKind)) {
+    return linearRegion->isBulkCopyableElement(
+        globalState->program->getStaticSizedArray(ssaMT)->rawArray->elementType);
+  } else if (auto rsaMT = dynamic_cast<RuntimeSizedArrayT*>(valeKind)) {
+    if (!linearRegion->isBulkCopyableElement(
+        globalState->program->getRuntimeSizedArray(rsaMT)->rawArray->elementType)) {
+      return false;
+    }
+    // The elements have to be as far from the length here as they are in the linear array, which
+    // depends on how big the control block is.
+    auto valeRefMT = globalState->metalCache->getReference(Ownership::SHARE, Location::YONDER, rsaMT);
+    auto hostRsaLT =
+        LLVMGetElementType(linearRegion->translateType(linearRegion->linearizeReference(valeRefMT)));
+    auto wrapperLT = kindStructs.getRuntimeSizedArrayWrapperStruct(rsaMT);
+    return LLVMOffsetOfElement(globalState->dataLayout, wrapperLT, 2) -
+        LLVMOffsetOfElement(globalState->dataLayout, wrapperLT, 1) ==
+        LLVMOffsetOfElement(globalState->dataLayout, hostRsaLT, 1);
+  } else {
+    return false;
+  }
+}
+
+LLVMValueRef RCImm::lendToExtern(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Reference* valeRefMT,
+    Ref valeRef) {
+  assert(canLendToExtern(valeRefMT->kind));
+  auto wrapperPtrLE =
+      kindStructs.makeWrapperPtr(
+          FL(), functionState, builder, valeRefMT,
+          checkValidReference(FL(), functionState, builder, valeRefMT, valeRef));
+  LLVMValueRef innerPtrLE = nullptr;
+  if (dynamic_cast<StructKind*>(valeRefMT->kind)) {
+    innerPtrLE = kindStructs.getStructContentsPtr(builder, valeRefMT->kind, wrapperPtrLE);
+  } else if (dynamic_cast<StaticSizedArrayT*>(valeRefMT->kind)) {
+    innerPtrLE = getStaticSizedArrayContentsPtr(builder, wrapperPtrLE);
+  } else if (dynamic_cast<RuntimeSizedArrayT*>(valeRefMT->kind)) {
+    innerPtrLE = getRuntimeSizedArrayLengthPtr(globalState, builder, wrapperPtrLE);
+  } else assert(false);
+  auto hostRefLT =
+      globalState->linearRegion->translateType(globalState->linearRegion->linearizeReference(valeRefMT));
+  return LLVMBuildPointerCast(builder, innerPtrLE, hostRefLT, "lentPtr");
+}
+
+bool RCImm::memoizesExternSerialize(Kind* valeKind) {
+  if (!globalState->opt->memoizeExternSerialize ||
+      (globalState->opt->zeroCopyExterns && canLendToExtern(valeKind))) {
+    return false;
+  }
+  if (!memoizableExternParamKindsCollected) {
+    memoizableExternParamKindsCollected = true;
+    // SASP externs get a size with their copy so they can keep it, so they always need their own.
+    std::unordered_set<Kind*, AddressHasher<Kind*>> sizedParamKinds(
+        0, globalState->addressNumberer->makeHasher<Kind*>());
+    for (auto[packageCoord, package] : globalState->program->packages) {
+      for (auto[externName, prototype] : package->externNameToFunction) {
+        if (isSnapshotExtern(prototype)) {
+          // These never hand anything to C.
+          continue;
+        }
+        for (int i = 0; i < prototype->params.size(); i++) {
+          auto paramMT = prototype->params[i];
+          if (paramMT->ownership == Ownership::SHARE &&
+              (dynamic_cast<StructKind*>(paramMT->kind) ||
+                  dynamic_cast<StaticSizedArrayT*>(paramMT->kind) ||
+                  dynamic_cast<RuntimeSizedArrayT*>(paramMT->kind))) {
+            if (includeSizeParam(globalState, prototype, i)) {
+              sizedParamKinds.insert(paramMT->kind);
+            } else {
+              memoizableExternParamKinds.insert(paramMT->kind);
+            }
+          }
+        }
+      }
+    }
+    for (auto kind : sizedParamKinds) {
+      memoizableExternParamKinds.erase(kind);
+    }
+  }
+  return memoizableExternParamKinds.count(valeKind) > 0;
+}
+
+LLVMValueRef RCImm::getArrayElementsI8Ptr(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Reference* arrayRefMT,
+    Ref arrayRef) {
+  auto arrayWrapperPtrLE =
+      kindStructs.makeWrapperPtr(
+          FL(), functionState, builder, arrayRefMT,
+          checkValidReference(FL(), functionState, builder, arrayRefMT, arrayRef));
+  auto elementsPtrLE =
+      dynamic_cast<RuntimeSizedArrayT*>(arrayRefMT->kind) ?
+      getRuntimeSizedArrayContentsPtr(builder, arrayWrapperPtrLE) :
+      getStaticSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
+  return LLVMBuildPointerCast(
+      builder, elementsPtrLE, LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0), "elementsI8Ptr");
 }
 
 void RCImm::deallocate(
@@ -604,7 +737,59 @@ void RCImm::deallocate(
     LLVMBuilderRef builder,
     Reference* refMT,
     Ref ref) {
-  innerDeallocate(from, globalState, functionState, &kindStructs, builder, refMT, ref);
+  deallocateMaybeFromSlab(from, functionState, builder, refMT, ref);
+}
+
+void RCImm::deallocateMaybeFromSlab(
+    AreaAndFileAndLine from,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Reference* refMT,
+    Ref ref) {
+  if (!unserializesIntoSlabs(globalState) || refMT->location == Location::INLINE) {
+    innerDeallocate(from, globalState, functionState, &kindStructs, builder, refMT, ref);
+    return;
+  }
+  auto controlBlockPtrLE = kindStructs.getControlBlockPtr(from, functionState, builder, ref, refMT);
+  auto slabOffsetPtrLE =
+      LLVMBuildStructGEP(
+          builder, controlBlockPtrLE.refLE,
+          kindStructs.getControlBlock(refMT->kind)->getMemberIndex(ControlBlockMember::SLAB_OFFSET_32B),
+          "slabOffsetPtr");
+  auto slabOffsetLE = LLVMBuildLoad(builder, slabOffsetPtrLE, "slabOffset");
+  auto fromSlabLE = LLVMBuildICmp(builder, LLVMIntNE, slabOffsetLE, constI32LE(globalState, 0), "fromSlab");
+  buildVoidIfElse(
+      globalState, functionState, builder, fromSlabLE,
+      [this, controlBlockPtrLE, slabOffsetLE](LLVMBuilderRef thenBuilder) {
+        auto objectI8PtrLE =
+            LLVMBuildPointerCast(
+                thenBuilder, controlBlockPtrLE.refLE,
+                LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0), "objectI8Ptr");
+        auto negativeOffsetLE =
+            LLVMBuildNeg(
+                thenBuilder,
+                LLVMBuildZExt(thenBuilder, slabOffsetLE, LLVMInt64TypeInContext(globalState->context), ""),
+                "negativeSlabOffset");
+        auto slabPtrLE = LLVMBuildGEP(thenBuilder, objectI8PtrLE, &negativeOffsetLE, 1, "slabPtr");
+        LLVMBuildCall(thenBuilder, globalState->externs->slabFree, &slabPtrLE, 1, "");
+      },
+      [this, from, functionState, refMT, ref](LLVMBuilderRef elseBuilder) {
+        innerDeallocate(from, globalState, functionState, &kindStructs, elseBuilder, refMT, ref);
+      });
+}
+
+LLVMValueRef RCImm::getUnserializeSlabHintPtr(Kind* valeKind) {
+  auto iter = unserializeSlabHintPtrByKind.find(valeKind);
+  if (iter != unserializeSlabHintPtrByKind.end()) {
+    return iter->second;
+  }
+  auto int64LT = LLVMInt64TypeInContext(globalState->context);
+  auto name = std::string("__RCImm_unserializeSlabHint_") + std::to_string(unserializeSlabHintPtrByKind.size());
+  auto slabHintPtrLE = LLVMAddGlobal(globalState->mod, int64LT, name.c_str());
+  LLVMSetInitializer(slabHintPtrLE, LLVMConstInt(int64LT, 0, false));
+  LLVMSetLinkage(slabHintPtrLE, LLVMPrivateLinkage);
+  unserializeSlabHintPtrByKind.emplace(valeKind, slabHintPtrLE);
+  return slabHintPtrLE;
 }
 
 
@@ -659,6 +844,119 @@ Ref RCImm::mallocStr(
   return resultRef;
 }
 
+// Far more than any program will have references to one literal, and far enough from the int
+// limit that incrementing it won't overflow.
+constexpr int32_t IMMORTAL_STR_RC = 1 << 30;
+
+// The initializer for a global laid out like the string wrapper struct, except the chars array
+// has its actual length.
+static LLVMValueRef makeImmortalStrLE(
+    GlobalState* globalState,
+    KindStructs* kindStructs,
+    const std::string& contents) {
+  auto controlBlock = kindStructs->getControlBlock(globalState->metalCache->str);
+  unsigned int rcIndex = controlBlock->getMemberIndex(ControlBlockMember::STRONG_RC_32B);
+  auto controlBlockLE =
+      LLVMConstInsertValue(
+          LLVMConstNull(controlBlock->getStruct()),
+          constI32LE(globalState, IMMORTAL_STR_RC),
+          &rcIndex, 1);
+  std::vector<LLVMValueRef> innerMembersLE = {
+      LLVMConstInt(globalState->getLengthLT(), contents.length(), false),
+      // Includes the null terminator, like mallocStr puts on the end.
+      LLVMConstStringInContext(globalState->context, contents.c_str(), contents.length(), false)
+  };
+  auto innerLE =
+      LLVMConstStructInContext(globalState->context, innerMembersLE.data(), innerMembersLE.size(), false);
+  std::vector<LLVMValueRef> membersLE = { controlBlockLE, innerLE };
+  return LLVMConstStructInContext(globalState->context, membersLE.data(), membersLE.size(), false);
+}
+
+Ref RCImm::wrapImmortalStr(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    LLVMValueRef strPtrLE) {
+  auto wrapperPtrLE =
+      LLVMBuildBitCast(
+          builder, strPtrLE, LLVMPointerType(kindStructs.getStringWrapperStruct(), 0), "strWrapperPtr");
+  auto strRef =
+      wrap(this, globalState->metalCache->strRef,
+          kindStructs.makeWrapperPtr(
+              FL(), functionState, builder, globalState->metalCache->strRef, wrapperPtrLE));
+  // Unlike a new Str, an immortal Str's RC doesn't start at 1 for us, so count this reference like
+  // an alias. Every use adds one and every discard takes one away, so it stays immortal.
+  adjustStrongRc(
+      FL(), globalState, functionState, &kindStructs, builder, strRef, globalState->metalCache->strRef, 1);
+  return strRef;
+}
+
+Ref RCImm::constantStr(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    const std::string& contents) {
+  // The census would want to track it like any other object.
+  assert(!globalState->opt->census);
+
+  auto iter = constantStrs.find(contents);
+  if (iter == constantStrs.end()) {
+    auto strLE = makeImmortalStrLE(globalState, &kindStructs, contents);
+    auto name = std::string("__vale_conststr") + std::to_string(constantStrs.size());
+    auto globalLE = LLVMAddGlobal(globalState->mod, LLVMTypeOf(strLE), name.c_str());
+    LLVMSetInitializer(globalLE, strLE);
+    LLVMSetLinkage(globalLE, LLVMPrivateLinkage);
+    // Not constant, the RC still changes.
+    LLVMSetGlobalConstant(globalLE, false);
+    iter = constantStrs.emplace(contents, globalLE).first;
+  }
+  return wrapImmortalStr(functionState, builder, iter->second);
+}
+
+Ref RCImm::mallocOrInternStr(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    LLVMValueRef lengthLE,
+    LLVMValueRef sourceCharsPtrLE) {
+  if (!globalState->opt->internSingleCharStrings || globalState->opt->census) {
+    return mallocStr(makeEmptyTupleRef(globalState), functionState, builder, lengthLE, sourceCharsPtrLE);
+  }
+
+  if (singleCharStrsLE == nullptr) {
+    std::vector<LLVMValueRef> strsLE;
+    for (int i = 0; i < 256; i++) {
+      strsLE.push_back(makeImmortalStrLE(globalState, &kindStructs, std::string(1, (char)i)));
+    }
+    auto tableLE = LLVMConstArray(LLVMTypeOf(strsLE[0]), strsLE.data(), strsLE.size());
+    singleCharStrsLE = LLVMAddGlobal(globalState->mod, LLVMTypeOf(tableLE), "__vale_singleCharStrs");
+    LLVMSetInitializer(singleCharStrsLE, tableLE);
+    LLVMSetLinkage(singleCharStrsLE, LLVMPrivateLinkage);
+    // Not constant, the RCs still change.
+    LLVMSetGlobalConstant(singleCharStrsLE, false);
+  }
+
+  auto isSingleCharLE =
+      LLVMBuildICmp(
+          builder, LLVMIntEQ, lengthLE, LLVMConstInt(LLVMTypeOf(lengthLE), 1, false), "isSingleChar");
+  auto isSingleCharRef =
+      wrap(globalState->getRegion(globalState->metalCache->boolRef),
+          globalState->metalCache->boolRef,
+          isSingleCharLE);
+  auto strMT = globalState->metalCache->strRef;
+  return buildIfElse(
+      globalState, functionState, builder, isSingleCharRef, translateType(strMT), strMT, strMT,
+      [this, functionState, sourceCharsPtrLE](LLVMBuilderRef thenBuilder) {
+        auto charLE = LLVMBuildLoad(thenBuilder, sourceCharsPtrLE, "char");
+        auto indexLE = LLVMBuildZExt(thenBuilder, charLE, LLVMInt64TypeInContext(globalState->context), "");
+        std::vector<LLVMValueRef> indicesLE = { constI64LE(globalState, 0), indexLE };
+        auto strPtrLE =
+            LLVMBuildGEP(thenBuilder, singleCharStrsLE, indicesLE.data(), indicesLE.size(), "singleCharStr");
+        return wrapImmortalStr(functionState, thenBuilder, strPtrLE);
+      },
+      [this, functionState, lengthLE, sourceCharsPtrLE](LLVMBuilderRef elseBuilder) {
+        return mallocStr(
+            makeEmptyTupleRef(globalState), functionState, elseBuilder, lengthLE, sourceCharsPtrLE);
+      });
+}
+
 LLVMValueRef RCImm::getStringLen(FunctionState* functionState, LLVMBuilderRef builder, Ref ref) {
   auto strWrapperPtrLE =
       kindStructs.makeWrapperPtr(
@@ -700,7 +998,7 @@ void RCImm::discard(
         [this, from, globalState, functionState, sourceRef, sourceMT](
             LLVMBuilderRef thenBuilder) {
           buildFlare(from, globalState, functionState, thenBuilder, "Freeing shared str!");
-          innerDeallocate(from, globalState, functionState, &kindStructs, thenBuilder, sourceMT, sourceRef);
+          deallocateMaybeFromSlab(from, functionState, thenBuilder, sourceMT, sourceRef);
         });
   } else if (auto interfaceRnd = dynamic_cast<InterfaceKind *>(sourceRnd)) {
     buildFlare(FL(), globalState, functionState, builder);
@@ -750,7 +1048,7 @@ void RCImm::discard(
           globalState, functionState,
           builder,
           isZeroLE(builder, rcLE),
-          [from, globalState, functionState, sourceRef, sourceMT](LLVMBuilderRef thenBuilder) {
+          [this, from, globalState, functionState, sourceRef, sourceMT](LLVMBuilderRef thenBuilder) {
             buildFlare(FL(), globalState, functionState, thenBuilder);
             auto immDestructor = globalState->program->getImmDestructor(sourceMT->kind);
             auto funcL = globalState->getFunction(immDestructor->name);
@@ -758,6 +1056,14 @@ void RCImm::discard(
             auto sourceLE =
                 globalState->getRegion(sourceMT)->checkValidReference(FL(),
                     functionState, thenBuilder, sourceMT, sourceRef);
+            if (memoizesExternSerialize(sourceMT->kind)) {
+              // Another object could show up at this address, so its copy can't outlive it.
+              auto sourceI8PtrLE =
+                  LLVMBuildPointerCast(
+                      thenBuilder, sourceLE, LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0),
+                      "sourceI8Ptr");
+              LLVMBuildCall(thenBuilder, globalState->externs->serializeCacheForget, &sourceI8PtrLE, 1, "");
+            }
             std::vector<LLVMValueRef> argExprsL = {sourceLE};
             return LLVMBuildCall(thenBuilder, funcL, argExprsL.data(), argExprsL.size(), "");
           });
@@ -950,9 +1256,7 @@ std::pair<Ref, Ref> RCImm::receiveUnencryptedAlienReference(
     auto strLenLE = sourceRegion->getStringLen(functionState, builder, sourceRef);
     auto strLenBytesPtrLE = sourceRegion->getStringBytesPtr(functionState, builder, sourceRef);
 
-    auto vstrRef =
-        mallocStr(
-            makeEmptyTupleRef(globalState), functionState, builder, strLenLE, strLenBytesPtrLE);
+    auto vstrRef = mallocOrInternStr(functionState, builder, strLenLE, strLenBytesPtrLE);
 
     buildFlare(FL(), globalState, functionState, builder, "done storing");
 
@@ -1100,7 +1404,76 @@ Ref RCImm::topLevelUnserialize(
     LLVMBuilderRef builder,
     Kind* valeKind,
     Ref ref) {
-  return callUnserialize(functionState, builder, valeKind, ref);
+  if (!unserializesIntoSlabs(globalState)) {
+    return callUnserializeRoot(functionState, builder, valeKind, ref);
+  }
+  auto slabHintPtrLE = getUnserializeSlabHintPtr(valeKind);
+  auto slabHintLE = LLVMBuildLoad(builder, slabHintPtrLE, "slabHint");
+  LLVMBuildCall(builder, globalState->externs->slabBegin, &slabHintLE, 1, "");
+  auto resultRef = callUnserializeRoot(functionState, builder, valeKind, ref);
+  auto slabUsedLE = LLVMBuildCall(builder, globalState->externs->slabEnd, nullptr, 0, "slabUsed");
+  LLVMBuildStore(builder, slabUsedLE, slabHintPtrLE);
+  return resultRef;
+}
+
+Ref RCImm::callUnserializeRoot(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Kind* valeKind,
+    Ref ref) {
+  if (!globalState->opt->preserveSharing) {
+    return callUnserialize(functionState, builder, valeKind, ref);
+  }
+  LLVMBuildCall(builder, globalState->externs->sharingBegin, nullptr, 0, "");
+  auto resultRef = callUnserialize(functionState, builder, valeKind, ref);
+  LLVMBuildCall(builder, globalState->externs->sharingEnd, nullptr, 0, "");
+  return resultRef;
+}
+
+Ref RCImm::callUnserializeOrFindShared(
+    FunctionState *functionState,
+    LLVMBuilderRef builder,
+    Reference* hostRefMT,
+    Ref hostRef) {
+  auto valeRefMT = globalState->linearRegion->unlinearizeReference(hostRefMT);
+  if (!globalState->opt->preserveSharing) {
+    return callUnserialize(functionState, builder, valeRefMT->kind, hostRef);
+  }
+  auto int8PtrLT = LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0);
+  auto valeRefLT = translateType(valeRefMT);
+  auto hostLE =
+      globalState->linearRegion->checkValidReference(FL(), functionState, builder, hostRefMT, hostRef);
+  auto hostI8PtrLE = LLVMBuildPointerCast(builder, hostLE, int8PtrLT, "hostI8Ptr");
+  // The linear side has no RCs to tell us what's shared, so we look everything up.
+  auto foundLE = LLVMBuildCall(builder, globalState->externs->sharingFind, &hostI8PtrLE, 1, "sharedObject");
+  auto resultLE =
+      buildSimpleIfElse(
+          globalState, functionState, builder, LLVMBuildIsNull(builder, foundLE, "notFound"), valeRefLT,
+          [this, functionState, valeRefMT, hostRef, hostI8PtrLE, int8PtrLT](LLVMBuilderRef thenBuilder) {
+            auto objectRef = callUnserialize(functionState, thenBuilder, valeRefMT->kind, hostRef);
+            auto objectLE = checkValidReference(FL(), functionState, thenBuilder, valeRefMT, objectRef);
+            std::vector<LLVMValueRef> argsLE = {
+                hostI8PtrLE, LLVMBuildPointerCast(thenBuilder, objectLE, int8PtrLT, "objectI8Ptr")
+            };
+            LLVMBuildCall(thenBuilder, globalState->externs->sharingAdd, argsLE.data(), argsLE.size(), "");
+            return objectLE;
+          },
+          [this, functionState, valeRefMT, valeRefLT, foundLE](LLVMBuilderRef elseBuilder) {
+            auto objectLE = LLVMBuildPointerCast(elseBuilder, foundLE, valeRefLT, "sharedObject");
+            alias(FL(), functionState, elseBuilder, valeRefMT, wrap(this, valeRefMT, objectLE));
+            return objectLE;
+          });
+  return wrap(this, valeRefMT, resultLE);
+}
+
+LLVMValueRef RCImm::isShared(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Reference* refMT,
+    Ref ref) {
+  auto controlBlockPtrLE = kindStructs.getControlBlockPtr(FL(), functionState, builder, ref, refMT);
+  auto rcLE = kindStructs.getStrongRcFromControlBlockPtr(builder, refMT, controlBlockPtrLE);
+  return LLVMBuildICmp(builder, LLVMIntUGT, rcLE, constI32LE(globalState, 1), "isShared");
 }
 
 InterfaceMethod* RCImm::getUnserializeInterfaceMethod(Kind* valeKind) {
@@ -1189,8 +1562,8 @@ void RCImm::defineConcreteUnserializeFunction(Kind* valeKind) {
             dynamic_cast<StaticSizedArrayT*>(hostMemberRefMT->kind) ||
             dynamic_cast<RuntimeSizedArrayT*>(hostMemberRefMT->kind)) {
           auto destinationMemberRef =
-              callUnserialize(
-                  functionState, builder, valeMemberRefMT->kind, hostMemberRef);
+              callUnserializeOrFindShared(
+                  functionState, builder, hostMemberRefMT, hostMemberRef);
           return destinationMemberRef;
         } else if (dynamic_cast<InterfaceKind*>(hostMemberRefMT->kind)) {
           auto destinationMemberRef =
@@ -1206,6 +1579,13 @@ void RCImm::defineConcreteUnserializeFunction(Kind* valeKind) {
         auto hostObjectRefMT = prototype->params[0];
         auto valeObjectRefMT = prototype->returnType;
 
+        if (unserializesIntoSlabs(globalState)) {
+          functionState->slabOffsetPtrLE =
+              makeMidasLocal(
+                  functionState, builder, LLVMInt32TypeInContext(globalState->context), "slabOffsetLocal",
+                  constI32LE(globalState, 0));
+        }
+
         auto hostObjectRef = wrap(globalState->getRegion(hostObjectRefMT), hostObjectRefMT, LLVMGetParam(functionState->containingFuncL, 0));
 
         if (auto valeStructKind = dynamic_cast<StructKind*>(valeObjectRefMT->kind)) {
@@ -1241,7 +1621,7 @@ void RCImm::defineConcreteUnserializeFunction(Kind* valeKind) {
           auto lengthLE = globalState->getRegion(hostObjectRefMT)->getStringLen(functionState, builder, hostObjectRef);
           auto sourceBytesPtrLE = globalState->getRegion(hostObjectRefMT)->getStringBytesPtr(functionState, builder, hostObjectRef);
 
-          auto strRef = mallocStr(makeEmptyTupleRef(globalState), functionState, builder, lengthLE, sourceBytesPtrLE);
+          auto strRef = mallocOrInternStr(functionState, builder, lengthLE, sourceBytesPtrLE);
 
           buildFlare(FL(), globalState, functionState, builder, "done storing");
 
@@ -1261,20 +1641,32 @@ void RCImm::defineConcreteUnserializeFunction(Kind* valeKind) {
           auto valeMemberRefMT = globalState->program->getRuntimeSizedArray(valeRsaMT)->rawArray->elementType;
           auto hostMemberRefMT = globalState->linearRegion->linearizeReference(valeMemberRefMT);
 
-          intRangeLoopReverse(
-              globalState, functionState, builder, globalState->metalCache->i32, lengthRef,
-              [this, functionState, hostObjectRefMT, valeRsaRef, hostMemberRefMT, valeObjectRefMT, hostRsaMT, valeRsaMT, hostObjectRef, valeMemberRefMT, unserializeMemberOrElement](
-                  Ref indexRef, LLVMBuilderRef bodyBuilder){
-                auto hostMemberRef =
-                    globalState->getRegion(hostObjectRefMT)
-                        ->loadElementFromRSA(functionState, bodyBuilder, hostObjectRefMT, hostRsaMT, hostObjectRef, true, indexRef)
-                        .move();
-                auto valeElementRef =
-                    unserializeMemberOrElement(
-                        functionState, bodyBuilder, hostMemberRefMT, hostMemberRef);
-                initializeElementInRSA(
-                    functionState, bodyBuilder, valeObjectRefMT, valeRsaMT, valeRsaRef, true, indexRef, valeElementRef);
-              });
+          if (globalState->opt->bulkCopyPrimitiveArrays &&
+              globalState->linearRegion->isBulkCopyableElement(valeMemberRefMT)) {
+            auto lengthRefMT = globalState->getLengthRefMT();
+            auto lengthLE =
+                globalState->getRegion(lengthRefMT)->checkValidReference(FL(), functionState, builder, lengthRefMT, lengthRef);
+            globalState->linearRegion->copyElementsInBulk(
+                functionState, builder, valeMemberRefMT,
+                getArrayElementsI8Ptr(functionState, builder, valeRsaRefMT, valeRsaRef),
+                globalState->linearRegion->getArrayElementsI8Ptr(functionState, builder, hostObjectRefMT, hostObjectRef),
+                lengthLE);
+          } else {
+            intRangeLoopReverse(
+                globalState, functionState, builder, globalState->getLengthMT(), lengthRef,
+                [this, functionState, hostObjectRefMT, valeRsaRef, hostMemberRefMT, valeObjectRefMT, hostRsaMT, valeRsaMT, hostObjectRef, valeMemberRefMT, unserializeMemberOrElement](
+                    Ref indexRef, LLVMBuilderRef bodyBuilder){
+                  auto hostMemberRef =
+                      globalState->getRegion(hostObjectRefMT)
+                          ->loadElementFromRSA(functionState, bodyBuilder, hostObjectRefMT, hostRsaMT, hostObjectRef, true, indexRef)
+                          .move();
+                  auto valeElementRef =
+                      unserializeMemberOrElement(
+                          functionState, bodyBuilder, hostMemberRefMT, hostMemberRef);
+                  initializeElementInRSA(
+                      functionState, bodyBuilder, valeObjectRefMT, valeRsaMT, valeRsaRef, true, indexRef, valeElementRef);
+                });
+          }
 
           LLVMBuildRet(builder, checkValidReference(FL(), functionState, builder, valeRsaRefMT, valeRsaRef));
         } else if (auto valeSsaMT = dynamic_cast<StaticSizedArrayT*>(valeObjectRefMT->kind)) {
@@ -1291,22 +1683,31 @@ void RCImm::defineConcreteUnserializeFunction(Kind* valeKind) {
           int length = valeSsaDefM->size;
           auto valeMemberRefMT = valeSsaDefM->rawArray->elementType;
 
-          intRangeLoopReverse(
-              globalState, functionState, builder, globalState->metalCache->i32, globalState->constI32(length),
-              [this, functionState, hostObjectRefMT, valeSsaRef, valeObjectRefMT, hostSsaMT, valeSsaMT, hostObjectRef, valeMemberRefMT, unserializeMemberOrElement](
-                  Ref indexRef, LLVMBuilderRef bodyBuilder){
-
-                auto hostMemberRef =
-                    globalState->getRegion(hostObjectRefMT)
-                        ->loadElementFromSSA(functionState, bodyBuilder, hostObjectRefMT, hostSsaMT, hostObjectRef, true, indexRef)
-                        .move();
-                auto hostMemberRefMT = globalState->linearRegion->linearizeReference(valeMemberRefMT);
-                auto valeElementRef =
-                    unserializeMemberOrElement(
-                        functionState, bodyBuilder, hostMemberRefMT, hostMemberRef);
-                initializeElementInSSA(
-                    functionState, bodyBuilder, valeObjectRefMT, valeSsaMT, valeSsaRef, true, indexRef, valeElementRef);
-              });
+          if (globalState->opt->bulkCopyPrimitiveArrays &&
+              globalState->linearRegion->isBulkCopyableElement(valeMemberRefMT)) {
+            globalState->linearRegion->copyElementsInBulk(
+                functionState, builder, valeMemberRefMT,
+                getArrayElementsI8Ptr(functionState, builder, valeSsaRefMT, valeSsaRef),
+                globalState->linearRegion->getArrayElementsI8Ptr(functionState, builder, hostObjectRefMT, hostObjectRef),
+                constI32LE(globalState, length));
+          } else {
+            intRangeLoopReverse(
+                globalState, functionState, builder, globalState->metalCache->i32, globalState->constI32(length),
+                [this, functionState, hostObjectRefMT, valeSsaRef, valeObjectRefMT, hostSsaMT, valeSsaMT, hostObjectRef, valeMemberRefMT, unserializeMemberOrElement](
+                    Ref indexRef, LLVMBuilderRef bodyBuilder){
+
+                  auto hostMemberRef =
+                      globalState->getRegion(hostObjectRefMT)
+                          ->loadElementFromSSA(functionState, bodyBuilder, hostObjectRefMT, hostSsaMT, hostObjectRef, true, indexRef)
+                          .move();
+                  auto hostMemberRefMT = globalState->linearRegion->linearizeReference(valeMemberRefMT);
+                  auto valeElementRef =
+                      unserializeMemberOrElement(
+                          functionState, bodyBuilder, hostMemberRefMT, hostMemberRef);
+                  initializeElementInSSA(
+                      functionState, bodyBuilder, valeObjectRefMT, valeSsaMT, valeSsaRef, true, indexRef, valeElementRef);
+                });
+          }
 
 
           LLVMBuildRet(builder, checkValidReference(FL(), functionState, builder, valeSsaRefMT, valeSsaRef));
@@ -339,6 +339,54 @@ public:
       LLVMValueRef lengthLE,
       LLVMValueRef sourceCharsPtrLE) override;
 
+  // Returns the literal as a pointer to a global Str, made the first time we see these contents.
+  // Its RC starts so high that it never reaches zero, so it's never freed.
+  Ref constantStr(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      const std::string& contents);
+
+  // Like mallocStr, but with --intern-single-char-strings, single-char strings come from a table of
+  // immortal Strs instead of the heap.
+  Ref mallocOrInternStr(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      LLVMValueRef lengthLE,
+      LLVMValueRef sourceCharsPtrLE);
+
+  // Whether an extern can read this object in place instead of getting a linear copy. That's
+  // when everything after the control block is laid out exactly like the linear version: structs
+  // of ints and floats, and arrays of them.
+  bool canLendToExtern(Kind* valeKind);
+
+  // Points past the control block, typed as the linear version. The caller has to keep its
+  // reference alive until the extern returns.
+  LLVMValueRef lendToExtern(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      Reference* valeRefMT,
+      Ref valeRef);
+
+  // Whether anything besides this reference points at the object, so a serialize could run into
+  // it again. For --preserve-sharing.
+  LLVMValueRef isShared(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      Reference* refMT,
+      Ref ref);
+
+  // Whether we keep the linear copy of objects of this kind once we've sent one to an extern,
+  // to lend out again next time. That's for the structs and arrays that externs take, with
+  // --memoize-extern-serialize, unless they can be lent in place instead.
+  bool memoizesExternSerialize(Kind* valeKind);
+
+  // For copying primitive elements in and out of linear arrays in bulk.
+  LLVMValueRef getArrayElementsI8Ptr(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      Reference* arrayRefMT,
+      Ref arrayRef);
+
   RegionId* getRegionId() override;
 
   LLVMValueRef getStringLen(FunctionState* functionState, LLVMBuilderRef builder, Ref ref) override;
@@ -448,12 +496,34 @@ private:
 
   InterfaceMethod* getUnserializeInterfaceMethod(Kind* valeKind);
 
+  // Wraps a pointer to one of our immortal Strs, counting the new reference.
+  Ref wrapImmortalStr(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      LLVMValueRef strPtrLE);
+
   Ref callUnserialize(
       FunctionState *functionState,
       LLVMBuilderRef builder,
       Kind* valeKind,
       Ref objectRef);
 
+  // Unserializes the root object of a buffer. With --preserve-sharing, this is where we start
+  // remembering the objects we make, see sharing.c.
+  Ref callUnserializeRoot(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      Kind* valeKind,
+      Ref ref);
+
+  // Unserializes an object that something else in the buffer points to. With --preserve-sharing,
+  // if we already made a Vale object from this linear one, shares that instead.
+  Ref callUnserializeOrFindShared(
+      FunctionState *functionState,
+      LLVMBuilderRef builder,
+      Reference* hostRefMT,
+      Ref hostRef);
+
   // Does the entire serialization process: measuring the length, allocating a buffer, and
   // serializing into it.
   Ref topLevelUnserialize(
@@ -462,11 +532,32 @@ private:
       Kind* valeKind,
       Ref ref);
 
+  // Frees the object, or if we unserialized it into a slab, lets the slab know.
+  void deallocateMaybeFromSlab(
+      AreaAndFileAndLine from,
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      Reference* refMT,
+      Ref ref);
+
+  // A global with how many bytes the last unserialize of this kind took, to size the next slab.
+  LLVMValueRef getUnserializeSlabHintPtr(Kind* valeKind);
+
   GlobalState* globalState = nullptr;
 
   KindStructs kindStructs;
 
   DefaultPrimitives primitives;
+
+  std::unordered_map<std::string, LLVMValueRef> constantStrs;
+  // A global array of 256 immortal single-char Strs, one per byte value, made on first use.
+  LLVMValueRef singleCharStrsLE = nullptr;
+
+  // Kinds that externs take without a size param, see memoizesExternSerialize. Filled on first use.
+  std::unordered_set<Kind*, AddressHasher<Kind*>> memoizableExternParamKinds;
+  bool memoizableExternParamKindsCollected = false;
+
+  std::unordered_map<Kind*, LLVMValueRef, AddressHasher<Kind*>> unserializeSlabHintPtrByKind;
 };
 
 #endif
@@ -658,7 +658,7 @@ Ref ResilientV3::storeElementInRSA(
   auto arrayElementsPtrLE = getRuntimeSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   buildFlare(FL(), globalState, functionState, builder);
   return ::swapElement(
-      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, sizeRef,
+      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, globalState->getLengthMT(), sizeRef,
       arrayElementsPtrLE,
       indexRef, elementRef);
 }
@@ -913,7 +913,7 @@ void ResilientV3::initializeElementInSSA(
   auto sizeRef = globalState->constI32(ssaDef->size);
   auto arrayElementsPtrLE = getStaticSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   ::initializeElement(
-      globalState, functionState, builder, ssaRefMT->location, ssaDef->rawArray->elementType, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+      globalState, functionState, builder, ssaRefMT->location, ssaDef->rawArray->elementType, globalState->metalCache->i32, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
 }
 
 Ref ResilientV3::deinitializeElementFromSSA(
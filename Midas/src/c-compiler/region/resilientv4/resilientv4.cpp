@@ -675,7 +675,7 @@ Ref ResilientV4::storeElementInRSA(
   auto arrayElementsPtrLE = getRuntimeSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   buildFlare(FL(), globalState, functionState, builder);
   return ::swapElement(
-      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, sizeRef,
+      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, globalState->getLengthMT(), sizeRef,
       arrayElementsPtrLE,
       indexRef, elementRef);
 }
@@ -740,8 +740,8 @@ void ResilientV4::deallocate(
           buildFlare(FL(), globalState, functionState, thenBuilder);
           auto lenRef = getRuntimeSizedArrayLength(functionState, thenBuilder, refMT, ref, true);
           numElementsLE =
-              globalState->getRegion(globalState->metalCache->i32Ref)
-                  ->checkValidReference(FL(), functionState, thenBuilder, globalState->metalCache->i32Ref, lenRef);
+              globalState->getRegion(globalState->getLengthRefMT())
+                  ->checkValidReference(FL(), functionState, thenBuilder, globalState->getLengthRefMT(), lenRef);
         } else if (auto ssaMT = dynamic_cast<StaticSizedArrayT*>(refMT->kind)) {
           auto ssaDefM = globalState->program->getStaticSizedArray(ssaMT);
           buildFlare(FL(), globalState, functionState, thenBuilder);
@@ -980,7 +980,7 @@ void ResilientV4::initializeElementInSSA(
   auto sizeRef = globalState->constI32(ssaDef->size);
   auto arrayElementsPtrLE = getStaticSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   ::initializeElement(
-      globalState, functionState, builder, ssaRefMT->location, ssaDef->rawArray->elementType, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+      globalState, functionState, builder, ssaRefMT->location, ssaDef->rawArray->elementType, globalState->metalCache->i32, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
 }
 
 Ref ResilientV4::deinitializeElementFromSSA(
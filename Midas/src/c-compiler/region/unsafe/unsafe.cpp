@@ -647,7 +647,7 @@ Ref Unsafe::storeElementInRSA(
   auto arrayElementsPtrLE = getRuntimeSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   buildFlare(FL(), globalState, functionState, builder);
   return ::swapElement(
-      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, globalState->getLengthMT(), sizeRef, arrayElementsPtrLE, indexRef, elementRef);
 }
 
 Ref Unsafe::upcast(
@@ -849,7 +849,7 @@ void Unsafe::initializeElementInRSA(
   auto sizeRef = ::getRuntimeSizedArrayLength(globalState, functionState, builder, arrayWrapperPtrLE);
   auto arrayElementsPtrLE = getRuntimeSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   ::initializeElement(
-      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+      globalState, functionState, builder, rsaRefMT->location, rsaDef->rawArray->elementType, globalState->getLengthMT(), sizeRef, arrayElementsPtrLE, indexRef, elementRef);
 }
 
 Ref Unsafe::deinitializeElementFromRSA(
@@ -882,7 +882,7 @@ void Unsafe::initializeElementInSSA(
   auto sizeRef = globalState->constI32(ssaDef->size);
   auto arrayElementsPtrLE = getStaticSizedArrayContentsPtr(builder, arrayWrapperPtrLE);
   ::initializeElement(
-      globalState, functionState, builder, ssaRefMT->location, ssaDef->rawArray->elementType, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
+      globalState, functionState, builder, ssaRefMT->location, ssaDef->rawArray->elementType, globalState->metalCache->i32, sizeRef, arrayElementsPtrLE, indexRef, elementRef);
 }
 
 Ref Unsafe::deinitializeElementFromSSA(
@@ -0,0 +1,141 @@
+#include <string>
+#include <vector>
+
+#include <function/expressions/shared/shared.h>
+#include "aliasing.h"
+
+namespace {
+
+LLVMValueRef makeMDNode(GlobalState* globalState, std::vector<LLVMValueRef> operands) {
+  return LLVMMDNodeInContext(globalState->context, operands.data(), operands.size());
+}
+
+LLVMValueRef makeMDString(GlobalState* globalState, const std::string& str) {
+  return LLVMMDStringInContext(globalState->context, str.c_str(), str.size());
+}
+
+// Only scalars get tags; an aggregate member (like a fat pointer) could be split up by SROA into
+// pieces at other offsets.
+bool isTbaaScalar(LLVMTypeRef typeLT) {
+  switch (LLVMGetTypeKind(typeLT)) {
+    case LLVMIntegerTypeKind:
+    case LLVMDoubleTypeKind:
+    case LLVMPointerTypeKind:
+      return true;
+    default:
+      return false;
+  }
+}
+
+LLVMValueRef getTbaaScalarNode(GlobalState* globalState, LLVMTypeRef typeLT) {
+  // LLVM uniques metadata nodes by their contents, so making these again gives the same node.
+  auto rootLE = makeMDNode(globalState, {makeMDString(globalState, "Vale TBAA")});
+  auto charLE =
+      makeMDNode(globalState, {
+          makeMDString(globalState, "omnipotent char"), rootLE, constI64LE(globalState, 0)});
+  std::string name;
+  switch (LLVMGetTypeKind(typeLT)) {
+    case LLVMIntegerTypeKind:
+      name = "i" + std::to_string(LLVMGetIntTypeWidth(typeLT));
+      break;
+    case LLVMDoubleTypeKind:
+      name = "double";
+      break;
+    case LLVMPointerTypeKind:
+      name = "any pointer";
+      break;
+    default:
+      assert(false);
+  }
+  return makeMDNode(globalState, {makeMDString(globalState, name), charLE, constI64LE(globalState, 0)});
+}
+
+LLVMValueRef getTbaaStructNode(GlobalState* globalState, LLVMTypeRef innerStructLT) {
+  auto iter = globalState->tbaaStructTypeNodes.find(innerStructLT);
+  if (iter != globalState->tbaaStructTypeNodes.end()) {
+    return iter->second;
+  }
+  std::vector<LLVMValueRef> operands;
+  operands.push_back(makeMDString(globalState, LLVMGetStructName(innerStructLT)));
+  for (int i = 0; i < LLVMCountStructElementTypes(innerStructLT); i++) {
+    auto memberLT = LLVMStructGetTypeAtIndex(innerStructLT, i);
+    if (isTbaaScalar(memberLT)) {
+      operands.push_back(getTbaaScalarNode(globalState, memberLT));
+      operands.push_back(
+          constI64LE(globalState, LLVMOffsetOfElement(globalState->dataLayout, innerStructLT, i)));
+    }
+  }
+  auto nodeLE = makeMDNode(globalState, operands);
+  globalState->tbaaStructTypeNodes.emplace(innerStructLT, nodeLE);
+  return nodeLE;
+}
+
+}
+
+void addParamAliasAttributes(
+    GlobalState* globalState,
+    LLVMValueRef functionL,
+    Prototype* prototype) {
+  auto nonnullKind = LLVMGetEnumAttributeKindForName("nonnull", 7);
+  auto alignKind = LLVMGetEnumAttributeKindForName("align", 5);
+  auto dereferenceableKind = LLVMGetEnumAttributeKindForName("dereferenceable", 15);
+
+  for (int i = 0; i < prototype->params.size(); i++) {
+    auto paramMT = prototype->params[i];
+    auto paramLT = LLVMTypeOf(LLVMGetParam(functionL, i));
+    // Regions with fat pointers (generations, weak refs, interfaces) pass a struct instead.
+    if (LLVMGetTypeKind(paramLT) != LLVMPointerTypeKind) {
+      continue;
+    }
+    if (paramMT->ownership != Ownership::OWN &&
+        paramMT->ownership != Ownership::BORROW &&
+        paramMT->ownership != Ownership::SHARE) {
+      continue;
+    }
+    auto pointeeLT = LLVMGetElementType(paramLT);
+    if (!LLVMTypeIsSized(pointeeLT)) {
+      continue;
+    }
+    // LLVM counts parameters from 1, 0 is the return.
+    auto attrIndex = i + 1;
+    LLVMAddAttributeAtIndex(
+        functionL, attrIndex, LLVMCreateEnumAttribute(globalState->context, nonnullKind, 0));
+    LLVMAddAttributeAtIndex(
+        functionL, attrIndex,
+        LLVMCreateEnumAttribute(
+            globalState->context, alignKind,
+            LLVMABIAlignmentOfType(globalState->dataLayout, pointeeLT)));
+    // The owner can't free an object while someone's borrowing it (it would halt, or in unsafe
+    // mode it's already undefined), so a borrowed object stays readable for the whole call. An
+    // owning or shared ref might be freed by this very function, so those don't get this.
+    if (paramMT->ownership == Ownership::BORROW) {
+      LLVMAddAttributeAtIndex(
+          functionL, attrIndex,
+          LLVMCreateEnumAttribute(
+              globalState->context, dereferenceableKind,
+              LLVMABISizeOfType(globalState->dataLayout, pointeeLT)));
+    }
+  }
+}
+
+void addMemberTbaaTag(
+    GlobalState* globalState,
+    LLVMValueRef loadOrStoreLE,
+    LLVMTypeRef innerStructLT,
+    int memberIndex) {
+  if (!globalState->opt->emitAliasMetadata ||
+      LLVMGetTypeKind(innerStructLT) != LLVMStructTypeKind ||
+      LLVMGetStructName(innerStructLT) == nullptr) {
+    return;
+  }
+  auto memberLT = LLVMStructGetTypeAtIndex(innerStructLT, memberIndex);
+  if (!isTbaaScalar(memberLT)) {
+    return;
+  }
+  auto accessTagLE =
+      makeMDNode(globalState, {
+          getTbaaStructNode(globalState, innerStructLT),
+          getTbaaScalarNode(globalState, memberLT),
+          constI64LE(globalState, LLVMOffsetOfElement(globalState->dataLayout, innerStructLT, memberIndex))});
+  LLVMSetMetadata(loadOrStoreLE, LLVMGetMDKindIDInContext(globalState->context, "tbaa", 4), accessTagLE);
+}
@@ -0,0 +1,23 @@
+#ifndef UTILS_ALIASING_H_
+#define UTILS_ALIASING_H_
+
+#include <llvm-c/Core.h>
+#include <globalstate.h>
+
+// Tells LLVM what Vale's types already guarantee about a function's pointer parameters: they're
+// never null and are aligned, and a borrowed object can't be freed while the function has it.
+void addParamAliasAttributes(
+    GlobalState* globalState,
+    LLVMValueRef functionL,
+    Prototype* prototype);
+
+// Tags a load or store of a struct member with a TBAA access tag, so LLVM knows it can't alias a
+// member of a different struct. innerStructLT is the struct's contents type, without the control
+// block.
+void addMemberTbaaTag(
+    GlobalState* globalState,
+    LLVMValueRef loadOrStoreLE,
+    LLVMTypeRef innerStructLT,
+    int memberIndex);
+
+#endif
@@ -4,11 +4,17 @@
 
 #include <functional>
 
-void buildIf(
+// How much more likely we say the fallthrough is than a cold then block. This is what clang uses
+// for __builtin_expect.
+constexpr int COLD_BRANCH_WEIGHT = 1;
+constexpr int HOT_BRANCH_WEIGHT = 2000;
+
+static void buildIfWithWeights(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
     LLVMValueRef conditionLE,
+    bool thenIsCold,
     std::function<void(LLVMBuilderRef)> buildThen) {
 
   // We already are in the "current" block (which is what `builder` is
@@ -35,7 +41,19 @@ void buildIf(
           functionState->containingFuncL,
           functionState->nextBlockName().c_str());
 
-  LLVMBuildCondBr(builder, conditionLE, thenStartBlockL, afterwardBlockL);
+  auto condBrLE = LLVMBuildCondBr(builder, conditionLE, thenStartBlockL, afterwardBlockL);
+  if (thenIsCold) {
+    auto int32LT = LLVMInt32TypeInContext(globalState->context);
+    std::vector<LLVMValueRef> weightsLE = {
+        LLVMMDStringInContext(globalState->context, "branch_weights", 14),
+        LLVMConstInt(int32LT, COLD_BRANCH_WEIGHT, false),
+        LLVMConstInt(int32LT, HOT_BRANCH_WEIGHT, false)
+    };
+    LLVMSetMetadata(
+        condBrLE,
+        LLVMGetMDKindIDInContext(globalState->context, "prof", 4),
+        LLVMMDNodeInContext(globalState->context, weightsLE.data(), weightsLE.size()));
+  }
 
   // Now, we fill in the "then" block.
   buildThen(thenBlockBuilder);
@@ -56,6 +74,24 @@ void buildIf(
   // subsequent instructions after the if will keep adding to that.
 }
 
+void buildIf(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    LLVMValueRef conditionLE,
+    std::function<void(LLVMBuilderRef)> buildThen) {
+  buildIfWithWeights(globalState, functionState, builder, conditionLE, false, buildThen);
+}
+
+void buildColdIf(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    LLVMValueRef conditionLE,
+    std::function<void(LLVMBuilderRef)> buildThen) {
+  buildIfWithWeights(globalState, functionState, builder, conditionLE, true, buildThen);
+}
+
 LLVMValueRef buildSimpleIfElse(
     GlobalState* globalState,
     FunctionState* functionState,
@@ -47,6 +47,15 @@ void buildIf(
     LLVMValueRef conditionLE,
     std::function<void(LLVMBuilderRef)> buildThen);
 
+// Like buildIf, but tells LLVM the then block almost never runs, like when a check fails. LLVM then
+// lays out the rest of the function as the fallthrough and moves the then block out of the way.
+void buildColdIf(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    LLVMValueRef conditionLE,
+    std::function<void(LLVMBuilderRef)> buildThen);
+
 
 void buildWhile(
     GlobalState* globalState,
@@ -31,6 +31,7 @@
 #include <llvm-c/Transforms/Scalar.h>
 #include <llvm-c/Transforms/Utils.h>
 #include <llvm-c/Transforms/IPO.h>
+#include <llvm-c/Transforms/InstCombine.h>
 #include <region/assist/assist.h>
 #include <region/resilientv3/resilientv3.h>
 #include <region/unsafe/unsafe.h>
@@ -329,7 +330,7 @@ std::string generateFunctionC(
         case CFuncLineMode::EXTERN_USER_PROTOTYPE:
         case CFuncLineMode::EXPORT_INTERMEDIATE_PROTOTYPE:
         case CFuncLineMode::EXPORT_USER_PROTOTYPE:
-          s << "ValeInt param" << i << "size";
+          s << "ValeLength param" << i << "size";
           break;
         case CFuncLineMode::EXTERN_INTERMEDIATE_BODY:
         case CFuncLineMode::EXPORT_INTERMEDIATE_BODY:
@@ -479,6 +480,10 @@ void generateExports(GlobalState* globalState, Prototype* mainM) {
         // Dont generate C code for built in externs
         continue;
       }
+      if (isSnapshotExtern(prototype)) {
+        // These have no C function behind them, see buildSnapshotExternCall.
+        continue;
+      }
       auto* headerC = &packageCoordToHeaderNameToC[packageCoord].emplace(externName, std::stringstream()).first->second;
       auto* sourceC = &packageCoordToSourceNameToC[packageCoord].emplace(externName, std::stringstream()).first->second;
       makeExternOrExportFunction(globalState, headerC, sourceC, packageCoord, package, externName, prototype, false);
@@ -523,9 +528,19 @@ void generateExports(GlobalState* globalState, Prototype* mainM) {
   builtinExportsCode << "#include <stdlib.h>" << std::endl;
   builtinExportsCode << "#include <string.h>" << std::endl;
   builtinExportsCode << "typedef int32_t ValeInt;" << std::endl;
-  builtinExportsCode << "typedef struct { ValeInt length; char chars[0]; } ValeStr;" << std::endl;
-  builtinExportsCode << "ValeStr* ValeStrNew(ValeInt length);" << std::endl;
+  // Array and string lengths, and the sizes of what we send to externs. Keep in sync with the
+  // VALE_WIDE_LENGTHS in builtins/ValeBuiltins.h.
+  builtinExportsCode << "typedef " << (globalState->opt->wideLengths ? "int64_t" : "int32_t") << " ValeLength;" << std::endl;
+  builtinExportsCode << "typedef struct { ValeLength length; char chars[0]; } ValeStr;" << std::endl;
+  builtinExportsCode << "ValeStr* ValeStrNew(ValeLength length);" << std::endl;
   builtinExportsCode << "ValeStr* ValeStrFrom(char* source);" << std::endl;
+  // See snapshot.c.
+  builtinExportsCode << "// Only one snapshot of each type can be mapped at a time. Each type gets one of 64" << std::endl;
+  builtinExportsCode << "// address slots from its hash; Midas refuses to compile a program whose snapshot types collide." << std::endl;
+  builtinExportsCode << "void* __vale_snapshotMap(const char* path, uint64_t typeHash);" << std::endl;
+  builtinExportsCode << "void* __vale_snapshotRoot(void* snapshot);" << std::endl;
+  builtinExportsCode << "int64_t __vale_snapshotRootType(void* snapshot);" << std::endl;
+  builtinExportsCode << "void __vale_snapshotUnmap(void* snapshot);" << std::endl;
   builtinExportsCode << "#endif" << std::endl;
 
   std::string builtinsFilePath = makeIncludeDirectory(globalState) + "/ValeBuiltins.h";
@@ -534,6 +549,31 @@ void generateExports(GlobalState* globalState, Prototype* mainM) {
   out << builtinExportsCode.str();
 }
 
+// The prototype of an export's _batch variant, see exportBatchFunction. If forAbi, it's the one
+// Midas defines, otherwise it's the one the user calls.
+std::string generateBatchExportPrototypeC(
+    GlobalState* globalState,
+    Package* package,
+    const std::string& exportName,
+    Prototype* prototype,
+    bool forAbi) {
+  std::string userFuncName =
+      (!package->packageCoordinate->projectName.empty() ? package->packageCoordinate->projectName + "_" : "") +
+      exportName + "_batch";
+  std::stringstream s;
+  s << "void " << (forAbi ? "vale_abi_" : "") << userFuncName << "(ValeInt count";
+  if (!translatesToCVoid(globalState, prototype->returnType)) {
+    s << ", " << globalState->getRegion(prototype->returnType)->getExportName(package, prototype->returnType, true)
+      << "* results";
+  }
+  for (int i = 0; i < prototype->params.size(); i++) {
+    s << ", " << globalState->getRegion(prototype->params[i])->getExportName(package, prototype->params[i], true)
+      << "* param" << i << "s";
+  }
+  s << ")";
+  return s.str();
+}
+
 void makeExternOrExportFunction(
     GlobalState *globalState,
     std::stringstream* headerC,
@@ -587,6 +627,30 @@ void makeExternOrExportFunction(
   userSourceC << "  " << generateFunctionC(globalState, package, externName, prototype, isExport ? CFuncLineMode::EXPORT_INTERMEDIATE_BODY : CFuncLineMode::EXTERN_INTERMEDIATE_BODY, isExport) << ";" << std::endl;
   userSourceC << "}" << std::endl;
   (*sourceC) << userSourceC.str();
+
+  if (isExport && globalState->opt->batchExports && canBatchExport(globalState, prototype)) {
+    auto userBatchC = generateBatchExportPrototypeC(globalState, package, externName, prototype, false);
+    auto abiBatchC = generateBatchExportPrototypeC(globalState, package, externName, prototype, true);
+    (*headerC) << "// Calls " << externName << " on param0s[i], param1s[i], ... for each i below count";
+    if (!translatesToCVoid(globalState, prototype->returnType)) {
+      (*headerC) << ", putting the result in results[i]";
+    }
+    (*headerC) << "." << std::endl;
+    (*headerC) << "extern " << userBatchC << ";" << std::endl;
+    (*headerC) << "extern " << abiBatchC << ";" << std::endl;
+
+    (*sourceC) << "extern " << userBatchC << " {" << std::endl;
+    (*sourceC) << "  vale_abi_" << (!packageCoord->projectName.empty() ? packageCoord->projectName + "_" : "")
+               << externName << "_batch(count";
+    if (!translatesToCVoid(globalState, prototype->returnType)) {
+      (*sourceC) << ", results";
+    }
+    for (int i = 0; i < prototype->params.size(); i++) {
+      (*sourceC) << ", param" << i << "s";
+    }
+    (*sourceC) << ");" << std::endl;
+    (*sourceC) << "}" << std::endl;
+  }
 }
 
 std::ofstream makeCFile(const std::string &filepath) {
@@ -1003,6 +1067,7 @@ void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFi
       auto structM = p.second;
       for (auto e : structM->edges) {
         globalState->getRegion(structM->regionId)->declareEdge(e);
+        globalState->edgesByInterface[e->interfaceName].push_back(e);
         if (structM->mutability == Mutability::IMMUTABLE) {
           globalState->linearRegion->declareEdge(e);
         }
@@ -1118,6 +1183,8 @@ void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFi
     region.second->defineExtraFunctions();
   }
 
+  globalState->linearRegion->checkSnapshotSlots();
+
   for (auto[packageCoord, package] : program.packages) {
     for (auto[externName, prototype] : package->externNameToFunction) {
       declareExternFunction(globalState, package, prototype);
@@ -1136,10 +1203,17 @@ void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFi
       if (!skipExporting) {
         auto function = program.getFunction(prototype->name);
         exportFunction(globalState, package, function);
+        if (globalState->opt->batchExports && canBatchExport(globalState, prototype)) {
+          exportBatchFunction(globalState, package, function);
+        }
       }
     }
   }
 
+  if (globalState->opt->elideChecksForKnownLive && globalState->opt->inferKnownLive) {
+    globalState->nonFreeingFunctionNames = findNonFreeingFunctions(globalState, &program);
+  }
+
   for (auto[packageCoord, package] : program.packages) {
     for (auto p : package->functions) {
       auto name = p.first;
@@ -1147,6 +1221,10 @@ void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFi
       translateFunction(globalState, function);
     }
   }
+  if (globalState->opt->printOptStats && globalState->numInterfaceCalls > 0) {
+    std::cout << "Devirtualization: made " << globalState->numDevirtualizedInterfaceCalls
+        << " of " << globalState->numInterfaceCalls << " interface calls direct" << std::endl;
+  }
 
   // We translate the edges after the functions are declared because the
   // functions have to exist for the itables to point to them.
@@ -1177,6 +1255,7 @@ void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFi
         for (auto i : globalState->regions) {
           i.second->mainCleanup(functionState, builder);
         }
+        LLVMBuildCall(builder, globalState->externs->flush, nullptr, 0, "");
         LLVMBuildRet(builder, constI64LE(globalState, 0));
       });
 
@@ -1202,6 +1281,10 @@ void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFi
   auto entryFuncL = makeEntryFunction(globalState, valeMainPrototype);
 
   generateExports(globalState, mainM);
+
+  if (globalState->opt->wholeProgramIpo) {
+    internalizeFunctions(globalState);
+  }
 }
 
 void createModule(std::vector<std::string>& inputFilepaths, GlobalState *globalState) {
@@ -1354,6 +1437,22 @@ void generateModule(std::vector<std::string>& inputFilepaths, GlobalState *globa
 //    LLVMAddFunctionInliningPass(passmgr);        // Function inlining
 //  }
 
+  if (globalState->opt->wholeProgramIpo) {
+    // Everything but the exports is internal now (see internalizeFunctions), so these can see
+    // every call to a function. GlobalOpt switches internal functions to fastcc when nothing
+    // takes their address, which is only safe once it knows every caller.
+    LLVMAddPromoteMemoryToRegisterPass(passmgr);
+    LLVMAddGlobalOptimizerPass(passmgr);
+    LLVMAddIPSCCPPass(passmgr);
+    LLVMAddDeadArgEliminationPass(passmgr);
+    LLVMAddFunctionInliningPass(passmgr);
+    LLVMAddArgumentPromotionPass(passmgr);
+    LLVMAddInstructionCombiningPass(passmgr);
+    LLVMAddCFGSimplificationPass(passmgr);
+    LLVMAddGlobalDCEPass(passmgr);
+    LLVMAddStripDeadPrototypesPass(passmgr);
+  }
+
   LLVMRunPassManager(passmgr, globalState->mod);
   LLVMDisposePassManager(passmgr);
 
@@ -46,7 +46,26 @@ enum
     OPT_GEN_HEAP,
     OPT_ELIDE_CHECKS_FOR_KNOWN_LIVE,
     OPT_OVERRIDE_KNOWN_LIVE_TRUE,
+    OPT_INFER_KNOWN_LIVE,
     OPT_PRINT_MEM_OVERHEAD,
+    OPT_ELIDE_RC_ADJUSTMENTS,
+    OPT_HOIST_LOOP_CHECKS,
+    OPT_STACK_ALLOCATE_STRUCTS,
+    OPT_DEVIRTUALIZE_INTERFACE_CALLS,
+    OPT_ALIAS_METADATA,
+    OPT_WHOLE_PROGRAM_IPO,
+    OPT_STATIC_STRINGS,
+    OPT_INTERN_SINGLE_CHAR_STRINGS,
+    OPT_BORROW_STRING_BUILTINS,
+    OPT_SINGLE_PASS_SERIALIZE,
+    OPT_BULK_COPY_PRIMITIVE_ARRAYS,
+    OPT_ZERO_COPY_EXTERNS,
+    OPT_MEMOIZE_EXTERN_SERIALIZE,
+    OPT_SLAB_UNSERIALIZE,
+    OPT_PRESERVE_SHARING,
+    OPT_BATCH_EXPORTS,
+    OPT_WIDE_LENGTHS,
+    OPT_PRINT_OPT_STATS,
     OPT_CENSUS,
     OPT_REGION_OVERRIDE,
     OPT_FILENAMES,
@@ -90,7 +109,26 @@ static opt_arg_t args[] =
     { "gen-heap", '\0', OPT_ARG_OPTIONAL, OPT_GEN_HEAP },
     { "elide-checks-for-known-live", '\0', OPT_ARG_OPTIONAL, OPT_ELIDE_CHECKS_FOR_KNOWN_LIVE },
     { "override-known-live-true", '\0', OPT_ARG_NONE, OPT_OVERRIDE_KNOWN_LIVE_TRUE },
+    { "infer-known-live", '\0', OPT_ARG_OPTIONAL, OPT_INFER_KNOWN_LIVE },
     { "print-mem-overhead", '\0', OPT_ARG_OPTIONAL, OPT_PRINT_MEM_OVERHEAD },
+    { "elide-rc-adjustments", '\0', OPT_ARG_OPTIONAL, OPT_ELIDE_RC_ADJUSTMENTS },
+    { "hoist-loop-checks", '\0', OPT_ARG_OPTIONAL, OPT_HOIST_LOOP_CHECKS },
+    { "stack-allocate-structs", '\0', OPT_ARG_OPTIONAL, OPT_STACK_ALLOCATE_STRUCTS },
+    { "devirtualize-interface-calls", '\0', OPT_ARG_OPTIONAL, OPT_DEVIRTUALIZE_INTERFACE_CALLS },
+    { "alias-metadata", '\0', OPT_ARG_OPTIONAL, OPT_ALIAS_METADATA },
+    { "whole-program-ipo", '\0', OPT_ARG_OPTIONAL, OPT_WHOLE_PROGRAM_IPO },
+    { "static-strings", '\0', OPT_ARG_OPTIONAL, OPT_STATIC_STRINGS },
+    { "intern-single-char-strings", '\0', OPT_ARG_OPTIONAL, OPT_INTERN_SINGLE_CHAR_STRINGS },
+    { "borrow-string-builtins", '\0', OPT_ARG_OPTIONAL, OPT_BORROW_STRING_BUILTINS },
+    { "single-pass-serialize", '\0', OPT_ARG_OPTIONAL, OPT_SINGLE_PASS_SERIALIZE },
+    { "bulk-copy-primitive-arrays", '\0', OPT_ARG_OPTIONAL, OPT_BULK_COPY_PRIMITIVE_ARRAYS },
+    { "zero-copy-externs", '\0', OPT_ARG_OPTIONAL, OPT_ZERO_COPY_EXTERNS },
+    { "memoize-extern-serialize", '\0', OPT_ARG_OPTIONAL, OPT_MEMOIZE_EXTERN_SERIALIZE },
+    { "slab-unserialize", '\0', OPT_ARG_OPTIONAL, OPT_SLAB_UNSERIALIZE },
+    { "preserve-sharing", '\0', OPT_ARG_OPTIONAL, OPT_PRESERVE_SHARING },
+    { "batch-exports", '\0', OPT_ARG_OPTIONAL, OPT_BATCH_EXPORTS },
+    { "wide-lengths", '\0', OPT_ARG_OPTIONAL, OPT_WIDE_LENGTHS },
+    { "print-opt-stats", '\0', OPT_ARG_NONE, OPT_PRINT_OPT_STATS },
     { "census", '\0', OPT_ARG_OPTIONAL, OPT_CENSUS },
     { "region-override", '\0', OPT_ARG_REQUIRED, OPT_REGION_OVERRIDE },
     { "ir", '\0', OPT_ARG_NONE, OPT_IR },
@@ -172,6 +210,21 @@ static void usage()
         "  --simplebuiltin Use a minimal builtin package.\n"
         "  --files         Print source file names as each is processed.\n"
         "  --lint-llvm     Run the LLVM linting pass on generated IR.\n"
+        "  --print-opt-stats  Print what each optimization did to each function.\n"
+        "  --hoist-loop-checks  Move liveness and bounds checks out of loops.\n"
+        "  --stack-allocate-structs  Put structs that never leave their function on the stack.\n"
+        "  --devirtualize-interface-calls  Call the implementation directly when few structs implement an interface.\n"
+        "  --static-strings  Make string literals immortal globals instead of allocating them.\n"
+        "  --intern-single-char-strings  Share one immortal string per single character instead of allocating.\n"
+        "  --borrow-string-builtins  Let string builtins read strings in place instead of copying them.\n"
+        "  --single-pass-serialize  Serialize immutables for externs in one pass, retrying only when the buffer is too small.\n"
+        "  --bulk-copy-primitive-arrays  Copy arrays of ints and floats to and from externs with one memcpy.\n"
+        "  --zero-copy-externs  Lend structs and arrays of ints and floats to externs in place, instead of copying them.\n"
+        "  --memoize-extern-serialize  Keep immutables' copies for externs, and lend the same copy next time.\n"
+        "  --slab-unserialize  Unserialize each immutable from C into one allocation, freed when its last object is.\n"
+        "  --preserve-sharing  Send an immutable reachable many ways to and from C once, instead of once per reference.\n"
+        "  --batch-exports  Also export a _batch version of each function taking primitives and immutable structs.\n"
+        "  --wide-lengths  Store array and string lengths in 64 bits, so they can hold more than 2^31 elements. Use i64 sizes, indices, and lenI64() to reach them.\n"
         ,
         "" // "Runtime options for Vale programs (not for use with Vale compiler):\n"
     );
@@ -193,7 +246,26 @@ int valeOptSet(ValeOptions *opt, int *argc, char **argv) {
     opt->genHeap = false;
     opt->elideChecksForKnownLive = false;
     opt->overrideKnownLiveTrue = false;
+    opt->inferKnownLive = false;
     opt->census = false;
+    opt->elideRcAdjustments = false;
+    opt->hoistLoopChecks = false;
+    opt->stackAllocateStructs = false;
+    opt->devirtualizeInterfaceCalls = false;
+    opt->emitAliasMetadata = false;
+    opt->wholeProgramIpo = false;
+    opt->staticStrings = false;
+    opt->internSingleCharStrings = false;
+    opt->borrowStringBuiltins = false;
+    opt->singlePassSerialize = false;
+    opt->bulkCopyPrimitiveArrays = false;
+    opt->zeroCopyExterns = false;
+    opt->memoizeExternSerialize = false;
+    opt->slabUnserialize = false;
+    opt->preserveSharing = false;
+    opt->batchExports = false;
+    opt->wideLengths = false;
+    opt->printOptStats = false;
 
 
   while ((id = optNext(&s)) != -1) {
@@ -260,6 +332,17 @@ int valeOptSet(ValeOptions *opt, int *argc, char **argv) {
             break;
           }
 
+          case OPT_INFER_KNOWN_LIVE: {
+            if (!s.arg_val) {
+              opt->inferKnownLive = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->inferKnownLive = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->inferKnownLive = false;
+            } else assert(false);
+            break;
+          }
+
           case OPT_PRINT_MEM_OVERHEAD: {
             if (!s.arg_val) {
               opt->printMemOverhead = true;
@@ -271,6 +354,198 @@ int valeOptSet(ValeOptions *opt, int *argc, char **argv) {
             break;
           }
 
+          case OPT_ELIDE_RC_ADJUSTMENTS: {
+            if (!s.arg_val) {
+              opt->elideRcAdjustments = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->elideRcAdjustments = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->elideRcAdjustments = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_HOIST_LOOP_CHECKS: {
+            if (!s.arg_val) {
+              opt->hoistLoopChecks = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->hoistLoopChecks = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->hoistLoopChecks = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_STACK_ALLOCATE_STRUCTS: {
+            if (!s.arg_val) {
+              opt->stackAllocateStructs = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->stackAllocateStructs = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->stackAllocateStructs = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_DEVIRTUALIZE_INTERFACE_CALLS: {
+            if (!s.arg_val) {
+              opt->devirtualizeInterfaceCalls = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->devirtualizeInterfaceCalls = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->devirtualizeInterfaceCalls = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_ALIAS_METADATA: {
+            if (!s.arg_val) {
+              opt->emitAliasMetadata = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->emitAliasMetadata = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->emitAliasMetadata = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_WHOLE_PROGRAM_IPO: {
+            if (!s.arg_val) {
+              opt->wholeProgramIpo = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->wholeProgramIpo = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->wholeProgramIpo = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_STATIC_STRINGS: {
+            if (!s.arg_val) {
+              opt->staticStrings = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->staticStrings = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->staticStrings = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_INTERN_SINGLE_CHAR_STRINGS: {
+            if (!s.arg_val) {
+              opt->internSingleCharStrings = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->internSingleCharStrings = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->internSingleCharStrings = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_BORROW_STRING_BUILTINS: {
+            if (!s.arg_val) {
+              opt->borrowStringBuiltins = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->borrowStringBuiltins = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->borrowStringBuiltins = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_SINGLE_PASS_SERIALIZE: {
+            if (!s.arg_val) {
+              opt->singlePassSerialize = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->singlePassSerialize = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->singlePassSerialize = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_BULK_COPY_PRIMITIVE_ARRAYS: {
+            if (!s.arg_val) {
+              opt->bulkCopyPrimitiveArrays = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->bulkCopyPrimitiveArrays = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->bulkCopyPrimitiveArrays = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_ZERO_COPY_EXTERNS: {
+            if (!s.arg_val) {
+              opt->zeroCopyExterns = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->zeroCopyExterns = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->zeroCopyExterns = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_MEMOIZE_EXTERN_SERIALIZE: {
+            if (!s.arg_val) {
+              opt->memoizeExternSerialize = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->memoizeExternSerialize = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->memoizeExternSerialize = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_SLAB_UNSERIALIZE: {
+            if (!s.arg_val) {
+              opt->slabUnserialize = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->slabUnserialize = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->slabUnserialize = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_PRESERVE_SHARING: {
+            if (!s.arg_val) {
+              opt->preserveSharing = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->preserveSharing = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->preserveSharing = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_BATCH_EXPORTS: {
+            if (!s.arg_val) {
+              opt->batchExports = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->batchExports = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->batchExports = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_WIDE_LENGTHS: {
+            if (!s.arg_val) {
+              opt->wideLengths = true;
+            } else if (s.arg_val == std::string("on")) {
+              opt->wideLengths = true;
+            } else if (s.arg_val == std::string("off")) {
+              opt->wideLengths = false;
+            } else assert(false);
+            break;
+          }
+
+          case OPT_PRINT_OPT_STATS: {
+            opt->printOptStats = true;
+            break;
+          }
+
         case OPT_CENSUS: {
           if (!s.arg_val) {
             opt->census = true;
@@ -47,7 +47,26 @@ struct ValeOptions {
     bool genHeap = false;    // Enables generational heap
     bool elideChecksForKnownLive = false;    // Enables generational heap
     bool overrideKnownLiveTrue = false;    // Enables generational heap
+    bool inferKnownLive = false;    // Finds more knownLive accesses, needs elideChecksForKnownLive
     bool printMemOverhead = false;    // Enables generational heap
+    bool elideRcAdjustments = false;    // Skips RC adjustments that a local already covers
+    bool hoistLoopChecks = false;    // Moves liveness and bounds checks out of While loops
+    bool stackAllocateStructs = false;    // Puts structs that never leave their function on the stack
+    bool devirtualizeInterfaceCalls = false;    // Calls the implementation directly when few structs implement an interface
+    bool emitAliasMetadata = false;    // Adds nonnull/align/dereferenceable params and TBAA tags on member accesses
+    bool wholeProgramIpo = false;    // Makes non-exported functions internal and runs interprocedural passes
+    bool staticStrings = false;    // Emits string literals as immortal globals instead of allocating them
+    bool internSingleCharStrings = false;    // Shares one immortal Str per single-char string instead of allocating
+    bool borrowStringBuiltins = false;    // Hands string builtins our chars in place instead of a copy
+    bool singlePassSerialize = false;    // Serializes into a buffer sized from earlier sends instead of measuring first
+    bool bulkCopyPrimitiveArrays = false;    // Copies int and float array elements across the extern boundary with one memcpy
+    bool zeroCopyExterns = false;    // Lends flat immutables to externs in place instead of serializing them
+    bool memoizeExternSerialize = false;    // Keeps immutables' linear copies to lend to later extern calls
+    bool slabUnserialize = false;    // Unserializes each immutable from C into one allocation
+    bool preserveSharing = false;    // Serializes an object reachable twice once, and points at it
+    bool batchExports = false;    // Also exports a _batch variant that calls the function on arrays of arguments
+    bool wideLengths = false;    // Gives arrays and strings 64-bit lengths, and makes ValeLength 64 bits for C
+    bool printOptStats = false;    // Prints what each optimization did, per function
 
     RegionOverride regionOverride = RegionOverride::ASSIST;
 };
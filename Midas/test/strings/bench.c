@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../src/builtins/strings.c"
+
+// Checks the string builtins against the plain loops they replaced, and times them on short,
+// medium and multi-megabyte inputs. Returns 0 if they all agree.
+
+ValeInt naiveIndexOf(char* haystack, ValeInt haystackLen, char* needle, ValeInt needleLen) {
+  for (ValeInt i = 0; i <= haystackLen - needleLen; i++) {
+    if (memcmp(needle, haystack + i, needleLen) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+char naiveEq(char* a, ValeInt aLen, char* b, ValeInt bLen) {
+  if (aLen != bLen) {
+    return FALSE;
+  }
+  for (ValeInt i = 0; i < aLen; i++) {
+    if (a[i] != b[i]) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+ValeInt naiveCmp(char* a, ValeInt aLen, char* b, ValeInt bLen) {
+  for (ValeInt i = 0; ; i++) {
+    if (i >= aLen && i >= bLen) {
+      return 0;
+    }
+    if (i >= aLen) {
+      return -1;
+    }
+    if (i >= bLen) {
+      return 1;
+    }
+    if (a[i] != b[i]) {
+      return a[i] < b[i] ? -1 : 1;
+    }
+  }
+}
+
+int failures = 0;
+
+void expectInt(const char* what, ValeInt size, ValeInt expected, ValeInt actual) {
+  if (expected != actual) {
+    printf("%s on %d bytes: expected %d, got %d\n", what, size, expected, actual);
+    failures++;
+  }
+}
+
+// Log-like text, where the needle's first byte shows up often but the needle only at the end.
+char* makeHaystack(ValeInt len, char* needle, ValeInt needleLen) {
+  char* haystack = malloc(len + 1);
+  const char* filler = "2021-06-01 INFO request served in 12ms; ";
+  ValeInt fillerLen = strlen(filler);
+  for (ValeInt i = 0; i < len; i++) {
+    haystack[i] = filler[i % fillerLen];
+  }
+  if (len >= needleLen) {
+    memcpy(haystack + len - needleLen, needle, needleLen);
+  }
+  haystack[len] = 0;
+  return haystack;
+}
+
+double secondsSince(clock_t start) {
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+void benchSize(ValeInt len, int iterations) {
+  char* needle = "ERROR disk full";
+  ValeInt needleLen = strlen(needle);
+  char* a = makeHaystack(len, needle, needleLen);
+  char* b = makeHaystack(len, needle, needleLen);
+  char* c = makeHaystack(len, needle, needleLen);
+  // Differs only in the last byte, so eq and cmp have to look at everything.
+  c[len - 1] = (char)0xE9;
+
+  expectInt("strindexof", len,
+      naiveIndexOf(a, len, needle, needleLen),
+      __vale_strindexof_borrowed(a, 0, len, needle, 0, needleLen));
+  expectInt("strindexof missing", len,
+      naiveIndexOf(a, len, "WARN", 4),
+      __vale_strindexof_borrowed(a, 0, len, "WARN", 0, 4));
+  expectInt("streq", len, naiveEq(a, len, b, len), __vale_streq_borrowed(a, 0, len, b, 0, len));
+  expectInt("streq differing", len, naiveEq(a, len, c, len), __vale_streq_borrowed(a, 0, len, c, 0, len));
+  expectInt("strcmp", len, naiveCmp(a, len, c, len), __vale_strcmp_borrowed(a, 0, len, c, 0, len));
+  expectInt("strcmp reversed", len, naiveCmp(c, len, a, len), __vale_strcmp_borrowed(c, 0, len, a, 0, len));
+  expectInt("strcmp prefix", len,
+      naiveCmp(a, len - 1, b, len), __vale_strcmp_borrowed(a, 0, len - 1, b, 0, len));
+
+  ValeInt sink = 0;
+  clock_t start = clock();
+  for (int i = 0; i < iterations; i++) {
+    sink += naiveIndexOf(a, len, needle, needleLen);
+  }
+  double naiveSeconds = secondsSince(start);
+  start = clock();
+  for (int i = 0; i < iterations; i++) {
+    sink += __vale_strindexof_borrowed(a, 0, len, needle, 0, needleLen);
+  }
+  double indexOfSeconds = secondsSince(start);
+  start = clock();
+  for (int i = 0; i < iterations; i++) {
+    sink += __vale_streq_borrowed(a, 0, len, b, 0, len);
+    sink += __vale_strcmp_borrowed(a, 0, len, c, 0, len);
+  }
+  double eqCmpSeconds = secondsSince(start);
+
+  printf(
+      "%9d bytes x %7d: strindexof %.4fs (naive %.4fs), streq+strcmp %.4fs [%d]\n",
+      len, iterations, indexOfSeconds, naiveSeconds, eqCmpSeconds, sink);
+
+  free(a);
+  free(b);
+  free(c);
+}
+
+int main(int argc, char** argv) {
+  benchSize(16, 1000000);
+  benchSize(1024, 100000);
+  benchSize(4 * 1024 * 1024, 20);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../src/builtins/numbers.c"
+
+ValeStr* ValeStrNew(ValeInt length) {
+  ValeStr* result = (ValeStr*)malloc(sizeof(ValeStr) + length + 1);
+  result->length = length;
+  result->chars[0] = 0;
+  result->chars[length] = 0;
+  return result;
+}
+
+// Checks the number conversions against snprintf and strtod, and times them against snprintf.
+// Returns 0 if they all agree.
+
+int failures = 0;
+
+void expectStr(const char* expected, ValeStr* actual) {
+  if (strlen(expected) != actual->length || memcmp(expected, actual->chars, actual->length) != 0) {
+    printf("Expected %s, got %.*s\n", expected, actual->length, actual->chars);
+    failures++;
+  }
+  free(actual);
+}
+
+void checkI64(int64_t n) {
+  char expected[32];
+  snprintf(expected, sizeof(expected), "%lld", (long long)n);
+  expectStr(expected, __vale_castI64Str(n));
+  ValeInt length = (ValeInt)strlen(expected);
+  if (__vale_strtoi64_borrowed(expected, 0, length) != n) {
+    printf("Couldn't parse %s back\n", expected);
+    failures++;
+  }
+}
+
+void checkRoundTrip(double f) {
+  ValeStr* s = __vale_castFloatStr(f);
+  double parsed = __vale_strtofloat_borrowed(s->chars, 0, s->length);
+  if (memcmp(&parsed, &f, sizeof(f)) != 0) {
+    printf("%.17g printed as %.*s, which reads back as %.17g\n", f, s->length, s->chars, parsed);
+    failures++;
+  }
+  free(s);
+}
+
+uint64_t nextRandom(uint64_t* state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+int main(int argc, char** argv) {
+  int64_t edgeInts[] = {
+      0, 1, -1, 9, 10, 99, 100, -100, 12345, 2147483647LL, -2147483647LL - 1,
+      9223372036854775807LL, -9223372036854775807LL - 1
+  };
+  for (int i = 0; i < sizeof(edgeInts) / sizeof(edgeInts[0]); i++) {
+    checkI64(edgeInts[i]);
+  }
+
+  expectStr("42.25", __vale_castFloatStr(42.25));
+  expectStr("1.0", __vale_castFloatStr(1.0));
+  expectStr("-0.5", __vale_castFloatStr(-0.5));
+  expectStr("0.1", __vale_castFloatStr(0.1));
+  expectStr("0.001", __vale_castFloatStr(0.001));
+  expectStr("1.0E-4", __vale_castFloatStr(0.0001));
+  expectStr("1234567.0", __vale_castFloatStr(1234567.0));
+  expectStr("1.0E7", __vale_castFloatStr(10000000.0));
+  expectStr("1.5E300", __vale_castFloatStr(1.5e300));
+  // The JVM says 4.9E-324 here, but 5.0E-324 is shorter and reads back the same.
+  expectStr("5.0E-324", __vale_castFloatStr(4.9e-324));
+  expectStr("0.0", __vale_castFloatStr(0.0));
+  expectStr("-0.0", __vale_castFloatStr(-0.0));
+  expectStr("NaN", __vale_castFloatStr(NAN));
+  expectStr("-Infinity", __vale_castFloatStr(-INFINITY));
+
+  uint64_t state = 88172645463325252ULL;
+  for (int i = 0; i < 1000000; i++) {
+    uint64_t bits = nextRandom(&state);
+    double f = 0;
+    memcpy(&f, &bits, sizeof(f));
+    if (!isnan(f) && !isinf(f)) {
+      checkRoundTrip(f);
+    }
+    checkI64((int64_t)nextRandom(&state) >> (i % 64));
+  }
+
+  char buffer[64];
+  int64_t sink = 0;
+  clock_t start = clock();
+  for (int i = 0; i < 1000000; i++) {
+    sink += snprintf(buffer, sizeof(buffer), "%lld", (long long)i * 7919);
+  }
+  double snprintfIntSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  for (int i = 0; i < 1000000; i++) {
+    ValeStr* s = __vale_castI64Str((int64_t)i * 7919);
+    sink += s->length;
+    free(s);
+  }
+  double intSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  for (int i = 0; i < 1000000; i++) {
+    sink += snprintf(buffer, sizeof(buffer), "%.17g", i * 1.0001);
+  }
+  double snprintfFloatSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  for (int i = 0; i < 1000000; i++) {
+    ValeStr* s = __vale_castFloatStr(i * 1.0001);
+    sink += s->length;
+    free(s);
+  }
+  double floatSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf(
+      "1M ints: %.4fs (snprintf %.4fs), 1M floats: %.4fs (snprintf %.4fs) [%lld]\n",
+      intSeconds, snprintfIntSeconds, floatSeconds, snprintfFloatSeconds, (long long)sink);
+
+  return failures == 0 ? 0 : 1;
+}
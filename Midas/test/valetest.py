@@ -3,6 +3,7 @@ import subprocess
 import platform
 import os.path
 import os
+import re
 import sys
 import shutil
 import glob
@@ -177,6 +178,201 @@ class ValeTest(unittest.TestCase):
     def test_resilientv3_kldc(self) -> None:
         self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/structs/deadmutstruct.vale"], "resilient-v3", 116, ["--override-known-live-true"])
 
+    # ikl = inferred known live
+    def test_resilientv3_ikl_structmut(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/structs/structmut.vale"], "resilient-v3", 8, ["--elide-checks-for-known-live", "--infer-known-live"])
+    def test_resilientv3_ikl_while(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/while/while.vale"], "resilient-v3", 42, ["--elide-checks-for-known-live", "--infer-known-live"])
+
+    # hlc = hoisted loop checks
+    def test_resilientv3_hlc_rsamutloop(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/arrays/rsamutloop.vale"], "resilient-v3", 42, ["--elide-checks-for-known-live", "--infer-known-live", "--hoist-loop-checks"])
+    def test_assist_hlc_rsamutloop(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/arrays/rsamutloop.vale"], "assist", 42, ["--hoist-loop-checks"])
+
+    # ss = static strings
+    def test_assist_ss_stradd(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/stradd.vale"], "assist", 42, ["--static-strings"])
+    def test_resilientv3_ss_strneq(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/strneq.vale"], "resilient-v3", 42, ["--static-strings"])
+
+    # iscs = intern single-char strings
+    def test_assist_iscs_smallstr(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/smallstr.vale"], "assist", 42, ["--intern-single-char-strings"])
+    def test_naiverc_iscs_stradd(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/stradd.vale"], "naive-rc", 42, ["--intern-single-char-strings"])
+
+    # bsb = borrow string builtins
+    def test_assist_bsb_strneq(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/strneq.vale"], "assist", 42, ["--borrow-string-builtins"])
+    def test_resilientv3_bsb_stradd(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/stradd.vale"], "resilient-v3", 42, ["--borrow-string-builtins"])
+    def test_assist_bsb_strtonum(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/strtonum.vale"], "assist", 42, ["--borrow-string-builtins"])
+    def test_assist_bsb_strtoi64overflow(self) -> None:
+        proc = self.compile_and_execute([PATH_TO_SAMPLES + "programs/strings/strtoi64overflow.vale"], "assist", ["--borrow-string-builtins"])
+        self.assertEqual(proc.returncode, 1)
+        self.assertIn("Number too big for an i64!", proc.stdout)
+
+    # sps = single pass serialize
+    def test_assist_sps_structimmparamdeepextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparamdeepextern"], "assist", 42, ["--single-pass-serialize"])
+    def test_assist_sps_interfaceimmparamdeepextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/interfaceimmparamdeepextern"], "assist", 42, ["--single-pass-serialize"])
+    def test_resilientv3_sps_rsaimmparamdeepextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/rsaimmparamdeepextern"], "resilient-v3", 20, ["--single-pass-serialize"])
+
+    # bcpa = bulk copy primitive arrays
+    def test_assist_bcpa_rsaimmparamextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/rsaimmparamextern"], "assist", 10, ["--bulk-copy-primitive-arrays"])
+    def test_assist_bcpa_rsaimmreturnextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/rsaimmreturnextern"], "assist", 42, ["--bulk-copy-primitive-arrays"])
+    def test_assist_bcpa_ssaimmparamextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/ssaimmparamextern"], "assist", 42, ["--bulk-copy-primitive-arrays"])
+    def test_assist_bcpa_ssaimmreturnextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/ssaimmreturnextern"], "assist", 42, ["--bulk-copy-primitive-arrays"])
+    def test_assist_bcpa_sps_rsaimmparamextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/rsaimmparamextern"], "assist", 10, ["--bulk-copy-primitive-arrays", "--single-pass-serialize"])
+
+    # zce = zero copy externs
+    def test_assist_zce_structimmparamlentextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparamlentextern"], "assist", 42, ["--zero-copy-externs"])
+    def test_resilientv3_zce_rsaimmparamlentextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/rsaimmparamlentextern"], "resilient-v3", 10, ["--zero-copy-externs"])
+    def test_assist_zce_rsaimmparamdeepextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/rsaimmparamdeepextern"], "assist", 20, ["--zero-copy-externs"])
+    def test_assist_structimmparamlentextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparamlentextern"], "assist", 42)
+
+    # mes = memoize extern serialize
+    def test_assist_mes_structimmparammemoextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparammemoextern"], "assist", 42, ["--memoize-extern-serialize"])
+    def test_resilientv3_mes_structimmparammemoextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparammemoextern"], "resilient-v3", 42, ["--memoize-extern-serialize"])
+    def test_assist_mes_zce_structimmparamlentextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparamlentextern"], "assist", 42, ["--memoize-extern-serialize", "--zero-copy-externs"])
+    def test_assist_mes_structimmparamdeepextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparamdeepextern"], "assist", 42, ["--memoize-extern-serialize"])
+    def test_assist_structimmparammemoextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparammemoextern"], "assist", 42)
+
+    # su = slab unserialize
+    def test_assist_su_structimmparamdeepexport(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparamdeepexport"], "assist", 42, ["--slab-unserialize"])
+    def test_resilientv3_su_interfaceimmparamdeepexport(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/interfaceimmparamdeepexport"], "resilient-v3", 42, ["--slab-unserialize"])
+    def test_assist_su_rsaimmreturnextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/rsaimmreturnextern"], "assist", 42, ["--slab-unserialize"])
+    def test_assist_su_ssaimmparamdeepexport(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/ssaimmparamdeepexport"], "assist", 42, ["--slab-unserialize"])
+
+    # ps = preserve sharing
+    def test_assist_ps_structimmparamsharedextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparamsharedextern"], "assist", 42, ["--preserve-sharing"])
+    def test_resilientv3_ps_structimmparamsharedextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparamsharedextern"], "resilient-v3", 42, ["--preserve-sharing", "--single-pass-serialize"])
+    def test_assist_structimmparamsharedextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparamsharedextern"], "assist", 41)
+    def test_assist_ps_structimmparamdeepexport(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparamdeepexport"], "assist", 42, ["--preserve-sharing", "--slab-unserialize"])
+
+    # snap = snapshots
+    def test_assist_snap_structimmsnapshot(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmsnapshot"], "assist", 42)
+    def test_resilientv3_snap_structimmsnapshot(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmsnapshot"], "resilient-v3", 42, ["--slab-unserialize", "--preserve-sharing"])
+
+    # be = batch exports
+    def test_assist_be_structimmparambatchexport(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparambatchexport"], "assist", 42, ["--batch-exports"])
+    def test_resilientv3_be_structimmparambatchexport(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/structimmparambatchexport"], "resilient-v3", 42, ["--batch-exports", "--slab-unserialize"])
+
+    # bi = builtin intrinsics
+    def test_assist_bi_bitarithmetic(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/bitarithmetic.vale"], "assist", 42)
+    def test_resilientv3_bi_bitarithmetic(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/bitarithmetic.vale"], "resilient-v3", 42)
+
+    # wl = wide lengths
+    def test_assist_wl_rsamutloop(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/arrays/rsamutloop.vale"], "assist", 42, ["--wide-lengths"])
+    def test_resilientv3_wl_rsaimmparamextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/rsaimmparamextern"], "resilient-v3", 10, ["--wide-lengths"])
+    def test_assist_wl_strlenextern(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/externs/strlenextern"], "assist", 11, ["--wide-lengths"])
+    def test_assist_rsai64(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/arrays/rsai64.vale"], "assist", 42)
+    def test_assist_wl_rsai64(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/arrays/rsai64.vale"], "assist", 42, ["--wide-lengths"])
+    def test_resilientv3_wl_rsai64(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/arrays/rsai64.vale"], "resilient-v3", 42, ["--wide-lengths"])
+    # These make arrays and strings past the biggest int, which takes several GB, so they only run
+    # when VALE_TEST_BIG_MEMORY is set.
+    @unittest.skipUnless(os.environ.get("VALE_TEST_BIG_MEMORY"), "needs several GB of memory")
+    def test_assist_wl_rsabigi64(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/arrays/rsabigi64.vale"], "assist", 42, ["--wide-lengths"])
+    @unittest.skipUnless(os.environ.get("VALE_TEST_BIG_MEMORY"), "needs several GB of memory")
+    def test_assist_wl_strbiglenextern(self) -> None:
+        proc = self.compile_and_execute([PATH_TO_SAMPLES + "programs/externs/strbiglenextern"], "assist", ["--wide-lengths"])
+        self.assertEqual(proc.returncode, 1)
+        self.assertIn("Length too big for an int", proc.stdout)
+
+    # wpi = whole program ipo
+    def test_assist_wpi_interfacemut(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/virtuals/interfacemut.vale"], "assist", 42, ["--whole-program-ipo"])
+    def test_resilientv3_wpi_rsamutloop(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/arrays/rsamutloop.vale"], "resilient-v3", 42, ["--whole-program-ipo"])
+
+    # am = alias metadata
+    def test_assist_am_structmutstore(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/structs/structmutstore.vale"], "assist", 42, ["--alias-metadata"])
+    def test_unsafefast_am_interfacemut(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/virtuals/interfacemut.vale"], "unsafe-fast", 42, ["--alias-metadata"])
+
+    # dic = devirtualized interface calls
+    def test_assist_dic_singleimpl(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/virtuals/singleimpl.vale"], "assist", 42, ["--devirtualize-interface-calls"])
+    def test_naiverc_dic_interfacemut(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/virtuals/interfacemut.vale"], "naive-rc", 42, ["--devirtualize-interface-calls"])
+    def test_resilientv3_dic_interfaceimm(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/virtuals/interfaceimm.vale"], "resilient-v3", 42, ["--devirtualize-interface-calls"])
+
+    # sas = stack allocated structs
+    def test_assist_sas_structmut(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/structs/structmut.vale"], "assist", 8, ["--stack-allocate-structs"])
+    def test_resilientv3_sas_structmut(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/structs/structmut.vale"], "resilient-v3", 8, ["--stack-allocate-structs"])
+    def test_naiverc_sas_structmutstore(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/structs/structmutstore.vale"], "naive-rc", 42, ["--stack-allocate-structs"])
+
+    # erca = elided RC adjustments
+    def test_naiverc_erca_memberrefcount(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/structs/memberrefcount.vale"], "naive-rc", 5, ["--elide-rc-adjustments"])
+    def test_naiverc_erca_mutswaplocals(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/mutswaplocals.vale"], "naive-rc", 42, ["--elide-rc-adjustments"])
+    def test_naiverc_erca_structimm(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/structs/structimm.vale"], "naive-rc", 5, ["--elide-rc-adjustments"])
+    def test_naiverc_erca_memberrefcount_stats(self) -> None:
+        vale_file = PATH_TO_SAMPLES + "programs/structs/memberrefcount.vale"
+        build_dir = "test/test_build/memberrefcount_naive-rc_build"
+        mut_rc_adjustments = {}
+        for elide in [False, True]:
+            flags = ["--print-opt-stats", "--print-mem-overhead"] + (["--elide-rc-adjustments"] if elide else [])
+            compile_proc = self.valec("tmod", ["tmod:" + vale_file], build_dir, "memberrefcount", "naive-rc", flags)
+            self.assertEqual(compile_proc.returncode, 0, compile_proc.stdout + compile_proc.stderr)
+            removed = sum(int(n) for n in re.findall(r"RC elision: removed (\d+) adjustments", compile_proc.stdout))
+            if elide:
+                self.assertGreater(removed, 0, compile_proc.stdout)
+            else:
+                self.assertEqual(removed, 0, compile_proc.stdout)
+            proc = self.exec(f"{build_dir}/memberrefcount")
+            self.assertEqual(proc.returncode, 5, proc.stdout + proc.stderr)
+            match = re.search(r"Mut RC adjustments: (\d+)", proc.stdout)
+            self.assertIsNotNone(match, proc.stdout)
+            mut_rc_adjustments[elide] = int(match.group(1))
+        self.assertLess(mut_rc_adjustments[True], mut_rc_adjustments[False])
+
     def test_twinpages_noattemptbadwrite(self) -> None:
         if platform.system() == 'Windows':
             proc = procrun(["cl.exe", "test/twinpages/test.c", "-o", "test/test_build/testtwinpages.exe"])
@@ -197,6 +393,36 @@ class ValeTest(unittest.TestCase):
             proc = procrun(["test/test_build/testtwinpages", "attemptbadwrite"])
             self.assertEqual(proc.returncode, 42, f"Twin pages test failed!")
 
+    def test_strings_bench(self) -> None:
+        if platform.system() == 'Windows':
+            proc = procrun(["cl.exe", "/O2", "test/strings/bench.c", "/Fe:test/test_build/teststringsbench.exe"])
+            proc = procrun(["test/test_build/teststringsbench.exe"])
+            self.assertEqual(proc.returncode, 0, f"String builtins benchmark failed!\n" + proc.stdout)
+        else:
+            proc = procrun(["clang", "-O2", "test/strings/bench.c", "-o", "test/test_build/teststringsbench"])
+            proc = procrun(["test/test_build/teststringsbench"])
+            self.assertEqual(proc.returncode, 0, f"String builtins benchmark failed!\n" + proc.stdout)
+
+    def test_strings_numbers(self) -> None:
+        if platform.system() == 'Windows':
+            proc = procrun(["cl.exe", "/O2", "test/strings/numbers.c", "/Fe:test/test_build/teststringsnumbers.exe"])
+            proc = procrun(["test/test_build/teststringsnumbers.exe"])
+            self.assertEqual(proc.returncode, 0, f"Number conversion test failed!\n" + proc.stdout)
+        else:
+            proc = procrun(["clang", "-O2", "test/strings/numbers.c", "-o", "test/test_build/teststringsnumbers", "-lm"])
+            proc = procrun(["test/test_build/teststringsnumbers"])
+            self.assertEqual(proc.returncode, 0, f"Number conversion test failed!\n" + proc.stdout)
+    def test_assist_strtonum(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/strtonum.vale"], "assist", 42)
+    def test_assist_strtoi64overflow(self) -> None:
+        proc = self.compile_and_execute([PATH_TO_SAMPLES + "programs/strings/strtoi64overflow.vale"], "assist", [])
+        self.assertEqual(proc.returncode, 1)
+        self.assertIn("Number too big for an i64!", proc.stdout)
+    def test_assist_strtofloatempty(self) -> None:
+        proc = self.compile_and_execute([PATH_TO_SAMPLES + "programs/strings/strtofloatempty.vale"], "assist", [])
+        self.assertEqual(proc.returncode, 1)
+        self.assertIn("Couldn't parse a float, there was no number!", proc.stdout)
+
     def test_assist_addret(self) -> None:
         self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/addret.vale"], "assist", 7)
     def test_assist_add64ret(self) -> None:
@@ -564,6 +790,12 @@ class ValeTest(unittest.TestCase):
         self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/stradd.vale"], "resilient-v3", 42)
     def test_naiverc_stradd(self) -> None:
         self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/stradd.vale"], "naive-rc", 42)
+    def test_assist_strbuilder(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/strbuilder.vale"], "assist", 42)
+    def test_resilientv3_strbuilder(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/strbuilder.vale"], "resilient-v3", 42)
+    def test_assist_bsb_strbuilder(self) -> None:
+        self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/strbuilder.vale"], "assist", 42, ["--borrow-string-builtins"])
 
     def test_assist_strneq(self) -> None:
         self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/strneq.vale"], "assist", 42)
@@ -589,6 +821,14 @@ class ValeTest(unittest.TestCase):
 
     def test_assist_strprint(self) -> None:
         self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/strprint.vale"], "assist", 42)
+    def test_assist_strflush(self) -> None:
+        proc = self.compile_and_execute([PATH_TO_SAMPLES + "programs/strings/strflush.vale"], "assist", [])
+        self.assertEqual(proc.returncode, 42)
+        self.assertEqual(proc.stdout, "Hello world")
+    def test_assist_printorderextern(self) -> None:
+        proc = self.compile_and_execute([PATH_TO_SAMPLES + "programs/externs/printorderextern"], "assist", [])
+        self.assertEqual(proc.returncode, 42)
+        self.assertEqual(proc.stdout, "Hello world!")
     def test_unsafefast_strprint(self) -> None:
         self.compile_and_execute_and_expect_return_code([PATH_TO_SAMPLES + "programs/strings/strprint.vale"], "unsafe-fast", 42)
     def test_resilientv4_strprint(self) -> None:
@@ -66,11 +66,14 @@ class ValeCompiler:
               o_files_dir: Path,
               exe_file: Path,
               census: bool,
+              wide_lengths: bool,
               include_path: Optional[Path]) -> subprocess.CompletedProcess:
         if self.windows:
             args = ["cl.exe", '/ENTRY:"main"', '/SUBSYSTEM:CONSOLE', "/Fe:" + str(exe_file)]
             if census:
                 args = args + ["/fsanitize=address", "clang_rt.asan_dynamic-x86_64.lib", "clang_rt.asan_dynamic_runtime_thunk-x86_64.lib", "-Wall", "-Werror"]
+            if wide_lengths:
+                args.append("/DVALE_WIDE_LENGTHS")
             args = args + list(str(x) for x in o_files)
             if include_path is not None:
                 args.append("-I" + str(include_path))
@@ -80,6 +83,8 @@ class ValeCompiler:
             args = [clang, "-O3", "-lm", "-o", str(exe_file), "-Wall", "-Werror"]
             if census:
                 args = args + ["-fsanitize=address", "-fsanitize=leak", "-fno-omit-frame-pointer", "-g"]
+            if wide_lengths:
+                args.append("-DVALE_WIDE_LENGTHS")
             args = args + list(str(x) for x in o_files)
             if include_path is not None:
                 args.append("-I" + str(include_path))
@@ -178,6 +183,7 @@ class ValeCompiler:
         print_help = False
         print_version = False
         census = False
+        wide_lengths = False
         valestrom_options = []
         midas_options = []
         if "--flares" in args:
@@ -193,9 +199,19 @@ class ValeCompiler:
             census = True
             args.remove("--census")
             midas_options.append("--census")
+        if "--wide-lengths" in args:
+            wide_lengths = True
+            args.remove("--wide-lengths")
+            midas_options.append("--wide-lengths")
         if "--print-mem-overhead" in args:
             args.remove("--print-mem-overhead")
             midas_options.append("--print-mem-overhead")
+        if "--print-opt-stats" in args:
+            args.remove("--print-opt-stats")
+            midas_options.append("--print-opt-stats")
+        if "--elide-rc-adjustments" in args:
+            args.remove("--elide-rc-adjustments")
+            midas_options.append("--elide-rc-adjustments")
         if "--verify" in args:
             args.remove("--verify")
             midas_options.append("--verify")
@@ -459,6 +475,8 @@ class ValeCompiler:
             if proc.returncode != 0:
                 print(f"midas couldn't compile {vast_file}:\n" + proc.stdout + "\n" + proc.stderr, file=sys.stderr)
                 sys.exit(1)
+            if "--print-opt-stats" in midas_options:
+                print(proc.stdout)
 
             for directory_with_c in directories_with_c:
                 for c_file in directory_with_c.rglob('*.c'):
@@ -482,6 +500,7 @@ class ValeCompiler:
                 self.build_dir,
                 self.build_dir / exe_file,
                 census,
+                wide_lengths,
                 self.build_dir)
             # print(proc.stdout)
             # print(proc.stderr)
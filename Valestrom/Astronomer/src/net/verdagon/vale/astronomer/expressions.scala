@@ -161,7 +161,7 @@ case class OutsideLoadAE(range: RangeS, name: String, targetOwnership: LoadAsP)
 
 case class UnletAE(range: RangeS, name: String) extends IExpressionAE { override def hashCode(): Int = vcurious() }
 
-case class ArrayLengthAE(range: RangeS, arrayExpr: IExpressionAE) extends IExpressionAE { override def hashCode(): Int = vcurious() }
+case class ArrayLengthAE(range: RangeS, arrayExpr: IExpressionAE, lengthBits: Int) extends IExpressionAE { override def hashCode(): Int = vcurious() }
 
 
 case class LocalA(
@@ -129,11 +129,11 @@ object ExpressionHammer {
         (newStructNodeAndDeferredsExprH, Vector.empty)
       }
 
-      case ArrayLengthTE(arrayExpr2) => {
+      case ArrayLengthTE(arrayExpr2, lengthBits) => {
         val (resultLine, deferreds) =
           translate(hinputs, hamuts, currentFunctionHeader, locals, arrayExpr2);
 
-        val lengthResultNode = ArrayLengthH(resultLine);
+        val lengthResultNode = ArrayLengthH(resultLine, lengthBits);
 
         val arrayLengthAndDeferredsExprH =
           translateDeferreds(hinputs, hamuts, currentFunctionHeader, locals, lengthResultNode, deferreds)
@@ -422,14 +422,15 @@ object VonHammer {
           Vector(
             VonMember("value", VonFloat(value))))
       }
-      case ArrayLengthH(sourceExpr) => {
+      case al @ ArrayLengthH(sourceExpr, _) => {
         VonObject(
           "ArrayLength",
           None,
           Vector(
             VonMember("sourceExpr", vonifyExpression(sourceExpr)),
             VonMember("sourceType", vonifyCoord(sourceExpr.resultType)),
-            VonMember("sourceKnownLive", VonBool(false))))
+            VonMember("sourceKnownLive", VonBool(false)),
+            VonMember("resultType", vonifyCoord(al.resultType))))
       }
       case wa @ WeakAliasH(sourceExpr) => {
         VonObject(
@@ -664,9 +664,11 @@ case class NewStructH(
 case class ArrayLengthH(
   // Expression containing the array whose length we'll get.
   sourceExpression: ExpressionH[KindH],
+  // 32 for len(), 64 for lenI64().
+  lengthBits: Int,
 ) extends ExpressionH[IntH] {
   val hash = runtime.ScalaRunTime._hashCode(this); override def hashCode(): Int = hash;
-  override def resultType: ReferenceH[IntH] = ReferenceH(ShareH, InlineH, ReadonlyH, IntH.i32)
+  override def resultType: ReferenceH[IntH] = ReferenceH(ShareH, InlineH, ReadonlyH, IntH(lengthBits))
 }
 
 // Turns a constraint ref into a weak ref.
@@ -48,7 +48,9 @@ class ArrayTemplar(
     val IntegerTemplata(size) = vassertSome(templatas.get(NameTranslator.translateRune(sizeRuneA)))
     val mutability = maybeMutabilityRune.map(getArrayMutability(templatas, _)).getOrElse(MutableT)
     val variability = maybeVariabilityRune.map(getArrayVariability(templatas, _)).getOrElse(FinalT)
-    val prototype = overloadTemplar.getArrayGeneratorPrototype(temputs, fate, range, callableTE)
+    val prototype =
+      overloadTemplar.getArrayGeneratorPrototype(
+        temputs, fate, range, callableTE, CoordT(ShareT, ReadonlyT, IntT.i32))
     val ssaMT = getStaticSizedArrayKind(fate.snapshot, temputs, mutability, variability, size.toInt, prototype.returnType)
     val expr2 = StaticArrayFromCallableTE(ssaMT, callableTE, prototype)
     expr2
@@ -69,7 +71,9 @@ class ArrayTemplar(
       inferTemplar.inferOrdinaryRules(fate.snapshot, temputs, rules, typeByRune, Set() ++ maybeMutabilityRune ++ maybeVariabilityRune)
     val mutability = maybeMutabilityRune.map(getArrayMutability(templatas, _)).getOrElse(MutableT)
     val variability = maybeVariabilityRune.map(getArrayVariability(templatas, _)).getOrElse(FinalT)
-    val prototype = overloadTemplar.getArrayGeneratorPrototype(temputs, fate, range, callableTE)
+    val prototype =
+      overloadTemplar.getArrayGeneratorPrototype(
+        temputs, fate, range, callableTE, sizeTE.resultRegister.reference)
     val rsaMT = getRuntimeSizedArrayKind(fate.snapshot, temputs, prototype.returnType, mutability, variability)
     val expr2 = ConstructArrayTE(rsaMT, sizeTE, callableTE, prototype)
     expr2
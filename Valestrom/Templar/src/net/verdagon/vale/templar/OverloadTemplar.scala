@@ -591,17 +591,20 @@ class OverloadTemplar(
     }
   }
 
+  // The generator gets each index as indexType, which is an int, or an i64 for runtime-sized arrays
+  // made with an i64 size.
   def getArrayGeneratorPrototype(
     temputs: Temputs,
     fate: FunctionEnvironmentBox,
     range: RangeS,
-    callableTE: ReferenceExpressionTE):
+    callableTE: ReferenceExpressionTE,
+    indexType: CoordT):
   PrototypeT = {
     val funcName = GlobalFunctionFamilyNameA(CallTemplar.CALL_FUNCTION_NAME)
     val paramFilters =
       Vector(
         ParamFilter(callableTE.resultRegister.underlyingReference, None),
-        ParamFilter(CoordT(ShareT, ReadonlyT, IntT.i32), None))
+        ParamFilter(indexType, None))
     val prototype =
       scoutExpectedFunctionForPrototype(
         fate.snapshot, temputs, range, funcName, Vector.empty, paramFilters, Vector.empty, false) match {
@@ -939,10 +939,10 @@ class ExpressionTemplar(
 
           (block2, returnsFromExprs)
         }
-        case ArrayLengthAE(range, arrayExprA) => {
+        case ArrayLengthAE(range, arrayExprA, lengthBits) => {
           val (arrayExpr2, returnsFromArrayExpr) =
             evaluateAndCoerceToReferenceExpression(temputs, fate, life, arrayExprA);
-          (ArrayLengthTE(arrayExpr2), returnsFromArrayExpr)
+          (ArrayLengthTE(arrayExpr2, lengthBits), returnsFromArrayExpr)
         }
         case DestructAE(range, innerAE) => {
           val (innerExpr2, returnsFromArrayExpr) =
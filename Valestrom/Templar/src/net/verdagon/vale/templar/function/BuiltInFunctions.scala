@@ -15,55 +15,68 @@ import net.verdagon.vale.{vassert, vfail}
 import scala.collection.immutable.List
 
 object BuiltInFunctions {
+  // len() gives an int, and lenI64() gives an i64 for arrays that might be longer than the biggest
+  // int, see --wide-lengths.
+  private def makeArrayLengthFunction(
+    name: String,
+    nameLocation: s.CodeLocationS,
+    lengthTypeName: String,
+    lengthBits: Int):
+  FunctionA = {
+    FunctionA(
+      RangeS.internal(-61),
+      FunctionNameA(name, nameLocation),
+      Vector(UserFunctionA),
+      TemplateTemplataType(Vector(CoordTemplataType), FunctionTemplataType),
+      Set(CodeRuneA("I")),
+      Vector(CodeRuneA("T")),
+      Set(CodeRuneA("T"), CodeRuneA("XX"), CodeRuneA("XY"), CodeRuneA("__1"), CodeRuneA("I")),
+      Map(
+        CodeRuneA("T") -> CoordTemplataType,
+        CodeRuneA("XX") -> MutabilityTemplataType,
+        CodeRuneA("XY") -> VariabilityTemplataType,
+        CodeRuneA("__1") -> CoordTemplataType,
+        CodeRuneA("I") -> CoordTemplataType),
+      Vector(
+        ParameterA(AtomAP(RangeS.internal(-1337), Some(LocalA(CodeVarNameA("arr"), NotUsed, Used, NotUsed, NotUsed, NotUsed, NotUsed)), None, CodeRuneA("T"), None))),
+      Some(CodeRuneA("I")),
+      Vector(
+        EqualsAR(RangeS.internal(-9101),
+          TemplexAR(RuneAT(RangeS.internal(-9102),CodeRuneA("T"), CoordTemplataType)),
+          ComponentsAR(
+            RangeS.internal(-9103),
+            CoordTemplataType,
+            Vector(
+              OrAR(RangeS.internal(-9104),Vector(TemplexAR(OwnershipAT(RangeS.internal(-9105),ConstraintP)), TemplexAR(OwnershipAT(RangeS.internal(-9106),ShareP)))),
+              TemplexAR(PermissionAT(RangeS.internal(-9107), ReadonlyP)),
+              TemplexAR(
+                CallAT(RangeS.internal(-9108),
+                  NameAT(RangeS.internal(-9109),CodeTypeNameA("Array"), TemplateTemplataType(Vector(MutabilityTemplataType, VariabilityTemplataType, CoordTemplataType), KindTemplataType)),
+                  Vector(
+                    RuneAT(RangeS.internal(-9110),CodeRuneA("XX"), MutabilityTemplataType),
+                    RuneAT(RangeS.internal(-9110),CodeRuneA("XY"), VariabilityTemplataType),
+                    RuneAT(RangeS.internal(-9111),CodeRuneA("__1"), CoordTemplataType)),
+                  KindTemplataType))))),
+        EqualsAR(RangeS.internal(-9112),
+          TemplexAR(RuneAT(RangeS.internal(-9113),CodeRuneA("I"), CoordTemplataType)),
+          TemplexAR(NameAT(RangeS.internal(-9114),CodeTypeNameA(lengthTypeName), CoordTemplataType)))),
+      CodeBodyA(
+        BodyAE(
+          RangeS.internal(-62),
+          Vector.empty,
+          BlockAE(
+            RangeS.internal(-62),
+            Vector(
+              ArrayLengthAE(
+                RangeS.internal(-62),
+                LocalLoadAE(RangeS.internal(-62),CodeVarNameA("arr"), UseP),
+                lengthBits))))))
+  }
+
   val builtIns =
     Vector(
-      FunctionA(
-        RangeS.internal(-61),
-        FunctionNameA("len", s.CodeLocationS.internal(-20)),
-        Vector(UserFunctionA),
-        TemplateTemplataType(Vector(CoordTemplataType), FunctionTemplataType),
-        Set(CodeRuneA("I")),
-        Vector(CodeRuneA("T")),
-        Set(CodeRuneA("T"), CodeRuneA("XX"), CodeRuneA("XY"), CodeRuneA("__1"), CodeRuneA("I")),
-        Map(
-          CodeRuneA("T") -> CoordTemplataType,
-          CodeRuneA("XX") -> MutabilityTemplataType,
-          CodeRuneA("XY") -> VariabilityTemplataType,
-          CodeRuneA("__1") -> CoordTemplataType,
-          CodeRuneA("I") -> CoordTemplataType),
-        Vector(
-          ParameterA(AtomAP(RangeS.internal(-1337), Some(LocalA(CodeVarNameA("arr"), NotUsed, Used, NotUsed, NotUsed, NotUsed, NotUsed)), None, CodeRuneA("T"), None))),
-        Some(CodeRuneA("I")),
-        Vector(
-          EqualsAR(RangeS.internal(-9101),
-            TemplexAR(RuneAT(RangeS.internal(-9102),CodeRuneA("T"), CoordTemplataType)),
-            ComponentsAR(
-              RangeS.internal(-9103),
-              CoordTemplataType,
-              Vector(
-                OrAR(RangeS.internal(-9104),Vector(TemplexAR(OwnershipAT(RangeS.internal(-9105),ConstraintP)), TemplexAR(OwnershipAT(RangeS.internal(-9106),ShareP)))),
-                TemplexAR(PermissionAT(RangeS.internal(-9107), ReadonlyP)),
-                TemplexAR(
-                  CallAT(RangeS.internal(-9108),
-                    NameAT(RangeS.internal(-9109),CodeTypeNameA("Array"), TemplateTemplataType(Vector(MutabilityTemplataType, VariabilityTemplataType, CoordTemplataType), KindTemplataType)),
-                    Vector(
-                      RuneAT(RangeS.internal(-9110),CodeRuneA("XX"), MutabilityTemplataType),
-                      RuneAT(RangeS.internal(-9110),CodeRuneA("XY"), VariabilityTemplataType),
-                      RuneAT(RangeS.internal(-9111),CodeRuneA("__1"), CoordTemplataType)),
-                    KindTemplataType))))),
-          EqualsAR(RangeS.internal(-9112),
-            TemplexAR(RuneAT(RangeS.internal(-9113),CodeRuneA("I"), CoordTemplataType)),
-            TemplexAR(NameAT(RangeS.internal(-9114),CodeTypeNameA("int"), CoordTemplataType)))),
-        CodeBodyA(
-          BodyAE(
-            RangeS.internal(-62),
-            Vector.empty,
-            BlockAE(
-              RangeS.internal(-62),
-              Vector(
-                ArrayLengthAE(
-                  RangeS.internal(-62),
-                  LocalLoadAE(RangeS.internal(-62),CodeVarNameA("arr"), UseP))))))),
+      makeArrayLengthFunction("len", s.CodeLocationS.internal(-20), "int", 32),
+      makeArrayLengthFunction("lenI64", s.CodeLocationS.internal(-25), "i64", 64),
       FunctionA(
         RangeS.internal(-62),
         FunctionNameA("len", s.CodeLocationS.internal(-21)),
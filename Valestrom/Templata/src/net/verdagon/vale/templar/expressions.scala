@@ -573,9 +573,9 @@ case class RuntimeSizedArrayLookupTE(
   }
 }
 
-case class ArrayLengthTE(arrayExpr: ReferenceExpressionTE) extends ReferenceExpressionTE {
+case class ArrayLengthTE(arrayExpr: ReferenceExpressionTE, lengthBits: Int) extends ReferenceExpressionTE {
   override def hashCode(): Int = vcurious()
-  override def resultRegister = ReferenceResultT(CoordT(ShareT, ReadonlyT, IntT.i32))
+  override def resultRegister = ReferenceResultT(CoordT(ShareT, ReadonlyT, IntT(lengthBits)))
   def all[T](func: PartialFunction[QueriableT, T]): Vector[T] = {
     Vector(this).collect(func) ++ arrayExpr.all(func)
   }
@@ -0,0 +1,9 @@
+#include <stdio.h>
+
+#include "vtest/cPrintWorld.h"
+
+// Prints through stdio, which has its own buffer, so this only comes out between Vale's prints if
+// Vale flushes before calling us.
+void vtest_cPrintWorld() {
+  printf(" world");
+}
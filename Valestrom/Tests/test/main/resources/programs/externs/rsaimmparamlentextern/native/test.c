@@ -0,0 +1,15 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "vtest/ImmIntArray.h"
+
+ValeInt vtest_sumBytes(vtest_ImmIntArray* arr) {
+  ValeInt total = 0;
+  for (int i = 0; i < arr->length; i++) {
+    total += arr->elements[i];
+  }
+#ifndef vtest_ImmIntArray_LENT_TO_EXTERNS
+  free(arr);
+#endif
+  return total;
+}
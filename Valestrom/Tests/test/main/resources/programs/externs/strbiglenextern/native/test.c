@@ -0,0 +1,17 @@
+#include "ValeBuiltins.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+// One char too long for an int, so len() can't return it. Only built with --wide-lengths.
+// Vale copies this when it gets it, so this needs over 4GB of memory.
+ValeStr* vtest_cMakeBigStr() {
+  ValeLength length = (ValeLength)INT32_MAX + 1;
+  ValeStr* result = (ValeStr*)malloc(sizeof(ValeStr) + length + 1);
+  if (!result) {
+    // Not the panic's exit code, so the test fails instead of passing by accident.
+    exit(3);
+  }
+  result->length = length;
+  result->chars[length] = '\0';
+  return result;
+}
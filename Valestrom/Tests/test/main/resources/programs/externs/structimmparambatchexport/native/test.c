@@ -0,0 +1,25 @@
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "vtest/Flamscrankle.h"
+#include "vtest/expFunc.h"
+
+// Calls expFunc on three Flamscrankles at once. The results are 10, 14 and 18.
+ValeInt vtest_extFunc() {
+  vtest_Flamscrankle* flams[3];
+  ValeInt bonuses[3];
+  ValeInt results[3];
+  for (int i = 0; i < 3; i++) {
+    flams[i] = (vtest_Flamscrankle*)malloc(sizeof(vtest_Flamscrankle));
+    flams[i]->a = i;
+    flams[i]->c = 3 * i;
+    bonuses[i] = 10;
+  }
+  vtest_expFunc_batch(3, results, flams, bonuses);
+  for (int i = 0; i < 3; i++) {
+    free(flams[i]);
+  }
+  return results[0] + results[1] + results[2];
+}
@@ -0,0 +1,14 @@
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "vtest/Flamscrankle.h"
+
+ValeInt vtest_extFunc(vtest_Flamscrankle* flam) {
+  ValeInt result = flam->a + (ValeInt)(flam->b * 2) + flam->c - 1;
+#ifndef vtest_Flamscrankle_LENT_TO_EXTERNS
+  free(flam);
+#endif
+  return result;
+}
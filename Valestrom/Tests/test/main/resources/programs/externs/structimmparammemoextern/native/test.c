@@ -0,0 +1,24 @@
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "vtest/Bogglewoggle.h"
+#include "vtest/Flamscrankle.h"
+
+ValeInt vtest_extFunc(vtest_Flamscrankle* flam) {
+  ValeInt result = flam->x + flam->b->x + flam->y;
+#ifdef vtest_Flamscrankle_LENT_TO_EXTERNS
+  // We're sent the same object every time, so after the first call we should get the same copy.
+  static vtest_Flamscrankle* firstFlam = NULL;
+  if (firstFlam == NULL) {
+    firstFlam = flam;
+  } else {
+    assert(flam == firstFlam);
+  }
+#else
+  free(flam);
+#endif
+  return result;
+}
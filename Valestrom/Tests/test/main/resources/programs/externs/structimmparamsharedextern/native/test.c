@@ -0,0 +1,15 @@
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "vtest/Spigglewigget.h"
+#include "vtest/Flamscrankle.h"
+
+// Both members are the same Spigglewigget, so with --preserve-sharing they should point at the
+// same copy, and we return 42. Otherwise they're separate copies, and we return 41.
+ValeInt vtest_extFunc(vtest_Flamscrankle* flam) {
+  ValeInt result = flam->a->x + flam->b->x + (flam->a == flam->b ? 2 : 1);
+  free(flam);
+  return result;
+}
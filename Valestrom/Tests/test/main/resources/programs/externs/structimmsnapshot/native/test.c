@@ -0,0 +1,35 @@
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "vtest/Spigglewigget.h"
+#include "vtest/Flamscrankle.h"
+
+// Maps the snapshot main just saved and reads it in place, without unserializing anything.
+ValeInt vtest_readFlamInPlace(ValeStr* path) {
+  void* snapshot = __vale_snapshotMap(path->chars, vtest_Flamscrankle_SNAPSHOT_TYPE_HASH);
+  if (!snapshot) {
+    return -1;
+  }
+  vtest_Flamscrankle* flam = (vtest_Flamscrankle*)__vale_snapshotRoot(snapshot);
+  ValeInt result = flam->a->x + flam->b + flam->name->length;
+  __vale_snapshotUnmap(snapshot);
+  return result;
+}
+
+// A fresh, empty file for this run, so runs in the same directory don't trip over each other.
+ValeStr* vtest_makeTempSnapshotPath() {
+  char path[] = "/tmp/structimmsnapshotXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    exit(5);
+  }
+  close(fd);
+  return ValeStrFrom(path);
+}
+
+void vtest_removeSnapshot(ValeStr* path) {
+  unlink(path->chars);
+}
@@ -229,7 +229,7 @@ object ExpressionVivem {
         })
         NodeContinue(makeVoid(programH, heap, callId))
       }
-      case ArrayLengthH(arrExpr) => {
+      case ArrayLengthH(arrExpr, lengthBits) => {
         val arrayReference =
           executeNode(programH, stdin, stdout, heap, expressionId.addStep(0), arrExpr) match {
             case r @ NodeReturn(_) => return r
@@ -240,7 +240,7 @@ object ExpressionVivem {
 
         discard(programH, heap, stdout, stdin, callId, arrExpr.resultType, arrayReference)
 
-        val lenRef = makePrimitive(heap, callId, InlineH, IntV(arr.getSize(), 32))
+        val lenRef = makePrimitive(heap, callId, InlineH, IntV(arr.getSize(), lengthBits))
         NodeContinue(lenRef)
       }
       case waH @ WeakAliasH(sourceExpr) => {
@@ -425,7 +425,8 @@ object ExpressionVivem {
             case r @ NodeReturn(_) => return r
             case NodeContinue(r) => r
           }
-        val IntV(elementIndex, 32) = heap.dereference(indexReference)
+        // The index can be an int or an i64.
+        val IntV(elementIndex, _) = heap.dereference(indexReference)
 
         val address = ElementAddressV(arrayReference.allocId, elementIndex.toInt)
         heap.vivemDout.print(" " + address)
@@ -641,7 +642,7 @@ object ExpressionVivem {
 
         val index =
           heap.dereference(indexIntReference) match {
-            case IntV(value, 32) => value.toInt
+            case IntV(value, _) => value.toInt
           }
 
         val address = ElementAddressV(arrayReference.allocId, index)
@@ -746,7 +747,7 @@ object ExpressionVivem {
             case NodeContinue(r) => r
           }
         val sizeKind = heap.dereference(sizeReference)
-        val IntV(size, 32) = sizeKind;
+        val IntV(size, _) = sizeKind;
         val rsaDef = programH.lookupRuntimeSizedArray(arrayRefType.kind)
         val (arrayReference, arrayInstance) =
           heap.addUninitializedArray(rsaDef, arrayRefType, size.toInt)
@@ -1034,12 +1035,14 @@ object ExpressionVivem {
     receiver: (Int, ReferenceV) => Unit):
   Unit = {
     val generatorFunction = programH.lookupFunction(generatorPrototype)
+    // The generator takes the same kind of int as the array's size.
+    val ReferenceH(_, _, _, IntH(indexBits)) = generatorPrototype.params(1)
 
     (0 until size).foreach(i => {
       heap.vivemDout.println()
       heap.vivemDout.println("  " * callId.callDepth + "Making new stack frame (generator)")
 
-      val indexReference = heap.allocateTransient(ShareH, InlineH, ReadonlyH, IntV(i, 32))
+      val indexReference = heap.allocateTransient(ShareH, InlineH, ReadonlyH, IntV(i, indexBits))
 
       heap.vivemDout.println()
 